@@ -1,355 +1,255 @@
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+
+#include "birdup_core.h"
+#include "birdup_sprites.h"
+#include "birdup_pilot.h"
+#include "birdup_demo_pilot.h"
+#include "birdup_fx.h"
+#include "birdup_rewind.h"
+#include "birdup_sfx.h"
+#include "../common/cpu_meter.h"
+#include "../common/font.h"
+#include "../common/input_queue.h"
+#include "../common/replay.h"
+#include "../common/profiler.h"
+#include "../common/triple_buffer.h"
+#include "../common/wave_out.h"
 
 static int gW = 640, gH = 480;
 
 static HBITMAP gBmp;
+static HBITMAP gOldBmp;
 static HDC gMemDC;
-static HFONT gFont;
-
-static uint32_t gSeed = 1;
-static uint32_t rnd_u32() { gSeed = gSeed * 1664525u + 1013904223u; return gSeed; }
-
-enum { OB_COUNT = 4 };
-struct Ob {
-    float x;
-    float gapY;
-    int passed;
+static BITMAPINFO gBmi;
+static uint32_t* gPixels;
+static Font gFont;
+static TextRun gScoreRun, gOverRun, gModeRun;
+
+static BirdGame gGame;
+static BirdSprites gSprites;
+
+static const int TICK_HZ = 120;
+
+// Space changes, stamped with QPC by the window procedure and taken by
+// whichever thread ticks, each at its point in the tick (input_queue.h).
+static InputQueue gInput;
+static LONGLONG gTickLen;               // QPC counts per tick
+
+// Written by the window procedure, read by whichever thread ticks.
+static std::atomic<int> gDemo;           // the trained autopilot flies (D toggles)
+
+// Backspace held scrubs back through the last minute of play, one tick per
+// tick; letting go branches from there. Off while recording a replay.
+static BirdRewind gRewind;
+static uint64_t gTick;      // ring tick gGame is at
+static std::atomic<int> gRewinding;
+
+static Replay gReplay;
+static int gRecording;
+static char gRecordPath[MAX_PATH];
+
+// Sound effects (birdup_sfx.h), triggered by whichever thread ticks.
+static Synth gSynth;
+static WaveOut gWave;
+static int gSound;          // a device is open (and no -mute)
+
+// Particle effects (birdup_fx.h), owned by whichever thread draws.
+static ParticlePool gFx;
+static BirdGame gFxPrev;    // the game the last frame showed
+static int gFxHavePrev;
+static LONGLONG gFxLast;    // QPC time of the last frame
+
+#if defined(NG_PROFILE)
+// Profiler overlay (F2); F3 or -profile-csv=path write the frame samples.
+static TextRun gProfRuns[2];
+static char gProfText[2][64];
+static char gProfCsvPath[MAX_PATH] = "birdup_profile.csv";
+#endif
+
+// What a frame draws: the game after a tick and the modes shown over it.
+struct BirdView
+{
+    BirdGame game;
+    int demo, rewinding;
 };
 
-static Ob gObs[OB_COUNT];
-static int gScore;
-static int gAlive;
-
-static float gBirdY;
-static float gBirdV;
-
-static DWORD gLastTick;
-static int gSpaceDown;
-
-static const int BIRD_X = 120;
-static const int BIRD_R = 12;
-
-static const int OB_W = 56;
-static const int GAP_H = 150;
-static const int OB_SPACING = 200;
-static const float SPEED = 240.0f;
-static const float GRAV = 1100.0f;
-static const float JUMP_V = -380.0f;
-
-static void reset_game()
-{
-    gScore = 0;
-    gAlive = 1;
-    gBirdY = gH * 0.5f;
-    gBirdV = 0.0f;
-
-    float startX = (float)gW + 120.0f;
-    for (int i = 0; i < OB_COUNT; ++i) {
-        gObs[i].x = startX + (float)(i * OB_SPACING);
-        int margin = 60;
-        int top = margin + GAP_H / 2;
-        int bot = gH - margin - GAP_H / 2;
-        int r = top + (int)(rnd_u32() % (uint32_t)(bot - top + 1));
-        gObs[i].gapY = (float)r;
-        gObs[i].passed = 0;
-    }
-}
+// Threaded mode (-threaded): the simulation thread ticks and publishes a
+// BirdView per tick through a triple buffer; the render thread draws the
+// newest one and blits it. The window thread only handles messages.
+// Frame profiling (NG_PROFILE) covers the single-threaded loop only.
+static int gThreaded;
+static std::atomic<int> gQuit;
+static std::atomic<int> gRepaint;  // WM_PAINT in threaded mode: present the last frame again
+static TripleBuffer<BirdView> gViews;
+static HANDLE gSimWake;     // set on input: wakes a simulation at rest
+static HANDLE gRenderWake;  // set on publish or repaint: wakes the render thread
+
+// On the game-over screen nothing moves until a key, so the loops stop
+// ticking and drawing and block on input, with a timeout for the title.
+static const DWORD IDLE_WAIT_MS = 250;
+static int gRedraw = 1;     // single-threaded: draw even if no tick ran (new DIB)
 
 static void resize_backbuffer(HDC hdc)
 {
     if (!gMemDC) gMemDC = CreateCompatibleDC(hdc);
-    if (gBmp) { DeleteObject(gBmp); gBmp = 0; }
-    gBmp = CreateCompatibleBitmap(hdc, gW, gH);
-    SelectObject(gMemDC, gBmp);
-    if (!gFont) gFont = (HFONT)GetStockObject(ANSI_VAR_FONT);
-    SelectObject(gMemDC, gFont);
-    SetBkMode(gMemDC, TRANSPARENT);
+    if (gBmp) { SelectObject(gMemDC, gOldBmp); DeleteObject(gBmp); gBmp = 0; }
+
+    // Top-down 32 bpp DIB section: the renderer writes gPixels directly.
+    gBmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    gBmi.bmiHeader.biWidth = gW;
+    gBmi.bmiHeader.biHeight = -gH;
+    gBmi.bmiHeader.biPlanes = 1;
+    gBmi.bmiHeader.biBitCount = 32;
+    gBmi.bmiHeader.biCompression = BI_RGB;
+    gBmp = CreateDIBSection(gMemDC, &gBmi, DIB_RGB_COLORS, (void**)&gPixels, 0, 0);
+    gOldBmp = (HBITMAP)SelectObject(gMemDC, gBmp);
+    if (!gFont.scale) FontInit(gFont, 2);
+
+    // Sprites are baked for the backbuffer size; a new DIB starts undefined.
+    bake_sprites(&gSprites, gW, gH);
 }
 
-static int clampi(int v, int lo, int hi) { return v < lo ? lo : (v > hi ? hi : v); }
-
-static COLORREF lerp_rgb(COLORREF a, COLORREF b, float t)
+static BirdView current_view()
 {
-    if (t < 0.0f) t = 0.0f;
-    if (t > 1.0f) t = 1.0f;
-    int ar = GetRValue(a), ag = GetGValue(a), ab = GetBValue(a);
-    int br = GetRValue(b), bg = GetGValue(b), bb = GetBValue(b);
-    int rr = ar + (int)((br - ar) * t);
-    int rg = ag + (int)((bg - ag) * t);
-    int rb = ab + (int)((bb - ab) * t);
-    return RGB(rr, rg, rb);
+    BirdView v;
+    v.game = gGame;
+    v.demo = gDemo;
+    v.rewinding = gRewinding;
+    return v;
 }
 
-static void step_game(float dt)
+// Emits for what changed since the last frame (not while scrubbing back,
+// where time runs backwards) and moves the particles on by real time.
+static void update_effects(const BirdView& v)
 {
-    if (dt > 0.05f) dt = 0.05f;
-    if (!gAlive) return;
-
-    gBirdV += GRAV * dt;
-    gBirdY += gBirdV * dt;
-
-    if (gBirdY < (float)BIRD_R) { gBirdY = (float)BIRD_R; gBirdV = 0.0f; }
-    if (gBirdY > (float)(gH - BIRD_R)) { gBirdY = (float)(gH - BIRD_R); gAlive = 0; }
-
-    float maxX = 0.0f;
-    for (int i = 0; i < OB_COUNT; ++i) if (gObs[i].x > maxX) maxX = gObs[i].x;
-
-    for (int i = 0; i < OB_COUNT; ++i) {
-        gObs[i].x -= SPEED * dt;
-
-        if (!gObs[i].passed && gObs[i].x + (float)OB_W < (float)(BIRD_X - BIRD_R)) {
-            gObs[i].passed = 1;
-            ++gScore;
-        }
-
-        if (gObs[i].x < -(float)OB_W) {
-            gObs[i].x = maxX + (float)OB_SPACING;
-            maxX = gObs[i].x;
-            int margin = 60;
-            int top = margin + GAP_H / 2;
-            int bot = gH - margin - GAP_H / 2;
-            int r = top + (int)(rnd_u32() % (uint32_t)(bot - top + 1));
-            gObs[i].gapY = (float)r;
-            gObs[i].passed = 0;
-        }
-
-        int left = (int)gObs[i].x;
-        int right = left + OB_W;
-        int gapTop = (int)(gObs[i].gapY - GAP_H * 0.5f);
-        int gapBot = (int)(gObs[i].gapY + GAP_H * 0.5f);
-        gapTop = clampi(gapTop, 0, gH);
-        gapBot = clampi(gapBot, 0, gH);
-
-        int bx0 = BIRD_X - BIRD_R;
-        int bx1 = BIRD_X + BIRD_R;
-        int by0 = (int)gBirdY - BIRD_R;
-        int by1 = (int)gBirdY + BIRD_R;
-        if (bx1 > left && bx0 < right) {
-            if (by0 < gapTop || by1 > gapBot) gAlive = 0;
-        }
-    }
+    if (!gFx.capacity) return;
+    LARGE_INTEGER now, freq;
+    QueryPerformanceCounter(&now);
+    QueryPerformanceFrequency(&freq);
+    float dt = gFxLast ? (float)((double)(now.QuadPart - gFxLast) / (double)freq.QuadPart) : 0.0f;
+    if (dt > 0.1f) dt = 0.1f;
+    gFxLast = now.QuadPart;
+    ParticleUpdate(gFx, dt);
+    if (gFxHavePrev && !v.rewinding) bird_effects(gFx, &gFxPrev, &v.game);
+    gFxPrev = v.game;
+    gFxHavePrev = 1;
 }
 
-static void draw_game()
+static void draw_frame(const BirdView& v)
 {
-    RECT r; r.left = 0; r.top = 0; r.right = gW; r.bottom = gH;
-
-    // Background: subtle vertical gradient + faint stripes
-    COLORREF skyTop = RGB(12, 16, 22);
-    COLORREF skyBot = RGB(24, 30, 40);
-    for (int y = 0; y < gH; y += 4) {
-        float t = (gH > 1) ? (float)y / (float)(gH - 1) : 0.0f;
-        COLORREF c = lerp_rgb(skyTop, skyBot, t);
-        RECT rr = { 0, y, gW, (y + 4 < gH) ? y + 4 : gH };
-        HBRUSH b = CreateSolidBrush(c);
-        FillRect(gMemDC, &rr, b);
-        DeleteObject(b);
+    // Last frame's BitBlt may still be reading the DIB.
+    GdiFlush();
+    Surface surf = { gPixels, gW, gH, gW };
+    draw_game_cached(surf, &gSprites, &v.game);
+
+    update_effects(v);
+    const int fxSize = 1 + gH / 400;
+    int fx0, fy0, fx1, fy1;
+    if (ParticleBounds(gFx, fxSize, &fx0, &fy0, &fx1, &fy1))
+    {
+        ParticleDraw(gFx, surf, fxSize);
+        sprites_touch(&gSprites, fx0, fy0, fx1, fy1);
     }
-    for (int x = 0; x < gW; x += 40) {
-        RECT sr = { x, 0, x + 1, gH };
-        HBRUSH sb = CreateSolidBrush(RGB(28, 36, 48));
-        FillRect(gMemDC, &sr, sb);
-        DeleteObject(sb);
+
+    // UI text (with slight shadow); runs are only laid out when the text changes
+    const uint32_t fg = RasterRGB(240, 240, 240), shadow = RasterRGB(0, 0, 0);
+    char buf[64];
+    wsprintfA(buf, "Score: %d", v.game.score);
+    TextRunSet(gScoreRun, gFont, buf);
+    TextRunDrawShadow(surf, gScoreRun, 12, 10, fg, shadow, 1, 1);
+    sprites_touch(&gSprites, 12, 10, 13 + gScoreRun.w, 11 + gScoreRun.h);
+
+    if (v.demo || v.rewinding) {
+        TextRunSet(gModeRun, gFont, v.rewinding ? "<< REWIND" : "DEMO - press D to play");
+        int tx = gW - 12 - gModeRun.w;
+        TextRunDrawShadow(surf, gModeRun, tx, 10, fg, shadow, 1, 1);
+        sprites_touch(&gSprites, tx, 10, tx + 1 + gModeRun.w, 11 + gModeRun.h);
     }
 
-    // Obstacles: body shading + outline + caps around the gap
-    HPEN obOutline = CreatePen(PS_SOLID, 1, RGB(20, 60, 30));
-    HBRUSH obMain = CreateSolidBrush(RGB(70, 200, 90));
-    HBRUSH obHi = CreateSolidBrush(RGB(110, 230, 130));
-    HBRUSH obLo = CreateSolidBrush(RGB(40, 145, 65));
-    HBRUSH capMain = CreateSolidBrush(RGB(85, 220, 110));
-    HBRUSH capHi = CreateSolidBrush(RGB(125, 240, 145));
-    HBRUSH capLo = CreateSolidBrush(RGB(55, 170, 80));
-
-    HGDIOBJ oldPen = SelectObject(gMemDC, obOutline);
-    HGDIOBJ oldBrush = SelectObject(gMemDC, obMain);
-    for (int i = 0; i < OB_COUNT; ++i) {
-        int left = (int)gObs[i].x;
-        int right = left + OB_W;
-        int gapTop = (int)(gObs[i].gapY - GAP_H * 0.5f);
-        int gapBot = (int)(gObs[i].gapY + GAP_H * 0.5f);
-        gapTop = clampi(gapTop, 0, gH);
-        gapBot = clampi(gapBot, 0, gH);
-
-        // Top segment
-        if (gapTop > 0) {
-            SelectObject(gMemDC, obMain);
-            Rectangle(gMemDC, left, 0, right, gapTop);
-
-            int hiW = (OB_W >= 10) ? 8 : OB_W / 3;
-            int loW = (OB_W >= 10) ? 8 : OB_W / 3;
-            SelectObject(gMemDC, obHi);
-            Rectangle(gMemDC, left + 1, 1, left + 1 + hiW, gapTop - 1);
-            SelectObject(gMemDC, obLo);
-            Rectangle(gMemDC, right - 1 - loW, 1, right - 1, gapTop - 1);
-
-            // Cap at bottom of top segment
-            int capH = 14;
-            int capY0 = gapTop - capH;
-            if (capY0 < 0) capY0 = 0;
-            SelectObject(gMemDC, capMain);
-            Rectangle(gMemDC, left - 3, capY0, right + 3, gapTop);
-            SelectObject(gMemDC, capHi);
-            Rectangle(gMemDC, left - 2, capY0 + 1, left + 6, gapTop - 1);
-            SelectObject(gMemDC, capLo);
-            Rectangle(gMemDC, right - 6, capY0 + 1, right + 2, gapTop - 1);
-        }
+    if (!v.game.alive && !v.demo && !v.rewinding) {
+        TextRunSet(gOverRun, gFont, "GAME OVER - Press SPACE");
+        int tx = (gW - gOverRun.w) / 2;
+        int ty = (gH - gOverRun.h) / 2;
+        TextRunDrawShadow(surf, gOverRun, tx, ty, fg, shadow, 2, 2);
+        sprites_touch(&gSprites, tx, ty, tx + 2 + gOverRun.w, ty + 2 + gOverRun.h);
+    }
 
-        // Bottom segment
-        if (gapBot < gH) {
-            SelectObject(gMemDC, obMain);
-            Rectangle(gMemDC, left, gapBot, right, gH);
-
-            int hiW = (OB_W >= 10) ? 8 : OB_W / 3;
-            int loW = (OB_W >= 10) ? 8 : OB_W / 3;
-            SelectObject(gMemDC, obHi);
-            Rectangle(gMemDC, left + 1, gapBot + 1, left + 1 + hiW, gH - 1);
-            SelectObject(gMemDC, obLo);
-            Rectangle(gMemDC, right - 1 - loW, gapBot + 1, right - 1, gH - 1);
-
-            // Cap at top of bottom segment
-            int capH = 14;
-            int capY1 = gapBot + capH;
-            if (capY1 > gH) capY1 = gH;
-            SelectObject(gMemDC, capMain);
-            Rectangle(gMemDC, left - 3, gapBot, right + 3, capY1);
-            SelectObject(gMemDC, capHi);
-            Rectangle(gMemDC, left - 2, gapBot + 1, left + 6, capY1 - 1);
-            SelectObject(gMemDC, capLo);
-            Rectangle(gMemDC, right - 6, gapBot + 1, right + 2, capY1 - 1);
+#if defined(NG_PROFILE)
+    if (g_prof.overlay)
+    {
+        const uint32_t pc = RasterRGB(255, 235, 150);
+        int y = gH - 2 * (gFont.lineH + 4) - 8;
+        for (int i = 0; i < 2; ++i, y += gFont.lineH + 4)
+        {
+            TextRunSet(gProfRuns[i], gFont, gProfText[i]);
+            TextRunDrawShadow(surf, gProfRuns[i], 12, y, pc, shadow, 1, 1);
+            sprites_touch(&gSprites, 12, y, 13 + gProfRuns[i].w, y + 1 + gProfRuns[i].h);
         }
     }
-    SelectObject(gMemDC, oldBrush);
-    SelectObject(gMemDC, oldPen);
-    DeleteObject(obOutline);
-    DeleteObject(obMain);
-    DeleteObject(obHi);
-    DeleteObject(obLo);
-    DeleteObject(capMain);
-    DeleteObject(capHi);
-    DeleteObject(capLo);
-
-    // Bird: outline + highlight + eye + beak + wing + shadow
-    int bx0 = BIRD_X - BIRD_R;
-    int by0 = (int)gBirdY - BIRD_R;
-    int bx1 = BIRD_X + BIRD_R;
-    int by1 = (int)gBirdY + BIRD_R;
-
-    // Drop shadow
-    HPEN nullPen = (HPEN)GetStockObject(NULL_PEN);
-    SelectObject(gMemDC, nullPen);
-    HBRUSH sh = CreateSolidBrush(RGB(0, 0, 0));
-    SelectObject(gMemDC, sh);
-    Ellipse(gMemDC, bx0 + 4, by0 + 5, bx1 + 4, by1 + 5);
-    DeleteObject(sh);
-
-    // Body
-    HPEN birdOutline = CreatePen(PS_SOLID, 2, RGB(170, 120, 20));
-    HBRUSH birdBody = CreateSolidBrush(RGB(250, 220, 70));
-    SelectObject(gMemDC, birdOutline);
-    SelectObject(gMemDC, birdBody);
-    Ellipse(gMemDC, bx0, by0, bx1, by1);
-    DeleteObject(birdBody);
-
-    // Highlight
-    SelectObject(gMemDC, nullPen);
-    HBRUSH birdHi = CreateSolidBrush(RGB(255, 245, 160));
-    SelectObject(gMemDC, birdHi);
-    Ellipse(gMemDC, bx0 + 3, by0 + 3, bx0 + BIRD_R, by0 + BIRD_R);
-    DeleteObject(birdHi);
-
-    // Wing
-    HPEN wingPen = CreatePen(PS_SOLID, 1, RGB(160, 110, 25));
-    HBRUSH wingBrush = CreateSolidBrush(RGB(235, 200, 55));
-    SelectObject(gMemDC, wingPen);
-    SelectObject(gMemDC, wingBrush);
-    Ellipse(gMemDC, BIRD_X - 10, (int)gBirdY - 2, BIRD_X + 6, (int)gBirdY + 10);
-    DeleteObject(wingBrush);
-    DeleteObject(wingPen);
-
-    // Eye
-    SelectObject(gMemDC, nullPen);
-    HBRUSH eyeWhite = CreateSolidBrush(RGB(250, 250, 250));
-    SelectObject(gMemDC, eyeWhite);
-    Ellipse(gMemDC, BIRD_X + 1, (int)gBirdY - 8, BIRD_X + 10, (int)gBirdY + 1);
-    DeleteObject(eyeWhite);
-    HBRUSH pupil = CreateSolidBrush(RGB(30, 30, 30));
-    SelectObject(gMemDC, pupil);
-    Ellipse(gMemDC, BIRD_X + 6, (int)gBirdY - 5, BIRD_X + 9, (int)gBirdY - 2);
-    DeleteObject(pupil);
-
-    // Beak
-    POINT beak[3];
-    beak[0].x = BIRD_X + BIRD_R - 1;
-    beak[0].y = (int)gBirdY - 1;
-    beak[1].x = BIRD_X + BIRD_R + 10;
-    beak[1].y = (int)gBirdY + 2;
-    beak[2].x = BIRD_X + BIRD_R - 1;
-    beak[2].y = (int)gBirdY + 5;
-    HPEN beakPen = CreatePen(PS_SOLID, 1, RGB(150, 80, 10));
-    HBRUSH beakBrush = CreateSolidBrush(RGB(255, 150, 40));
-    SelectObject(gMemDC, beakPen);
-    SelectObject(gMemDC, beakBrush);
-    Polygon(gMemDC, beak, 3);
-    DeleteObject(beakBrush);
-    DeleteObject(beakPen);
-
-    DeleteObject(birdOutline);
-
-    // UI text (with slight shadow)
-    SetTextColor(gMemDC, RGB(0, 0, 0));
-    char buf[64];
-    wsprintfA(buf, "Score: %d", gScore);
-    TextOutA(gMemDC, 13, 11, buf, lstrlenA(buf));
-    SetTextColor(gMemDC, RGB(240, 240, 240));
-    TextOutA(gMemDC, 12, 10, buf, lstrlenA(buf));
-
-    if (!gAlive) {
-        const char* msg = "GAME OVER - Press SPACE";
-        int len = lstrlenA(msg);
-        SIZE s; GetTextExtentPoint32A(gMemDC, msg, len, &s);
-        int tx = (gW - s.cx) / 2;
-        int ty = (gH - s.cy) / 2;
-        SetTextColor(gMemDC, RGB(0, 0, 0));
-        TextOutA(gMemDC, tx + 2, ty + 2, msg, len);
-        SetTextColor(gMemDC, RGB(240, 240, 240));
-        TextOutA(gMemDC, tx, ty, msg, len);
-    }
+#endif
+}
+
+static void push_key(uint16_t key, int down)
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    InputPush(gInput, now.QuadPart, key, down != 0);
+    if (gSimWake) SetEvent(gSimWake);
 }
 
 static LRESULT CALLBACK wndproc(HWND h, UINT m, WPARAM w, LPARAM l)
 {
     switch (m) {
-    case WM_CREATE:
-        gSeed = (uint32_t)(GetTickCount() ^ (uintptr_t)h);
-        gLastTick = GetTickCount();
-        reset_game();
-        return 0;
     case WM_SIZE: {
-        gW = LOWORD(l);
-        gH = HIWORD(l);
-        if (gW < 1) gW = 1;
-        if (gH < 1) gH = 1;
+        // The window has a fixed size; this is its creation or a restore.
+        int nw = LOWORD(l) ? LOWORD(l) : 1, nh = HIWORD(l) ? HIWORD(l) : 1;
+        if (w == SIZE_MINIMIZED || (gMemDC && nw == gW && nh == gH)) return 0;
+        gW = nw;
+        gH = nh;
+        gGame.w = gW;
+        gGame.h = gH;
+        // Older snapshots are for the old size.
+        rewind_reset(&gRewind);
+        rewind_push(&gRewind, &gGame);
+        gTick = 0;
         HDC hdc = GetDC(h);
         resize_backbuffer(hdc);
         ReleaseDC(h, hdc);
+        gRedraw = 1;
     } return 0;
-    case WM_KEYDOWN:
-        if (w == VK_SPACE) {
-            if (!gSpaceDown) {
-                gSpaceDown = 1;
-                if (gAlive) {
-                    gBirdV = JUMP_V;
-                } else {
-                    reset_game();
-                }
-            }
+    case WM_PAINT: {
+        // The memory DC holds the last frame, which may be a while old at
+        // rest; the render thread owns it in threaded mode.
+        PAINTSTRUCT ps;
+        HDC hdc = BeginPaint(h, &ps);
+        if (gThreaded)
+        {
+            gRepaint = 1;
+            if (gRenderWake) SetEvent(gRenderWake);
+        }
+        else if (gMemDC)
+        {
+            BitBlt(hdc, 0, 0, gW, gH, gMemDC, 0, 0, SRCCOPY);
         }
+        EndPaint(h, &ps);
+    } return 0;
+    case WM_KEYDOWN:
+#if defined(NG_PROFILE)
+        if (w == VK_F2) g_prof.overlay = !g_prof.overlay;
+        if (w == VK_F3) ProfWriteCsv(gProfCsvPath);
+#endif
+        if (w == 'D' && !(l & (1 << 30))) gDemo = !gDemo;
+        if (w == VK_BACK && !gRecording) gRewinding = 1;
+        if (gSimWake) SetEvent(gSimWake);
+        if (w == VK_SPACE && !(l & (1 << 30))) push_key(BIRD_KEY_SPACE, 1);
         return 0;
     case WM_KEYUP:
-        if (w == VK_SPACE) gSpaceDown = 0;
+        if (w == VK_SPACE) push_key(BIRD_KEY_SPACE, 0);
+        if (w == VK_BACK) gRewinding = 0;
         return 0;
     case WM_DESTROY:
         PostQuitMessage(0);
@@ -358,7 +258,149 @@ static LRESULT CALLBACK wndproc(HWND h, UINT m, WPARAM w, LPARAM l)
     return DefWindowProcA(h, m, w, l);
 }
 
-int WINAPI WinMain(HINSTANCE hi, HINSTANCE, LPSTR, int)
+// One fixed tick ending at QPC time `end`: play (or the demo pilot)
+// forward, or scrub one tick back. Keys of the span are taken either way.
+static void step_game(float tickDt, LONGLONG end, LONGLONG now)
+{
+    InputTick keys = InputTake(gInput, end - gTickLen, end, now);
+    if (gRewinding) {
+        if (gTick > gRewind.first && rewind_seek(&gRewind, gTick - 1, &gGame)) --gTick;
+        return;
+    }
+    uint32_t input = gDemo ? pilot_input(BIRD_DEMO_PILOT, &gGame)
+        : bird_input(keys.down, keys.pressed, keys.at);
+    BirdGame before = gGame;
+    bird_tick(&gGame, input, tickDt);
+    if (gSound) bird_sounds(gSynth, &before, &gGame, input, WaveNow());
+    if (gRecording) ReplayRecord(gReplay, input);
+    // Branch from wherever a rewind left us.
+    if (gTick + 1 != gRewind.next) rewind_truncate(&gRewind, gTick);
+    rewind_push(&gRewind, &gGame);
+    gTick = gRewind.next - 1;
+}
+
+// Nothing will change until a key: called by whichever thread ticks.
+static int sim_at_rest()
+{
+    return !gDemo && !gRewinding && bird_at_rest(&gGame) && !gInput.down && !InputPending(gInput);
+}
+
+// Ticks on a deadline, sleeping on a high-resolution waitable timer in
+// between: Sleep(1) lasts a whole scheduler quantum (~15.6 ms) and would
+// bunch the ticks in twos.
+static DWORD WINAPI sim_thread(LPVOID)
+{
+    const float tickDt = ReplayTickDt(TICK_HZ);
+    HANDLE timer = CreateWaitableTimerExW(0, 0, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    LONGLONG nextTick = now.QuadPart + gTickLen;
+    while (!gQuit) {
+        QueryPerformanceCounter(&now);
+        if (now.QuadPart - nextTick > freq.QuadPart / 4) nextTick = now.QuadPart; // don't spiral after a stall
+        int ticked = 0;
+        for (; nextTick <= now.QuadPart; nextTick += gTickLen, ticked = 1)
+            step_game(tickDt, nextTick, now.QuadPart);
+        if (ticked)
+        {
+            TripleBufferBack(gViews) = current_view();
+            TripleBufferPublish(gViews);
+            SetEvent(gRenderWake);
+        }
+        if (sim_at_rest())
+        {
+            // The still frame is published. The wait is a pause, not play.
+            WaitForSingleObject(gSimWake, IDLE_WAIT_MS);
+            QueryPerformanceCounter(&now);
+            nextTick = now.QuadPart + gTickLen;
+            continue;
+        }
+        QueryPerformanceCounter(&now);
+        const LONGLONG remaining = nextTick - now.QuadPart;
+        if (remaining <= 0) continue;
+        if (timer)
+        {
+            LARGE_INTEGER due;
+            due.QuadPart = -(remaining * 10000000 / freq.QuadPart);  // relative, 100 ns units
+            SetWaitableTimer(timer, &due, 0, 0, 0, FALSE);
+            WaitForSingleObject(timer, INFINITE);
+        }
+        else
+        {
+            Sleep(1);
+        }
+    }
+    if (timer) CloseHandle(timer);
+    return 0;
+}
+
+static DWORD WINAPI render_thread(LPVOID param)
+{
+    HWND h = (HWND)param;
+    while (!gQuit) {
+        // Nothing new: the last frame is still on screen, unless particles
+        // are still flying, in which case it is drawn again each tick, or
+        // the window was uncovered, in which case it is presented again.
+        int fresh = TripleBufferAcquire(gViews);
+        if (!fresh)
+        {
+            WaitForSingleObject(gRenderWake, gFx.count ? 1000 / TICK_HZ : IDLE_WAIT_MS);
+            fresh = TripleBufferAcquire(gViews);
+        }
+        const int repaint = gRepaint.exchange(0);
+        if (!fresh && !gFx.count && !repaint) continue;
+        if (fresh || gFx.count) draw_frame(TripleBufferFront(gViews));
+        HDC wdc = GetDC(h);
+        BitBlt(wdc, 0, 0, gW, gH, gMemDC, 0, 0, SRCCOPY);
+        ReleaseDC(h, wdc);
+    }
+    return 0;
+}
+
+// Runs the threaded mode until the window closes.
+static void run_threaded(HWND h)
+{
+    TripleBufferInit(gViews, current_view());
+    gSimWake = CreateEventA(0, FALSE, FALSE, 0);
+    gRenderWake = CreateEventA(0, FALSE, FALSE, 0);
+    HANDLE threads[2] = {
+        CreateThread(0, 0, sim_thread, 0, 0, 0),
+        CreateThread(0, 0, render_thread, h, 0, 0),
+    };
+    MSG msg;
+    while (GetMessageA(&msg, 0, 0, 0) > 0) {
+        TranslateMessage(&msg);
+        DispatchMessageA(&msg);
+    }
+    gQuit = 1;
+    SetEvent(gSimWake);
+    SetEvent(gRenderWake);
+    WaitForMultipleObjects(2, threads, TRUE, INFINITE);
+    CloseHandle(threads[0]);
+    CloseHandle(threads[1]);
+    CloseHandle(gSimWake);
+    CloseHandle(gRenderWake);
+    gSimWake = gRenderWake = 0;
+}
+
+// Value of "key" in the command line, up to the next space.
+static int arg_str(const char* cmd, const char* key, char* out, int size)
+{
+    const char* p = cmd ? strstr(cmd, key) : 0;
+    if (!p) return 0;
+    p += strlen(key);
+    int n = 0;
+    while (p[n] && p[n] != ' ' && n < size - 1) { out[n] = p[n]; ++n; }
+    out[n] = 0;
+    return n > 0;
+}
+
+// Command line: -seed=N (obstacle layout, default from the clock),
+// -demo (start in demo mode), -record=path (write a replay on exit), -profile-csv=path (profiling
+// builds: write frame timings on exit), -threaded (tick and draw on their own threads),
+// -mute (no sound).
+int WINAPI WinMain(HINSTANCE hi, HINSTANCE, LPSTR cmd, int)
 {
     WNDCLASSA wc = { 0 };
     wc.lpfnWndProc = wndproc;
@@ -379,29 +421,140 @@ int WINAPI WinMain(HINSTANCE hi, HINSTANCE, LPSTR, int)
     resize_backbuffer(hdc);
     ReleaseDC(h, hdc);
 
+    char seedArg[16];
+    uint32_t seed = arg_str(cmd, "-seed=", seedArg, sizeof(seedArg))
+        ? (uint32_t)strtoul(seedArg, 0, 10) : (uint32_t)(GetTickCount() ^ (uintptr_t)h);
+    bird_init(&gGame, gW, gH, seed);
+    gDemo = cmd && strstr(cmd, "-demo") != 0;
+    gThreaded = cmd && strstr(cmd, "-threaded") != 0;
+    SynthInit(gSynth, NgDetectSimd());
+    gSound = !(cmd && strstr(cmd, "-mute")) && WaveOpen(gWave, gSynth);
+    ParticleInit(gFx, FX_CAPACITY, FX_GRAVITY, FX_KEEP);
+    rewind_reset(&gRewind);
+    rewind_push(&gRewind, &gGame);
+    gTick = 0;
+    if (arg_str(cmd, "-record=", gRecordPath, sizeof(gRecordPath))) {
+        ReplayBegin(gReplay, REPLAY_GAME_BIRDUP, seed, TICK_HZ, gW, gH);
+        gRecording = 1;
+    }
+#if defined(NG_PROFILE)
+    int profCsvAtExit = arg_str(cmd, "-profile-csv=", gProfCsvPath, sizeof(gProfCsvPath));
+    LONGLONG lastStats = 0;
+#endif
+
+    // Fixed simulation tick; frames draw whatever the last tick left.
+    const double tickSecs = 1.0 / TICK_HZ;
+    const float tickDt = ReplayTickDt(TICK_HZ);
+    LARGE_INTEGER freq, last, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&last);
+    double acc = 0.0;
+    InputInit(gInput, freq.QuadPart);
+    gTickLen = freq.QuadPart / TICK_HZ;
+    LONGLONG lastTitle = last.QuadPart;
+    CpuMeter cpu;
+    CpuMeterInit(cpu);
+    double cpuPerMin = -1.0;
+
+    if (gThreaded) {
+        run_threaded(h);
+        goto done;
+    }
+
     MSG msg;
     for (;;) {
-        while (PeekMessageA(&msg, 0, 0, 0, PM_REMOVE)) {
-            if (msg.message == WM_QUIT) goto done;
-            TranslateMessage(&msg);
-            DispatchMessageA(&msg);
+        NG_PROFILE_FRAME();
+        {
+            NG_PROFILE_SCOPE(PROF_INPUT);
+            while (PeekMessageA(&msg, 0, 0, 0, PM_REMOVE)) {
+                if (msg.message == WM_QUIT) goto done;
+                TranslateMessage(&msg);
+                DispatchMessageA(&msg);
+            }
         }
 
-        DWORD now = GetTickCount();
-        float dt = (now - gLastTick) * (1.0f / 1000.0f);
-        gLastTick = now;
-        step_game(dt);
-        draw_game();
-
-        HDC wdc = GetDC(h);
-        BitBlt(wdc, 0, 0, gW, gH, gMemDC, 0, 0, SRCCOPY);
-        ReleaseDC(h, wdc);
+        QueryPerformanceCounter(&now);
+        double frame = (double)(now.QuadPart - last.QuadPart) / (double)freq.QuadPart;
+        last = now;
+        if (frame > 0.25) frame = 0.25;
+        acc += frame;
+        // The simulation trails real time by acc: each tick stands for the
+        // span of real time ending acc - tickSecs before now.
+        int ticked = 0;
+        while (acc >= tickSecs) {
+            NG_PROFILE_SCOPE(PROF_UPDATE);
+            acc -= tickSecs;
+            step_game(tickDt, now.QuadPart - (LONGLONG)(acc * (double)freq.QuadPart), now.QuadPart);
+            ticked = 1;
+        }
+        // Frames show the last tick as is, so one without a tick would
+        // only draw the same picture again, unless particles are flying.
+        if (ticked || gRedraw || gFx.count)
+        {
+            gRedraw = 0;
+            {
+                NG_PROFILE_SCOPE(PROF_RENDER);
+                draw_frame(current_view());
+            }
+            {
+                NG_PROFILE_SCOPE(PROF_PRESENT);
+                HDC wdc = GetDC(h);
+                BitBlt(wdc, 0, 0, gW, gH, gMemDC, 0, 0, SRCCOPY);
+                ReleaseDC(h, wdc);
+            }
+        }
+#if defined(NG_PROFILE)
+        if (now.QuadPart - lastStats >= freq.QuadPart / 2)
+        {
+            ProfStats st = ProfComputeStats(1024);
+            ProfFormatStats(st, gProfText[0], gProfText[1], (int)sizeof(gProfText[0]));
+            lastStats = now.QuadPart;
+        }
+#endif
+        if (now.QuadPart - lastTitle >= freq.QuadPart / 2)
+        {
+            char title[96];
+            int n = wsprintfA(title, "Bird Up");
+            CpuMeterTake(cpu, 2000, &cpuPerMin);
+            if (cpuPerMin >= 0.0) n += snprintf(title + n, sizeof(title) - n, "  |  cpu %.1f s/min", cpuPerMin);
+            double avgMs, maxMs;
+            if (InputTakeLatency(gInput, &avgMs, &maxMs))
+                snprintf(title + n, sizeof(title) - n, "  |  input %.1f ms (max %.1f)", avgMs, maxMs);
+            SetWindowTextA(h, title);
+            lastTitle = now.QuadPart;
+        }
 
-        Sleep(1);
+        if (sim_at_rest() && !gFx.count)
+        {
+            // The still frame is on screen: block until input. The wait is
+            // a pause, not play, so the clock restarts after it.
+            MsgWaitForMultipleObjects(0, 0, FALSE, IDLE_WAIT_MS, QS_ALLINPUT);
+            QueryPerformanceCounter(&last);
+            acc = 0.0;
+        }
+        else
+        {
+            // Sleep until the next tick is due; input wakes us early so it
+            // is stamped when it arrives.
+            DWORD ms = (DWORD)((tickSecs - acc) * 1000.0);
+            MsgWaitForMultipleObjects(0, 0, FALSE, ms, QS_ALLINPUT);
+        }
     }
 
 done:
-    if (gBmp) DeleteObject(gBmp);
+    if (gSound) WaveClose(gWave);
+    if (gRecording) {
+        ReplayFinish(gReplay, bird_hash(&gGame));
+        if (!ReplaySave(gReplay, gRecordPath))
+            MessageBoxA(0, gRecordPath, "Bird Up: could not write replay", MB_OK | MB_ICONERROR);
+        ReplayFree(gReplay);
+    }
+#if defined(NG_PROFILE)
+    if (profCsvAtExit) ProfWriteCsv(gProfCsvPath);
+#endif
+    ParticleFree(gFx);
+    free_sprites(&gSprites);
+    if (gBmp) { SelectObject(gMemDC, gOldBmp); DeleteObject(gBmp); }
     if (gMemDC) DeleteDC(gMemDC);
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,279 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+#include "birdup_core.h"
+#include "../common/simd.h"
+
+// Batched Bird Up: N birds in structure-of-arrays form flying through one
+// shared obstacle ring. Each bird ends up bit-identical to running the
+// scalar step_game() on its own BirdGame with the same seed and flaps.
+//
+// Per-bird arrays are padded to a multiple of 8 so the AVX2 kernel never
+// needs a scalar tail; padding lanes are born dead.
+
+struct BirdBatch {
+    int n;            // birds in use
+    int cap;          // padded lane count
+    float* y;
+    float* v;
+    int32_t* alive;   // ~0 while flying, 0 once dead (lane masks)
+    int32_t* score;
+    int live;         // birds still flying
+    BirdGame world;   // shared obstacles + seed; its bird fields are unused
+    NgSimdLevel simd;
+};
+
+// Work for one step, shared by every bird lane.
+struct BirdBatchStep {
+    float g;          // GRAV * dt
+    float dt;
+    float floorY;     // h - BIRD_R
+    int32_t passed;   // columns that crossed the bird this step
+    int gaps;         // columns overlapping the bird's x range
+    int32_t gapTop[OB_COUNT];
+    int32_t gapBot[OB_COUNT];
+};
+
+// Kernels return how many birds are still flying afterwards.
+typedef int (*BirdBatchKernel)(BirdBatch* b, const int32_t* flaps, const BirdBatchStep* st);
+
+static inline int bird_count_lanes(int mask)
+{
+    int n = 0;
+    for (; mask; mask &= mask - 1) ++n;
+    return n;
+}
+
+// ------------------------------------------------------
+// Kernels. flaps[i] != 0 makes bird i flap before integrating, matching a
+// flap() call right before step_game().
+// ------------------------------------------------------
+static int bird_batch_kernel_scalar(BirdBatch* b, const int32_t* flaps, const BirdBatchStep* st)
+{
+    const float ceilY = (float)BIRD_R;
+    int live = 0;
+    for (int i = 0; i < b->cap; ++i) {
+        if (!b->alive[i]) continue;
+        float v = (flaps && flaps[i]) ? JUMP_V : b->v[i];
+        v += st->g;
+        float y = b->y[i] + v * st->dt;
+        int32_t alive = ~0;
+        if (y < ceilY) { y = ceilY; v = 0.0f; }
+        if (y > st->floorY) { y = st->floorY; alive = 0; }
+        b->score[i] += st->passed;
+
+        int by0 = (int)y - BIRD_R;
+        int by1 = (int)y + BIRD_R;
+        for (int k = 0; k < st->gaps; ++k) {
+            if (by0 < st->gapTop[k] || by1 > st->gapBot[k]) alive = 0;
+        }
+        b->y[i] = y;
+        b->v[i] = v;
+        b->alive[i] = alive;
+        live += alive & 1;
+    }
+    return live;
+}
+
+#if defined(NG_HAVE_SSE2)
+static inline __m128 bird_select_ps(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static int bird_batch_kernel_sse2(BirdBatch* b, const int32_t* flaps, const BirdBatchStep* st)
+{
+    const __m128 g = _mm_set1_ps(st->g);
+    const __m128 dt = _mm_set1_ps(st->dt);
+    const __m128 ceilY = _mm_set1_ps((float)BIRD_R);
+    const __m128 floorY = _mm_set1_ps(st->floorY);
+    const __m128 jump = _mm_set1_ps(JUMP_V);
+    const __m128i radius = _mm_set1_epi32(BIRD_R);
+    const __m128i passed = _mm_set1_epi32(st->passed);
+    const __m128i zero = _mm_setzero_si128();
+    int count = 0;
+
+    for (int i = 0; i < b->cap; i += 4) {
+        __m128i live = _mm_load_si128((const __m128i*)(b->alive + i));
+        if (_mm_movemask_epi8(live) == 0) continue;
+        __m128 liveF = _mm_castsi128_ps(live);
+
+        __m128 v0 = _mm_load_ps(b->v + i);
+        __m128 y0 = _mm_load_ps(b->y + i);
+        __m128 v = v0;
+        if (flaps) {
+            __m128i f = _mm_load_si128((const __m128i*)(flaps + i));
+            __m128 doFlap = _mm_castsi128_ps(_mm_andnot_si128(_mm_cmpeq_epi32(f, zero), _mm_set1_epi32(-1)));
+            v = bird_select_ps(doFlap, jump, v);
+        }
+        v = _mm_add_ps(v, g);
+        __m128 y = _mm_add_ps(y0, _mm_mul_ps(v, dt));
+
+        __m128 hitCeil = _mm_cmplt_ps(y, ceilY);
+        y = bird_select_ps(hitCeil, ceilY, y);
+        v = _mm_andnot_ps(hitCeil, v);
+        __m128 hitFloor = _mm_cmpgt_ps(y, floorY);
+        y = bird_select_ps(hitFloor, floorY, y);
+        __m128i dead = _mm_castps_si128(hitFloor);
+
+        __m128i yi = _mm_cvttps_epi32(y);
+        __m128i by0 = _mm_sub_epi32(yi, radius);
+        __m128i by1 = _mm_add_epi32(yi, radius);
+        for (int k = 0; k < st->gaps; ++k) {
+            dead = _mm_or_si128(dead, _mm_cmplt_epi32(by0, _mm_set1_epi32(st->gapTop[k])));
+            dead = _mm_or_si128(dead, _mm_cmpgt_epi32(by1, _mm_set1_epi32(st->gapBot[k])));
+        }
+
+        __m128i score = _mm_load_si128((const __m128i*)(b->score + i));
+        _mm_store_si128((__m128i*)(b->score + i), _mm_add_epi32(score, _mm_and_si128(live, passed)));
+        _mm_store_ps(b->y + i, bird_select_ps(liveF, y, y0));
+        _mm_store_ps(b->v + i, bird_select_ps(liveF, v, v0));
+        live = _mm_andnot_si128(dead, live);
+        _mm_store_si128((__m128i*)(b->alive + i), live);
+        count += bird_count_lanes(_mm_movemask_ps(_mm_castsi128_ps(live)));
+    }
+    return count;
+}
+#endif
+
+#if defined(NG_HAVE_AVX2)
+NG_TARGET_AVX2 static int bird_batch_kernel_avx2(BirdBatch* b, const int32_t* flaps, const BirdBatchStep* st)
+{
+    const __m256 g = _mm256_set1_ps(st->g);
+    const __m256 dt = _mm256_set1_ps(st->dt);
+    const __m256 ceilY = _mm256_set1_ps((float)BIRD_R);
+    const __m256 floorY = _mm256_set1_ps(st->floorY);
+    const __m256 jump = _mm256_set1_ps(JUMP_V);
+    const __m256i radius = _mm256_set1_epi32(BIRD_R);
+    const __m256i passed = _mm256_set1_epi32(st->passed);
+    const __m256i zero = _mm256_setzero_si256();
+    int count = 0;
+
+    for (int i = 0; i < b->cap; i += 8) {
+        __m256i live = _mm256_load_si256((const __m256i*)(b->alive + i));
+        if (_mm256_testz_si256(live, live)) continue;
+        __m256 liveF = _mm256_castsi256_ps(live);
+
+        __m256 v0 = _mm256_load_ps(b->v + i);
+        __m256 y0 = _mm256_load_ps(b->y + i);
+        __m256 v = v0;
+        if (flaps) {
+            __m256i f = _mm256_load_si256((const __m256i*)(flaps + i));
+            __m256 stay = _mm256_castsi256_ps(_mm256_cmpeq_epi32(f, zero));
+            v = _mm256_blendv_ps(jump, v, stay);
+        }
+        // Separate mul/add (no FMA) keeps rounding identical to the scalar step.
+        v = _mm256_add_ps(v, g);
+        __m256 y = _mm256_add_ps(y0, _mm256_mul_ps(v, dt));
+
+        __m256 hitCeil = _mm256_cmp_ps(y, ceilY, _CMP_LT_OQ);
+        y = _mm256_blendv_ps(y, ceilY, hitCeil);
+        v = _mm256_andnot_ps(hitCeil, v);
+        __m256 hitFloor = _mm256_cmp_ps(y, floorY, _CMP_GT_OQ);
+        y = _mm256_blendv_ps(y, floorY, hitFloor);
+        __m256i dead = _mm256_castps_si256(hitFloor);
+
+        __m256i yi = _mm256_cvttps_epi32(y);
+        __m256i by0 = _mm256_sub_epi32(yi, radius);
+        __m256i by1 = _mm256_add_epi32(yi, radius);
+        for (int k = 0; k < st->gaps; ++k) {
+            dead = _mm256_or_si256(dead, _mm256_cmpgt_epi32(_mm256_set1_epi32(st->gapTop[k]), by0));
+            dead = _mm256_or_si256(dead, _mm256_cmpgt_epi32(by1, _mm256_set1_epi32(st->gapBot[k])));
+        }
+
+        __m256i score = _mm256_load_si256((const __m256i*)(b->score + i));
+        _mm256_store_si256((__m256i*)(b->score + i), _mm256_add_epi32(score, _mm256_and_si256(live, passed)));
+        _mm256_store_ps(b->y + i, _mm256_blendv_ps(y0, y, liveF));
+        _mm256_store_ps(b->v + i, _mm256_blendv_ps(v0, v, liveF));
+        live = _mm256_andnot_si256(dead, live);
+        _mm256_store_si256((__m256i*)(b->alive + i), live);
+        count += bird_count_lanes(_mm256_movemask_ps(_mm256_castsi256_ps(live)));
+    }
+    return count;
+}
+#endif
+
+static BirdBatchKernel bird_batch_kernel(NgSimdLevel level)
+{
+#if defined(NG_HAVE_AVX2)
+    if (level >= NG_SIMD_AVX2) return bird_batch_kernel_avx2;
+#endif
+#if defined(NG_HAVE_SSE2)
+    if (level >= NG_SIMD_SSE2) return bird_batch_kernel_sse2;
+#endif
+    (void)level;
+    return bird_batch_kernel_scalar;
+}
+
+// ------------------------------------------------------
+// Batch lifetime
+// ------------------------------------------------------
+static void bird_batch_free(BirdBatch* b)
+{
+    NgAlignedFree(b->y);
+    NgAlignedFree(b->v);
+    NgAlignedFree(b->alive);
+    NgAlignedFree(b->score);
+    memset(b, 0, sizeof(*b));
+}
+
+// Allocates n birds for a w x h playfield. simd < 0 picks the best level.
+static bool bird_batch_init(BirdBatch* b, int n, int w, int h, int simd)
+{
+    memset(b, 0, sizeof(*b));
+    b->n = n;
+    b->cap = (n + 7) & ~7;
+    size_t bytes = (size_t)b->cap * 4;
+    b->y = (float*)NgAlignedAlloc(bytes, 32);
+    b->v = (float*)NgAlignedAlloc(bytes, 32);
+    b->alive = (int32_t*)NgAlignedAlloc(bytes, 32);
+    b->score = (int32_t*)NgAlignedAlloc(bytes, 32);
+    if (!b->y || !b->v || !b->alive || !b->score) {
+        bird_batch_free(b);
+        return false;
+    }
+    b->world.w = w;
+    b->world.h = h;
+    b->simd = NgClampSimd(simd);
+    return true;
+}
+
+// Same layout reset_game() produces for a single bird with this seed.
+static void bird_batch_reset(BirdBatch* b, uint32_t seed)
+{
+    b->world.seed = seed;
+    reset_game(&b->world);
+    for (int i = 0; i < b->cap; ++i) {
+        b->y[i] = b->world.birdY;
+        b->v[i] = 0.0f;
+        b->alive[i] = (i < b->n) ? ~0 : 0;
+        b->score[i] = 0;
+    }
+    b->live = b->n;
+}
+
+// Advances every live bird by dt. flaps may be null, else it holds cap
+// entries. The shared ring stops once every bird is dead, like step_game().
+static void bird_batch_step(BirdBatch* b, const int32_t* flaps, float dt)
+{
+    if (dt > 0.05f) dt = 0.05f;
+    if (b->live == 0) return;
+
+    BirdBatchStep st;
+    st.g = GRAV * dt;
+    st.dt = dt;
+    st.floorY = (float)(b->world.h - BIRD_R);
+    st.passed = advance_obstacles(&b->world, dt);
+    st.gaps = 0;
+    for (int k = 0; k < OB_COUNT; ++k) {
+        if (!ob_overlaps_bird(&b->world.obs[k])) continue;
+        int top, bot;
+        ob_gap_rows(&b->world.obs[k], b->world.h, &top, &bot);
+        st.gapTop[st.gaps] = top;
+        st.gapBot[st.gaps] = bot;
+        st.gaps++;
+    }
+
+    b->live = bird_batch_kernel(b->simd)(b, flaps, &st);
+}
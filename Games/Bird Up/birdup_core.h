@@ -0,0 +1,209 @@
+#pragma once
+#include <stdint.h>
+
+#include "../common/hash.h"
+
+// Bird Up simulation state and step, free of Win32 so headless tools can
+// run it. birdup.cpp owns one BirdGame; batch tools own thousands.
+
+enum { OB_COUNT = 4 };
+struct Ob {
+    float x;
+    float gapY;
+    int passed;
+};
+
+struct BirdGame {
+    int w, h;
+    uint32_t seed;
+    Ob obs[OB_COUNT];
+    int score;
+    int alive;
+    float birdY;
+    float birdV;
+};
+
+static const int BIRD_X = 120;
+static const int BIRD_R = 12;
+
+static const int OB_W = 56;
+static const int GAP_H = 150;
+static const int OB_SPACING = 200;
+static const float SPEED = 240.0f;
+static const float GRAV = 1100.0f;
+static const float JUMP_V = -380.0f;
+
+static uint32_t rnd_u32(BirdGame* g) { g->seed = g->seed * 1664525u + 1013904223u; return g->seed; }
+
+// The LCG state after n more rnd_u32 draws, in O(log n): the step
+// x -> a*x + c is composed with itself by repeated squaring.
+static inline uint32_t rnd_skip(uint32_t seed, uint64_t n)
+{
+    uint32_t a = 1664525u, c = 1013904223u;   // step for the current bit of n
+    uint32_t accA = 1, accC = 0;
+    for (; n; n >>= 1) {
+        if (n & 1) { accA *= a; accC = accC * a + c; }
+        c *= a + 1;
+        a *= a;
+    }
+    return accA * seed + accC;
+}
+
+static int clampi(int v, int lo, int hi) { return v < lo ? lo : (v > hi ? hi : v); }
+
+static float random_gap_y(BirdGame* g)
+{
+    int margin = 60;
+    int top = margin + GAP_H / 2;
+    int bot = g->h - margin - GAP_H / 2;
+    int r = top + (int)(rnd_u32(g) % (uint32_t)(bot - top + 1));
+    return (float)r;
+}
+
+// Gap centre of the k-th column to respawn from now (k >= 1), without
+// stepping: every respawn draws exactly one rnd_u32.
+static inline float gap_ahead(const BirdGame* g, uint64_t k)
+{
+    BirdGame t = *g;
+    t.seed = rnd_skip(g->seed, k - 1);
+    return random_gap_y(&t);
+}
+
+// Pixel rows of the opening in obstacle o, clamped to the playfield.
+static void ob_gap_rows(const Ob* o, int h, int* gapTop, int* gapBot)
+{
+    *gapTop = clampi((int)(o->gapY - GAP_H * 0.5f), 0, h);
+    *gapBot = clampi((int)(o->gapY + GAP_H * 0.5f), 0, h);
+}
+
+// True when obstacle o spans the bird's columns.
+static int ob_overlaps_bird(const Ob* o)
+{
+    int left = (int)o->x;
+    int right = left + OB_W;
+    return BIRD_X + BIRD_R > left && BIRD_X - BIRD_R < right;
+}
+
+static void reset_game(BirdGame* g)
+{
+    g->score = 0;
+    g->alive = 1;
+    g->birdY = g->h * 0.5f;
+    g->birdV = 0.0f;
+
+    float startX = (float)g->w + 120.0f;
+    for (int i = 0; i < OB_COUNT; ++i) {
+        g->obs[i].x = startX + (float)(i * OB_SPACING);
+        g->obs[i].gapY = random_gap_y(g);
+        g->obs[i].passed = 0;
+    }
+}
+
+static void flap(BirdGame* g)
+{
+    if (g->alive) g->birdV = JUMP_V;
+}
+
+// Scrolls the obstacle ring by dt, respawning columns that left the screen.
+// Returns how many columns crossed the bird this step.
+static int advance_obstacles(BirdGame* g, float dt)
+{
+    int passed = 0;
+    float maxX = 0.0f;
+    for (int i = 0; i < OB_COUNT; ++i) if (g->obs[i].x > maxX) maxX = g->obs[i].x;
+
+    for (int i = 0; i < OB_COUNT; ++i) {
+        Ob* o = &g->obs[i];
+        o->x -= SPEED * dt;
+
+        if (!o->passed && o->x + (float)OB_W < (float)(BIRD_X - BIRD_R)) {
+            o->passed = 1;
+            ++passed;
+        }
+
+        if (o->x < -(float)OB_W) {
+            o->x = maxX + (float)OB_SPACING;
+            maxX = o->x;
+            o->gapY = random_gap_y(g);
+            o->passed = 0;
+        }
+    }
+    return passed;
+}
+
+static void step_game(BirdGame* g, float dt)
+{
+    if (dt > 0.05f) dt = 0.05f;
+    if (!g->alive) return;
+
+    g->birdV += GRAV * dt;
+    g->birdY += g->birdV * dt;
+
+    if (g->birdY < (float)BIRD_R) { g->birdY = (float)BIRD_R; g->birdV = 0.0f; }
+    if (g->birdY > (float)(g->h - BIRD_R)) { g->birdY = (float)(g->h - BIRD_R); g->alive = 0; }
+
+    g->score += advance_obstacles(g, dt);
+
+    int by0 = (int)g->birdY - BIRD_R;
+    int by1 = (int)g->birdY + BIRD_R;
+    for (int i = 0; i < OB_COUNT; ++i) {
+        if (!ob_overlaps_bird(&g->obs[i])) continue;
+        int gapTop, gapBot;
+        ob_gap_rows(&g->obs[i], g->h, &gapTop, &gapBot);
+        if (by0 < gapTop || by1 > gapBot) g->alive = 0;
+    }
+}
+
+// Per-tick input word for bird_tick and replays: keys held in the low 8
+// bits, the point the press happened at (in 128ths of the tick, 0 = its
+// start) in bits 8-14, keys newly pressed this tick in the high 16.
+enum { BIRD_KEY_SPACE = 1 << 0 };
+
+static inline uint32_t bird_input(uint32_t down, uint32_t pressed, uint32_t at)
+{
+    return (down & 0xFF) | (at & 0x7F) << 8 | pressed << 16;
+}
+
+static inline void bird_init(BirdGame* g, int w, int h, uint32_t seed)
+{
+    *g = BirdGame();
+    g->w = w;
+    g->h = h;
+    g->seed = seed;
+    reset_game(g);
+}
+
+// One fixed tick: a fresh Space press flaps, or restarts after a crash.
+// A flap lands where in the tick it was pressed: the bird falls up to that
+// point, then climbs for the rest.
+static inline void bird_tick(BirdGame* g, uint32_t input, float dt)
+{
+    if ((input >> 16) & BIRD_KEY_SPACE) {
+        float early = g->alive ? dt * (float)((input >> 8) & 0x7F) * (1.0f / 128.0f) : 0.0f;
+        if (early > 0.0f) {
+            step_game(g, early);
+            dt -= early;
+        }
+        if (g->alive) flap(g);
+        else if (early == 0.0f) reset_game(g);
+    }
+    step_game(g, dt);
+}
+
+// True when nothing moves until Space: the game-over screen.
+static inline int bird_at_rest(const BirdGame* g)
+{
+    return !g->alive;
+}
+
+static inline uint64_t bird_hash(const BirdGame* g)
+{
+    uint64_t h = kHashSeed;
+    h = HashI32(h, g->w); h = HashI32(h, g->h); h = HashU32(h, g->seed);
+    for (int i = 0; i < OB_COUNT; ++i) {
+        h = HashF32(h, g->obs[i].x); h = HashF32(h, g->obs[i].gapY); h = HashI32(h, g->obs[i].passed);
+    }
+    h = HashI32(h, g->score); h = HashI32(h, g->alive);
+    h = HashF32(h, g->birdY); h = HashF32(h, g->birdV);
+    return h;
+}
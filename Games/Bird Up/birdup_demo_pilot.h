@@ -0,0 +1,19 @@
+#pragma once
+
+// Bird Up demo autopilot, generated by tools/birdup_train; do not edit.
+// 60 generations of 512, 16 episodes each, seed 1; mean fitness 51.70.
+// Weight layout: see pilot_decide() in birdup_pilot.h.
+
+static const float BIRD_DEMO_PILOT[65] = {
+    -0.163446799f, 1.25050306f, 2.21381021f, -0.308965534f, -0.973772764f, -1.29054046f,
+    0.601010978f, -0.171373427f, 0.714952707f, 0.166477799f, 0.496109396f, 0.462597936f,
+    1.29208267f, -0.0184575524f, 0.629571378f, 0.832765579f, -2.5115478f, -0.475374281f,
+    1.05305612f, -0.563245535f, -0.276166946f, 0.163786173f, 0.831488788f, -1.63002872f,
+    0.117558077f, -1.36016762f, 1.15027487f, -2.15986037f, -0.41645506f, -0.738618851f,
+    0.43031925f, -0.206766427f, 1.12710774f, 1.11434877f, -1.29021144f, 0.0337318704f,
+    -1.12079382f, -0.353874892f, -1.63832319f, -0.880177796f, -0.548306465f, -1.49983108f,
+    0.657688618f, -0.699762225f, 0.00820820779f, -0.7181198f, -0.952310264f, -1.09130001f,
+    0.317392051f, 0.470204771f, 1.37736893f, 0.915028036f, -0.211381704f, -0.354674578f,
+    -0.163434952f, -0.871560752f, -1.46928096f, -0.242167115f, 1.89231861f, 1.72842789f,
+    0.0118119735f, -0.50077641f, 0.729474723f, -0.697162867f, -0.385145277f,
+};
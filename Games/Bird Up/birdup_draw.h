@@ -0,0 +1,107 @@
+#pragma once
+#include <stdint.h>
+
+#include "birdup_core.h"
+#include "../common/shapes.h"
+
+// Software renderer for Bird Up: draws a BirdGame straight into a 32 bpp
+// pixel buffer with no GDI objects involved, so it also runs headless.
+// Text is left to the caller.
+
+// Palette, as packed 0x00RRGGBB DIB pixels.
+static const uint32_t C_SKY_TOP = 0x0C1016;
+static const uint32_t C_SKY_BOT = 0x181E28;
+static const uint32_t C_STRIPE = 0x1C2430;
+static const uint32_t C_OB_OUTLINE = 0x143C1E;
+static const uint32_t C_OB_MAIN = 0x46C85A;
+static const uint32_t C_OB_HI = 0x6EE682;
+static const uint32_t C_OB_LO = 0x289141;
+static const uint32_t C_CAP_MAIN = 0x55DC6E;
+static const uint32_t C_CAP_HI = 0x7DF091;
+static const uint32_t C_CAP_LO = 0x37AA50;
+static const uint32_t C_SHADOW = 0x000000;
+static const uint32_t C_BIRD_OUTLINE = 0xAA7814;
+static const uint32_t C_BIRD_BODY = 0xFADC46;
+static const uint32_t C_BIRD_HI = 0xFFF5A0;
+static const uint32_t C_WING_OUTLINE = 0xA06E19;
+static const uint32_t C_WING = 0xEBC837;
+static const uint32_t C_EYE = 0xFAFAFA;
+static const uint32_t C_PUPIL = 0x1E1E1E;
+static const uint32_t C_BEAK_OUTLINE = 0x96500A;
+static const uint32_t C_BEAK = 0xFF9628;
+
+static const int CAP_H = 14;
+
+static void draw_background(const Surface& s)
+{
+    // Subtle vertical gradient + faint stripes
+    RasterVGradient(s, C_SKY_TOP, C_SKY_BOT, 4);
+    for (int x = 0; x < s.w; x += 40) RasterFillRect(s, x, 0, x + 1, s.h, C_STRIPE);
+}
+
+// Obstacle pipe segment [y0, y1) with its highlight and shadow strips.
+static void draw_ob_segment(const Surface& s, int left, int right, int y0, int y1)
+{
+    int hiW = (OB_W >= 10) ? 8 : OB_W / 3;
+    int loW = (OB_W >= 10) ? 8 : OB_W / 3;
+    RasterBox(s, left, y0, right, y1, C_OB_MAIN, C_OB_OUTLINE);
+    RasterBox(s, left + 1, y0 + 1, left + 1 + hiW, y1 - 1, C_OB_HI, C_OB_OUTLINE);
+    RasterBox(s, right - 1 - loW, y0 + 1, right - 1, y1 - 1, C_OB_LO, C_OB_OUTLINE);
+}
+
+// Cap around the gap edge, spanning rows [y0, y1).
+static void draw_ob_cap(const Surface& s, int left, int right, int y0, int y1)
+{
+    RasterBox(s, left - 3, y0, right + 3, y1, C_CAP_MAIN, C_OB_OUTLINE);
+    RasterBox(s, left - 2, y0 + 1, left + 6, y1 - 1, C_CAP_HI, C_OB_OUTLINE);
+    RasterBox(s, right - 6, y0 + 1, right + 2, y1 - 1, C_CAP_LO, C_OB_OUTLINE);
+}
+
+static void draw_obstacle(const Surface& s, const Ob* o)
+{
+    int left = (int)o->x;
+    int right = left + OB_W;
+    int gapTop, gapBot;
+    ob_gap_rows(o, s.h, &gapTop, &gapBot);
+
+    if (gapTop > 0) {
+        draw_ob_segment(s, left, right, 0, gapTop);
+        int capY0 = gapTop - CAP_H;
+        if (capY0 < 0) capY0 = 0;
+        draw_ob_cap(s, left, right, capY0, gapTop);
+    }
+    if (gapBot < s.h) {
+        draw_ob_segment(s, left, right, gapBot, s.h);
+        int capY1 = gapBot + CAP_H;
+        if (capY1 > s.h) capY1 = s.h;
+        draw_ob_cap(s, left, right, gapBot, capY1);
+    }
+}
+
+// Bird centred on (cx, cy): shadow, body, highlight, wing, eye, beak.
+// Shapes drawn without a pen shrink by one pixel, as GDI's NULL_PEN does.
+static void draw_bird(const Surface& s, int cx, int cy)
+{
+    int bx0 = cx - BIRD_R;
+    int by0 = cy - BIRD_R;
+    int bx1 = cx + BIRD_R;
+    int by1 = cy + BIRD_R;
+
+    RasterFillEllipse(s, bx0 + 4, by0 + 5, bx1 + 4 - 1, by1 + 5 - 1, C_SHADOW);
+    RasterEllipse(s, bx0, by0, bx1, by1, C_BIRD_BODY, C_BIRD_OUTLINE, 2);
+    RasterFillEllipse(s, bx0 + 3, by0 + 3, bx0 + BIRD_R - 1, by0 + BIRD_R - 1, C_BIRD_HI);
+    RasterEllipse(s, cx - 10, cy - 2, cx + 6, cy + 10, C_WING, C_WING_OUTLINE);
+    RasterFillEllipse(s, cx + 1, cy - 8, cx + 10 - 1, cy + 1 - 1, C_EYE);
+    RasterFillEllipse(s, cx + 6, cy - 5, cx + 9 - 1, cy - 2 - 1, C_PUPIL);
+
+    int beakX[3] = { cx + BIRD_R - 1, cx + BIRD_R + 10, cx + BIRD_R - 1 };
+    int beakY[3] = { cy - 1, cy + 2, cy + 5 };
+    RasterTriangle(s, beakX, beakY, C_BEAK, C_BEAK_OUTLINE);
+}
+
+static void draw_game(const Surface& s, const BirdGame* g)
+{
+    draw_background(s);
+    for (int i = 0; i < OB_COUNT; ++i) draw_obstacle(s, &g->obs[i]);
+    draw_bird(s, BIRD_X, (int)g->birdY);
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "birdup_core.h"
+#include "birdup_draw.h"
+#include "../common/particles.h"
+
+// Bird Up particle effects: a puff of feathers on each flap and a burst when
+// the bird crashes. Like the sounds they come from the states a frame and
+// the one before it showed, so the core stays untouched, and they are owned
+// by whichever thread draws.
+
+static const int FX_CAPACITY = 2048;
+static const float FX_GRAVITY = 500.0f;
+static const float FX_KEEP = 0.2f;
+
+static inline void bird_effects(ParticlePool& fx, const BirdGame* prev, const BirdGame* cur)
+{
+    const float pi = 3.14159265f;
+    if (prev->alive && !cur->alive)
+    {
+        ParticleBurst b = { (float)BIRD_X, cur->birdY, -pi * 0.5f, pi, 60.0f, 520.0f, 0.6f, 1.4f, C_BIRD_BODY, 260 };
+        ParticleEmit(fx, b);
+        ParticleBurst hot = { (float)BIRD_X, cur->birdY, -pi * 0.5f, pi, 30.0f, 260.0f, 0.3f, 0.8f, C_BEAK, 120 };
+        ParticleEmit(fx, hot);
+        return;
+    }
+    // Gravity only ever raises birdV, so a drop means a flap landed in
+    // between (a reset starts dead, so it doesn't count).
+    if (prev->alive && cur->alive && cur->birdV < prev->birdV)
+    {
+        // Down and back: the world scrolls left past the bird.
+        ParticleBurst b = { (float)(BIRD_X - BIRD_R / 2), cur->birdY + BIRD_R * 0.6f, pi * 0.75f, 0.5f,
+                            60.0f, 200.0f, 0.25f, 0.5f, C_BIRD_HI, 24 };
+        ParticleEmit(fx, b);
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <stdint.h>
+
+#include "birdup_core.h"
+
+// Autopilot controllers: a tiny fixed-size neural net that looks at the bird
+// and the next two gaps and decides whether to flap this tick.
+//
+// Trained offline by tools/birdup_train; the winner is exported as a table of
+// PILOT_WEIGHTS floats (birdup_demo_pilot.h) that drives the game's demo
+// mode. Only +, *, / and compares are used (softsign, not tanh), so a
+// controller makes the same choices on every compiler and libm.
+
+enum {
+    PILOT_IN = 6,     // bird y, bird v, gap 1 dy, gap 1 dx, gap 2 dy, gap 2 dx
+    PILOT_HID = 8,
+    PILOT_WEIGHTS = PILOT_HID * (PILOT_IN + 1) + PILOT_HID + 1,
+};
+
+// What the pilot sees of the obstacles, shared by every bird in a world.
+struct PilotView
+{
+    float gapY[2];    // centres of the next two gaps
+    float gapX[2];    // their left edges
+};
+
+// The two columns the bird still has to clear, nearest first.
+static void pilot_view(const BirdGame* world, PilotView* pv)
+{
+    int first = -1, second = -1;
+    for (int k = 0; k < OB_COUNT; ++k) {
+        const Ob* o = &world->obs[k];
+        if (o->x + (float)OB_W < (float)(BIRD_X - BIRD_R)) continue;
+        if (first < 0 || o->x < world->obs[first].x) { second = first; first = k; }
+        else if (second < 0 || o->x < world->obs[second].x) second = k;
+    }
+    for (int i = 0; i < 2; ++i) {
+        int k = (i == 0) ? first : second;
+        pv->gapY[i] = (k >= 0) ? world->obs[k].gapY : world->h * 0.5f;
+        pv->gapX[i] = (k >= 0) ? world->obs[k].x : (float)(world->w + OB_SPACING);
+    }
+}
+
+static inline float pilot_softsign(float x)
+{
+    return x / (1.0f + (x < 0.0f ? -x : x));
+}
+
+// 1 to flap this tick. w holds PILOT_WEIGHTS floats: for each hidden unit
+// its PILOT_IN input weights then its bias, then the output weights and bias.
+static int pilot_decide(const float* w, const PilotView* pv, float y, float v, int h)
+{
+    float in[PILOT_IN] = {
+        (y - h * 0.5f) * (1.0f / 200.0f),
+        v * (1.0f / 400.0f),
+        (pv->gapY[0] - y) * (1.0f / 200.0f),
+        (pv->gapX[0] - (float)BIRD_X) * (1.0f / (float)OB_SPACING),
+        (pv->gapY[1] - y) * (1.0f / 200.0f),
+        (pv->gapX[1] - (float)BIRD_X) * (1.0f / (float)OB_SPACING),
+    };
+    const float* out = w + PILOT_HID * (PILOT_IN + 1);
+    float sum = out[PILOT_HID];
+    for (int j = 0; j < PILOT_HID; ++j) {
+        const float* row = w + j * (PILOT_IN + 1);
+        float a = row[PILOT_IN];
+        for (int i = 0; i < PILOT_IN; ++i) a += row[i] * in[i];
+        sum += out[j] * pilot_softsign(a);
+    }
+    return sum > 0.0f;
+}
+
+// Input word for bird_tick: flap when the pilot says so, restart after a crash.
+static inline uint32_t pilot_input(const float* w, const BirdGame* g)
+{
+    if (!g->alive) return BIRD_KEY_SPACE << 16;
+    PilotView pv;
+    pilot_view(g, &pv);
+    return pilot_decide(w, &pv, g->birdY, g->birdV, g->h) ? (BIRD_KEY_SPACE | BIRD_KEY_SPACE << 16) : 0;
+}
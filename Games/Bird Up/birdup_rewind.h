@@ -0,0 +1,166 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+#include "birdup_core.h"
+
+// Rewind ring for Bird Up: the BirdGame after every tick, in fixed memory.
+//
+// Every REWIND_KEY_EVERY ticks a full snapshot (keyframe) is stored; the
+// ticks in between store only the 32-bit words that differ from their
+// keyframe, behind a bitmask. A typical tick changes the bird and the
+// column positions, about 40% of the state. Seeking to any tick still in
+// the ring costs one keyframe copy plus one delta patch, however far back.
+//
+// Records live in a byte ring and are evicted oldest first, a keyframe
+// group at a time, when space or index slots run out.
+
+enum {
+    REWIND_TICKS = 8192,       // index slots (power of two)
+    REWIND_KEY_EVERY = 64,
+    REWIND_BYTES = 1 << 18,
+    REWIND_WORDS = sizeof(BirdGame) / 4,
+};
+
+static_assert(sizeof(BirdGame) % 4 == 0 && REWIND_WORDS <= 32, "delta mask is one word per state word");
+
+struct RewindEntry
+{
+    uint32_t offset;     // into bytes
+    uint16_t size;
+    uint16_t keyDist;    // ticks since its keyframe; 0 = keyframe
+};
+
+struct BirdRewind
+{
+    uint64_t first, next;   // ticks [first, next) are held
+    uint32_t head;          // next write offset
+    BirdGame key;           // keyframe the newest deltas are against
+    RewindEntry idx[REWIND_TICKS];
+    uint8_t bytes[REWIND_BYTES];
+};
+
+static void rewind_reset(BirdRewind* r)
+{
+    r->first = r->next = 0;
+    r->head = 0;
+}
+
+static inline int rewind_empty(const BirdRewind* r) { return r->first == r->next; }
+
+static inline RewindEntry* rewind_entry(BirdRewind* r, uint64_t tick)
+{
+    return &r->idx[tick & (REWIND_TICKS - 1)];
+}
+
+// Drops the oldest keyframe and the deltas that depend on it.
+static void rewind_evict_group(BirdRewind* r)
+{
+    do ++r->first;
+    while (r->first < r->next && rewind_entry(r, r->first)->keyDist != 0);
+}
+
+// Room for a record of `size` bytes; returns its offset.
+static uint32_t rewind_alloc(BirdRewind* r, uint32_t size)
+{
+    if (r->head + size > REWIND_BYTES) r->head = 0;
+    // Records sit in the ring in tick order, so only the oldest can be in
+    // the way; evict until it isn't.
+    while (!rewind_empty(r)) {
+        const RewindEntry* e = rewind_entry(r, r->first);
+        if (e->offset >= r->head + size || e->offset + e->size <= r->head) break;
+        rewind_evict_group(r);
+    }
+    uint32_t at = r->head;
+    r->head += size;
+    return at;
+}
+
+// Appends the state after tick r->next.
+static void rewind_push(BirdRewind* r, const BirdGame* g)
+{
+    uint64_t tick = r->next;
+    if (tick - r->first >= REWIND_TICKS) rewind_evict_group(r);
+
+    uint32_t keyDist = 0;
+    if (tick > r->first) {
+        keyDist = rewind_entry(r, tick - 1)->keyDist + 1u;
+        if (keyDist >= REWIND_KEY_EVERY) keyDist = 0;
+    }
+
+    uint8_t rec[4 + sizeof(BirdGame)];
+    uint32_t size;
+    if (keyDist == 0) {
+        memcpy(rec, g, sizeof(BirdGame));
+        size = sizeof(BirdGame);
+        r->key = *g;
+    } else {
+        uint32_t cur[REWIND_WORDS], key[REWIND_WORDS], mask = 0;
+        memcpy(cur, g, sizeof(cur));
+        memcpy(key, &r->key, sizeof(key));
+        size = 4;
+        for (int i = 0; i < REWIND_WORDS; ++i) {
+            if (cur[i] == key[i]) continue;
+            mask |= 1u << i;
+            memcpy(rec + size, &cur[i], 4);
+            size += 4;
+        }
+        memcpy(rec, &mask, 4);
+    }
+
+    uint32_t at = rewind_alloc(r, size);
+    // Eviction may have taken this tick's keyframe; start a new group.
+    if (keyDist != 0 && r->first == r->next) {
+        r->head = at;
+        r->first = r->next = tick;
+        rewind_push(r, g);
+        return;
+    }
+    memcpy(r->bytes + at, rec, size);
+    RewindEntry* e = rewind_entry(r, tick);
+    e->offset = at;
+    e->size = (uint16_t)size;
+    e->keyDist = (uint16_t)keyDist;
+    r->next = tick + 1;
+}
+
+// State after `tick`; false if it's no longer (or not yet) in the ring.
+static int rewind_seek(BirdRewind* r, uint64_t tick, BirdGame* out)
+{
+    if (tick < r->first || tick >= r->next) return 0;
+    const RewindEntry* e = rewind_entry(r, tick);
+    const RewindEntry* k = rewind_entry(r, tick - e->keyDist);
+    memcpy(out, r->bytes + k->offset, sizeof(BirdGame));
+    if (e->keyDist == 0) return 1;
+
+    uint32_t words[REWIND_WORDS], mask;
+    memcpy(words, out, sizeof(words));
+    const uint8_t* p = r->bytes + e->offset;
+    memcpy(&mask, p, 4);
+    p += 4;
+    for (int i = 0; i < REWIND_WORDS; ++i) {
+        if (!(mask & (1u << i))) continue;
+        memcpy(&words[i], p, 4);
+        p += 4;
+    }
+    memcpy(out, words, sizeof(words));
+    return 1;
+}
+
+// Forgets every tick after `tick` so play can branch from there.
+static void rewind_truncate(BirdRewind* r, uint64_t tick)
+{
+    if (tick < r->first || tick >= r->next) return;
+    const RewindEntry* e = rewind_entry(r, tick);
+    memcpy(&r->key, r->bytes + rewind_entry(r, tick - e->keyDist)->offset, sizeof(BirdGame));
+    r->head = e->offset + e->size;
+    r->next = tick + 1;
+}
+
+// Bytes the held ticks take, for stats.
+static uint64_t rewind_bytes_used(BirdRewind* r)
+{
+    uint64_t n = 0;
+    for (uint64_t t = r->first; t < r->next; ++t) n += rewind_entry(r, t)->size;
+    return n;
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include "birdup_core.h"
+#include "../common/synth.h"
+
+// Bird Up sound effects, from the tick input and the states either side of
+// the tick, so the core stays silent and replays sound like the real run.
+
+//                                    wave           f0     f1     att     hold   rel    vol    duty
+static const SynthSound SFX_FLAP  = { SYNTH_SQUARE,   260,   620,   0.004f, 0.02f, 0.07f, 0.25f, 0.25f };
+static const SynthSound SFX_PASS  = { SYNTH_SQUARE,   988,   1318,  0.002f, 0.06f, 0.12f, 0.25f, 0.5f };
+static const SynthSound SFX_CRASH = { SYNTH_NOISE,    3000,  150,   0.002f, 0.05f, 0.45f, 0.60f, 0.5f };
+
+static inline void bird_sounds(Synth& synth, const BirdGame* prev, const BirdGame* cur, uint32_t input, double now)
+{
+    if (prev->alive && ((input >> 16) & BIRD_KEY_SPACE)) SynthPlay(synth, SFX_FLAP, 1.0f, now);
+    if (prev->alive && cur->score > prev->score) SynthPlay(synth, SFX_PASS, 1.0f, now);
+    if (prev->alive && !cur->alive) SynthPlay(synth, SFX_CRASH, 1.0f, now);
+}
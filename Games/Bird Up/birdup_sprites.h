@@ -0,0 +1,126 @@
+#pragma once
+#include <stdint.h>
+
+#include "birdup_draw.h"
+#include "../common/sprite.h"
+#include "../common/damage.h"
+
+// Sprite cache for the Bird Up renderer. Everything draw_game paints is the
+// same from frame to frame apart from its position, so it is baked once per
+// backbuffer size with the draw_* primitives and blitted from then on:
+//   - the sky (gradient + stripes), restored with block copies,
+//   - one full-height pipe column, clipped to each segment's rows,
+//   - the cap, and the bird on a colour-keyed sprite.
+// The target keeps last frame's pixels, so only the sky under what was drawn
+// last frame or is about to be drawn gets restored. Anything the caller draws
+// on top (text) must be reported with sprites_touch. draw_game_cached then
+// produces exactly the pixels draw_game would.
+
+// Bird sprite extent around its centre (shadow and beak included).
+static const int BIRD_SPR_OX = BIRD_R + 2;
+static const int BIRD_SPR_OY = BIRD_R + 2;
+static const int BIRD_SPR_W = BIRD_SPR_OX + BIRD_R + 14;
+static const int BIRD_SPR_H = BIRD_SPR_OY + BIRD_R + 8;
+
+struct BirdSprites
+{
+    int w, h;          // backbuffer size the sprites were baked for
+    Surface sky;       // w x h
+    Surface column;    // OB_W x h pipe segment spanning the whole height
+    Surface cap;       // (OB_W + 6) x CAP_H
+    Surface bird;      // keyed with kSpriteKey
+    DamageList drawn;  // target regions that no longer show plain sky
+    bool full;         // target contents unknown: restore everything
+};
+
+static void free_sprites(BirdSprites* c)
+{
+    SpriteFree(c->sky);
+    SpriteFree(c->column);
+    SpriteFree(c->cap);
+    SpriteFree(c->bird);
+    c->w = c->h = 0;
+}
+
+// (Re)bakes every sprite for a w x h backbuffer. Returns false if out of
+// memory, in which case draw_game_cached falls back to draw_game.
+static bool bake_sprites(BirdSprites* c, int w, int h)
+{
+    free_sprites(c);
+    if (w <= 0 || h <= 0) return false;
+    if (!SpriteAlloc(c->sky, w, h) || !SpriteAlloc(c->column, OB_W, h) ||
+        !SpriteAlloc(c->cap, OB_W + 6, CAP_H) || !SpriteAlloc(c->bird, BIRD_SPR_W, BIRD_SPR_H))
+    {
+        free_sprites(c);
+        return false;
+    }
+
+    draw_background(c->sky);
+    // A top segment [0, gapTop) and a bottom one [gapBot, h) both match this
+    // column row for row, except for the rows the cap covers.
+    draw_ob_segment(c->column, 0, OB_W, 0, h);
+    draw_ob_cap(c->cap, 3, 3 + OB_W, 0, CAP_H);
+    RasterClear(c->bird, kSpriteKey);
+    draw_bird(c->bird, BIRD_SPR_OX, BIRD_SPR_OY);
+
+    c->w = w;
+    c->h = h;
+    c->full = true;
+    DamageReset(c->drawn, w, h);
+    return true;
+}
+
+// Marks a target region the caller drew over, e.g. with GDI text.
+static inline void sprites_touch(BirdSprites* c, int x0, int y0, int x1, int y1)
+{
+    DamageRect r = { x0, y0, x1, y1 };
+    if (c->w) DamageAdd(c->drawn, r);
+}
+
+static void blit_obstacle(const Surface& s, const BirdSprites* c, const Ob* o)
+{
+    int left = (int)o->x;
+    int gapTop, gapBot;
+    ob_gap_rows(o, s.h, &gapTop, &gapBot);
+
+    // A cap squashed against the screen edge is a different shape; draw
+    // those with primitives (only happens on very short windows).
+    if (gapTop < CAP_H || gapBot > s.h - CAP_H) {
+        draw_obstacle(s, o);
+        return;
+    }
+    BlitRows(s, c->column, left, 0, 0, gapTop - CAP_H);
+    Blit(s, c->cap, left - 3, gapTop - CAP_H);
+    Blit(s, c->cap, left - 3, gapBot);
+    BlitRows(s, c->column, left, 0, gapBot + CAP_H, s.h);
+}
+
+static void draw_game_cached(const Surface& s, BirdSprites* c, const BirdGame* g)
+{
+    if (c->w != s.w || c->h != s.h) {
+        draw_game(s, g);
+        return;
+    }
+
+    // Column rects are widened to the caps; the bird rect is its sprite.
+    DamageRect cur[OB_COUNT + 1];
+    for (int i = 0; i < OB_COUNT; ++i) {
+        int left = (int)g->obs[i].x;
+        cur[i] = DamageRect{ left - 3, 0, left + OB_W + 3, s.h };
+    }
+    int bx = BIRD_X - BIRD_SPR_OX, by = (int)g->birdY - BIRD_SPR_OY;
+    cur[OB_COUNT] = DamageRect{ bx, by, bx + BIRD_SPR_W, by + BIRD_SPR_H };
+
+    if (c->full || s.stride != c->sky.stride) {
+        BlitAll(s, c->sky);
+        c->full = false;
+    } else {
+        for (int i = 0; i <= OB_COUNT; ++i) DamageAdd(c->drawn, cur[i]);
+        DamageRestore(c->drawn, s.pixels, c->sky.pixels, s.stride);
+    }
+    DamageReset(c->drawn, s.w, s.h);
+    for (int i = 0; i <= OB_COUNT; ++i) DamageAdd(c->drawn, cur[i]);
+
+    for (int i = 0; i < OB_COUNT; ++i) blit_obstacle(s, c, &g->obs[i]);
+    BlitKeyed(s, c->bird, bx, by);
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <windows.h>
+
+// ======================================================
+// CPU time per minute of wall time, for the title-bar stats
+//
+// GetProcessTimes gives the user + kernel time of every thread in the
+// process (audio included) in 100 ns units; sampling it against the clock
+// shows what a mode really costs, e.g. how much idling saves.
+// ======================================================
+
+struct CpuMeter {
+    ULONGLONG cpu;          // process CPU time at the last sample, 100 ns
+    ULONGLONG wall;         // GetTickCount64 at the last sample, ms
+};
+
+static inline ULONGLONG CpuMeterProcessTime() {
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) return 0;
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime; k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime; u.HighPart = user.dwHighDateTime;
+    return k.QuadPart + u.QuadPart;
+}
+
+static inline void CpuMeterInit(CpuMeter& m) {
+    m.cpu = CpuMeterProcessTime();
+    m.wall = GetTickCount64();
+}
+
+// CPU seconds used per minute since the last call (or CpuMeterInit); false
+// if less than `minMs` has passed, leaving the window open.
+static inline bool CpuMeterTake(CpuMeter& m, ULONGLONG minMs, double* secsPerMin) {
+    ULONGLONG wall = GetTickCount64();
+    if (wall - m.wall < minMs || wall == m.wall) return false;
+    ULONGLONG cpu = CpuMeterProcessTime();
+    *secsPerMin = (double)(cpu - m.cpu) * 1e-7 * 60000.0 / (double)(wall - m.wall);
+    m.cpu = cpu;
+    m.wall = wall;
+    return true;
+}
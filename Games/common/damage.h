@@ -0,0 +1,123 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+// ======================================================
+// Damage list: the screen regions that changed this frame
+//
+// Rects are half-open [x0, x1) x [y0, y1). Overlapping rects are merged
+// into their bounding box as they are added, so the final list never
+// covers a pixel twice and its area is the real restore/present cost.
+// ======================================================
+
+struct DamageRect {
+    int x0, y0, x1, y1;
+};
+
+enum { kDamageMaxRects = 16 };
+
+struct DamageList {
+    DamageRect rects[kDamageMaxRects];
+    int count;
+    int w, h;        // clip bounds
+};
+
+static inline bool DamageEmpty(const DamageRect& r) {
+    return r.x1 <= r.x0 || r.y1 <= r.y0;
+}
+
+static inline bool DamageOverlaps(const DamageRect& a, const DamageRect& b) {
+    return a.x0 < b.x1 && b.x0 < a.x1 && a.y0 < b.y1 && b.y0 < a.y1;
+}
+
+static inline DamageRect DamageUnion(const DamageRect& a, const DamageRect& b) {
+    DamageRect r;
+    r.x0 = a.x0 < b.x0 ? a.x0 : b.x0;
+    r.y0 = a.y0 < b.y0 ? a.y0 : b.y0;
+    r.x1 = a.x1 > b.x1 ? a.x1 : b.x1;
+    r.y1 = a.y1 > b.y1 ? a.y1 : b.y1;
+    return r;
+}
+
+static inline int64_t DamageRectArea(const DamageRect& r) {
+    return DamageEmpty(r) ? 0 : (int64_t)(r.x1 - r.x0) * (int64_t)(r.y1 - r.y0);
+}
+
+static inline void DamageReset(DamageList& d, int w, int h) {
+    d.count = 0;
+    d.w = w;
+    d.h = h;
+}
+
+static inline void DamageAdd(DamageList& d, DamageRect r) {
+    if (r.x0 < 0) r.x0 = 0;
+    if (r.y0 < 0) r.y0 = 0;
+    if (r.x1 > d.w) r.x1 = d.w;
+    if (r.y1 > d.h) r.y1 = d.h;
+    if (DamageEmpty(r)) return;
+
+    for (;;) {
+        // Absorb every rect the new one touches; the grown rect may now
+        // touch others, so rescan until nothing overlaps.
+        for (int i = 0; i < d.count;) {
+            if (DamageOverlaps(d.rects[i], r)) {
+                r = DamageUnion(d.rects[i], r);
+                d.rects[i] = d.rects[--d.count];
+                i = 0;
+            } else {
+                i++;
+            }
+        }
+        if (d.count < kDamageMaxRects) break;
+
+        // Out of slots: fold in the rect whose union wastes the least area.
+        int best = 0;
+        int64_t bestCost = INT64_MAX;
+        for (int i = 0; i < d.count; i++) {
+            int64_t cost = DamageRectArea(DamageUnion(d.rects[i], r)) - DamageRectArea(d.rects[i]);
+            if (cost < bestCost) { bestCost = cost; best = i; }
+        }
+        r = DamageUnion(d.rects[best], r);
+        d.rects[best] = d.rects[--d.count];
+    }
+    d.rects[d.count++] = r;
+}
+
+static inline void DamageAddAll(DamageList& d) {
+    DamageRect all = { 0, 0, d.w, d.h };
+    d.count = 0;
+    DamageAdd(d, all);
+}
+
+static inline bool DamageTouches(const DamageList& d, const DamageRect& r) {
+    for (int i = 0; i < d.count; i++) {
+        if (DamageOverlaps(d.rects[i], r)) return true;
+    }
+    return false;
+}
+
+static inline bool DamageCovers(const DamageList& d, const DamageRect& r) {
+    for (int i = 0; i < d.count; i++) {
+        const DamageRect& o = d.rects[i];
+        if (o.x0 <= r.x0 && o.y0 <= r.y0 && o.x1 >= r.x1 && o.y1 >= r.y1) return true;
+    }
+    return false;
+}
+
+static inline int64_t DamageArea(const DamageList& d) {
+    int64_t a = 0;
+    for (int i = 0; i < d.count; i++) a += DamageRectArea(d.rects[i]);
+    return a;
+}
+
+// Copies the damaged regions of `src` over `dst` (same size and stride).
+static inline void DamageRestore(const DamageList& d, uint32_t* dst, const uint32_t* src, int stride) {
+    for (int i = 0; i < d.count; i++) {
+        const DamageRect& r = d.rects[i];
+        size_t bytes = (size_t)(r.x1 - r.x0) * 4;
+        for (int y = r.y0; y < r.y1; y++) {
+            size_t off = (size_t)y * stride + r.x0;
+            memcpy(dst + off, src + off, bytes);
+        }
+    }
+}
@@ -0,0 +1,188 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+#include "raster.h"
+
+// ======================================================
+// Bitmap font: 5x7 ASCII glyphs blitted straight into a Surface
+//
+// FontInit expands the embedded table into an atlas of solid rects per
+// glyph at an integer scale (horizontal runs, merged down identical rows),
+// so drawing a glyph is a handful of RasterFillRect calls. Glyphs are
+// proportional except digits, which keep one width so numbers don't jitter.
+// A TextRun caches the laid-out rects of a whole string.
+// ======================================================
+
+// Printable ASCII 0x20..0x7E, 5 columns per glyph, bit 0 = top row.
+static const uint8_t kFont5x7[95][5] = {
+    {0x00,0x00,0x00,0x00,0x00}, {0x00,0x00,0x5F,0x00,0x00}, {0x00,0x07,0x00,0x07,0x00}, {0x14,0x7F,0x14,0x7F,0x14},
+    {0x24,0x2A,0x7F,0x2A,0x12}, {0x23,0x13,0x08,0x64,0x62}, {0x36,0x49,0x56,0x20,0x50}, {0x00,0x00,0x07,0x00,0x00},
+    {0x00,0x1C,0x22,0x41,0x00}, {0x00,0x41,0x22,0x1C,0x00}, {0x14,0x08,0x3E,0x08,0x14}, {0x08,0x08,0x3E,0x08,0x08},
+    {0x00,0x50,0x30,0x00,0x00}, {0x08,0x08,0x08,0x08,0x08}, {0x00,0x60,0x60,0x00,0x00}, {0x20,0x10,0x08,0x04,0x02},
+    {0x3E,0x51,0x49,0x45,0x3E}, {0x00,0x42,0x7F,0x40,0x00}, {0x42,0x61,0x51,0x49,0x46}, {0x21,0x41,0x45,0x4B,0x31},
+    {0x18,0x14,0x12,0x7F,0x10}, {0x27,0x45,0x45,0x45,0x39}, {0x3C,0x4A,0x49,0x49,0x30}, {0x01,0x71,0x09,0x05,0x03},
+    {0x36,0x49,0x49,0x49,0x36}, {0x06,0x49,0x49,0x29,0x1E}, {0x00,0x36,0x36,0x00,0x00}, {0x00,0x56,0x36,0x00,0x00},
+    {0x08,0x14,0x22,0x41,0x00}, {0x14,0x14,0x14,0x14,0x14}, {0x00,0x41,0x22,0x14,0x08}, {0x02,0x01,0x51,0x09,0x06},
+    {0x32,0x49,0x79,0x41,0x3E}, {0x7E,0x11,0x11,0x11,0x7E}, {0x7F,0x49,0x49,0x49,0x36}, {0x3E,0x41,0x41,0x41,0x22},
+    {0x7F,0x41,0x41,0x22,0x1C}, {0x7F,0x49,0x49,0x49,0x41}, {0x7F,0x09,0x09,0x09,0x01}, {0x3E,0x41,0x49,0x49,0x7A},
+    {0x7F,0x08,0x08,0x08,0x7F}, {0x00,0x41,0x7F,0x41,0x00}, {0x20,0x40,0x41,0x3F,0x01}, {0x7F,0x08,0x14,0x22,0x41},
+    {0x7F,0x40,0x40,0x40,0x40}, {0x7F,0x02,0x0C,0x02,0x7F}, {0x7F,0x04,0x08,0x10,0x7F}, {0x3E,0x41,0x41,0x41,0x3E},
+    {0x7F,0x09,0x09,0x09,0x06}, {0x3E,0x41,0x51,0x21,0x5E}, {0x7F,0x09,0x19,0x29,0x46}, {0x46,0x49,0x49,0x49,0x31},
+    {0x01,0x01,0x7F,0x01,0x01}, {0x3F,0x40,0x40,0x40,0x3F}, {0x1F,0x20,0x40,0x20,0x1F}, {0x3F,0x40,0x38,0x40,0x3F},
+    {0x63,0x14,0x08,0x14,0x63}, {0x07,0x08,0x70,0x08,0x07}, {0x61,0x51,0x49,0x45,0x43}, {0x00,0x7F,0x41,0x41,0x00},
+    {0x02,0x04,0x08,0x10,0x20}, {0x00,0x41,0x41,0x7F,0x00}, {0x04,0x02,0x01,0x02,0x04}, {0x40,0x40,0x40,0x40,0x40},
+    {0x00,0x01,0x02,0x04,0x00}, {0x20,0x54,0x54,0x54,0x78}, {0x7F,0x48,0x44,0x44,0x38}, {0x38,0x44,0x44,0x44,0x20},
+    {0x38,0x44,0x44,0x48,0x7F}, {0x38,0x54,0x54,0x54,0x18}, {0x08,0x7E,0x09,0x01,0x02}, {0x0C,0x52,0x52,0x52,0x3E},
+    {0x7F,0x08,0x04,0x04,0x78}, {0x00,0x44,0x7D,0x40,0x00}, {0x20,0x40,0x44,0x3D,0x00}, {0x7F,0x10,0x28,0x44,0x00},
+    {0x00,0x41,0x7F,0x40,0x00}, {0x7C,0x04,0x18,0x04,0x78}, {0x7C,0x08,0x04,0x04,0x78}, {0x38,0x44,0x44,0x44,0x38},
+    {0x7C,0x14,0x14,0x14,0x08}, {0x08,0x14,0x14,0x18,0x7C}, {0x7C,0x08,0x04,0x04,0x08}, {0x48,0x54,0x54,0x54,0x20},
+    {0x04,0x3F,0x44,0x40,0x20}, {0x3C,0x40,0x40,0x20,0x7C}, {0x1C,0x20,0x40,0x20,0x1C}, {0x3C,0x40,0x30,0x40,0x3C},
+    {0x44,0x28,0x10,0x28,0x44}, {0x0C,0x50,0x50,0x50,0x3C}, {0x44,0x64,0x54,0x4C,0x44}, {0x00,0x08,0x36,0x41,0x00},
+    {0x00,0x00,0x7F,0x00,0x00}, {0x00,0x41,0x36,0x08,0x00}, {0x08,0x04,0x08,0x10,0x08},
+};
+
+enum {
+    kFontFirst = 0x20,
+    kFontGlyphs = 95,
+    kFontCellH = 8,          // 7 rows + 1 of descent/leading
+    kFontMaxRects = 1536,    // atlas rects for all glyphs (plenty)
+    kTextRunMaxText = 128,
+    kTextRunMaxRects = 1024,
+};
+
+struct FontRect {
+    int16_t x0, y0, x1, y1;
+};
+
+struct FontGlyph {
+    uint16_t first, count;   // rects in Font::rects
+    uint8_t advance;         // pixels, including spacing
+};
+
+struct Font {
+    int scale;
+    int lineH;
+    FontGlyph glyphs[kFontGlyphs];
+    FontRect rects[kFontMaxRects];
+    int rectCount;
+};
+
+// Builds the atlas at `scale` (>= 1) pixels per font dot.
+static inline void FontInit(Font& f, int scale) {
+    if (scale < 1) scale = 1;
+    f.scale = scale;
+    f.lineH = kFontCellH * scale;
+    f.rectCount = 0;
+    for (int g = 0; g < kFontGlyphs; g++) {
+        const uint8_t* cols = kFont5x7[g];
+        int c0 = 0, c1 = 4;
+        bool digit = (g + kFontFirst >= '0' && g + kFontFirst <= '9');
+        if (!digit) {
+            while (c0 <= 4 && !cols[c0]) c0++;
+            while (c1 >= c0 && !cols[c1]) c1--;
+        }
+        FontGlyph& glyph = f.glyphs[g];
+        glyph.first = (uint16_t)f.rectCount;
+        glyph.count = 0;
+        if (c0 > c1) {               // blank (space)
+            glyph.advance = (uint8_t)(3 * scale);
+            continue;
+        }
+        glyph.advance = (uint8_t)((c1 - c0 + 2) * scale);
+
+        // One rect per horizontal run; a run identical to one in the row
+        // above extends that rect down instead.
+        for (int row = 0; row < 7; row++) {
+            for (int c = c0; c <= c1;) {
+                if (!((cols[c] >> row) & 1)) { c++; continue; }
+                int run = c;
+                while (c <= c1 && ((cols[c] >> row) & 1)) c++;
+                int16_t x0 = (int16_t)((run - c0) * scale), x1 = (int16_t)((c - c0) * scale);
+                int16_t y0 = (int16_t)(row * scale), y1 = (int16_t)((row + 1) * scale);
+                bool merged = false;
+                for (int i = glyph.first; i < f.rectCount; i++) {
+                    FontRect& r = f.rects[i];
+                    if (r.x0 == x0 && r.x1 == x1 && r.y1 == y0) { r.y1 = y1; merged = true; break; }
+                }
+                if (!merged && f.rectCount < kFontMaxRects) {
+                    f.rects[f.rectCount++] = FontRect{ x0, y0, x1, y1 };
+                    glyph.count++;
+                }
+            }
+        }
+    }
+}
+
+static inline const FontGlyph& FontGlyphFor(const Font& f, char ch) {
+    int g = (unsigned char)ch - kFontFirst;
+    if (g < 0 || g >= kFontGlyphs) g = '?' - kFontFirst;
+    return f.glyphs[g];
+}
+
+// Width of the string's ink box (no trailing spacing); height is one line.
+static inline int FontMeasure(const Font& f, const char* text) {
+    int w = 0;
+    for (const char* p = text; *p; p++) w += FontGlyphFor(f, *p).advance;
+    return w > 0 ? w - f.scale : 0;
+}
+
+static inline void FontDraw(const Surface& s, const Font& f, int x, int y, const char* text, uint32_t color) {
+    for (const char* p = text; *p; p++) {
+        const FontGlyph& g = FontGlyphFor(f, *p);
+        for (int i = 0; i < g.count; i++) {
+            const FontRect& r = f.rects[g.first + i];
+            RasterFillRect(s, x + r.x0, y + r.y0, x + r.x1, y + r.y1, color);
+        }
+        x += g.advance;
+    }
+}
+
+// ======================================================
+// TextRun: a string laid out once, redrawn from its rect list
+// ======================================================
+struct TextRun {
+    const Font* font;
+    char text[kTextRunMaxText];
+    int w, h;
+    int count;
+    FontRect rects[kTextRunMaxRects];
+};
+
+// Lays out `text` unless the run already holds it. Returns true if it
+// changed.
+static inline bool TextRunSet(TextRun& run, const Font& f, const char* text) {
+    if (run.font == &f && strncmp(run.text, text, kTextRunMaxText - 1) == 0) return false;
+    run.font = &f;
+    strncpy(run.text, text, kTextRunMaxText - 1);
+    run.text[kTextRunMaxText - 1] = 0;
+    run.count = 0;
+    int x = 0;
+    for (const char* p = run.text; *p; p++) {
+        const FontGlyph& g = FontGlyphFor(f, *p);
+        for (int i = 0; i < g.count && run.count < kTextRunMaxRects; i++) {
+            FontRect r = f.rects[g.first + i];
+            r.x0 = (int16_t)(r.x0 + x);
+            r.x1 = (int16_t)(r.x1 + x);
+            run.rects[run.count++] = r;
+        }
+        x += g.advance;
+    }
+    run.w = x > 0 ? x - f.scale : 0;
+    run.h = f.lineH;
+    return true;
+}
+
+static inline void TextRunDraw(const Surface& s, const TextRun& run, int x, int y, uint32_t color) {
+    for (int i = 0; i < run.count; i++) {
+        const FontRect& r = run.rects[i];
+        RasterFillRect(s, x + r.x0, y + r.y0, x + r.x1, y + r.y1, color);
+    }
+}
+
+// Run with a drop shadow offset by (dx, dy) underneath it.
+static inline void TextRunDrawShadow(const Surface& s, const TextRun& run, int x, int y, uint32_t color,
+                                     uint32_t shadow, int dx, int dy) {
+    TextRunDraw(s, run, x + dx, y + dy, shadow);
+    TextRunDraw(s, run, x, y, color);
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// ======================================================
+// FNV-1a (64-bit) for state hashes
+//
+// Cores hash their state field by field (never whole structs, whose padding
+// is undefined) so a hash means the same thing on every compiler.
+// ======================================================
+
+static const uint64_t kHashSeed = 14695981039346656037ull;
+
+static inline uint64_t HashBytes(uint64_t h, const void* data, size_t n) {
+    const uint8_t* p = (const uint8_t*)data;
+    for (size_t i = 0; i < n; i++) h = (h ^ p[i]) * 1099511628211ull;
+    return h;
+}
+
+static inline uint64_t HashU32(uint64_t h, uint32_t v) {
+    uint8_t b[4] = { (uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16), (uint8_t)(v >> 24) };
+    return HashBytes(h, b, 4);
+}
+
+static inline uint64_t HashI32(uint64_t h, int32_t v) {
+    return HashU32(h, (uint32_t)v);
+}
+
+// Floats are hashed by bit pattern; -0 and +0 differ, which is what a
+// determinism check wants.
+static inline uint64_t HashF32(uint64_t h, float v) {
+    uint32_t bits;
+    memcpy(&bits, &v, 4);
+    return HashU32(h, bits);
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+
+#include "spsc_queue.h"
+
+// ======================================================
+// Timestamped key events, consumed at their time inside the fixed tick
+//
+// The window procedure pushes every key change with a high-resolution
+// timestamp (any monotonic clock; the games use QPC counts). Each tick
+// takes the events that happened before its end, so a press and release
+// inside one frame still counts as a press, and the tick learns how far
+// into its span the first press landed (`at`, in 128ths) and where a key
+// pressed in it was last released (`until`), so it can split its
+// integration there. What a tick sees no longer depends on when frames
+// happened to pump messages, only on when keys went down.
+//
+//   window thread: InputPush(q, now, key, down);
+//   sim thread:    InputTick t = InputTake(q, tickStart, tickEnd, now);
+// ======================================================
+
+enum {
+    kInputQueue = 128,      // pending key changes
+    kInputAtSteps = 128,    // resolution of InputTick::at within a tick
+};
+
+struct InputEvent {
+    int64_t time;           // caller's clock
+    uint16_t key;           // one game key bit
+    uint16_t down;          // 1 = pressed, 0 = released
+};
+
+struct InputTick {
+    uint16_t down;          // keys held at the end of the span
+    uint16_t pressed;       // keys that went down during it (auto-repeat ignored)
+    uint8_t at;             // first press at at/128 of the span; 0 = at its start
+    uint8_t until;          // last release of a key pressed in the span, at until/128; 0 = none
+};
+
+// Event-to-tick latency: from a key change until the tick that applied it
+// ran. Written by the consumer, read by whoever shows it.
+struct InputLatency {
+    std::atomic<uint32_t> count, maxUs;
+    std::atomic<uint64_t> sumUs;
+};
+
+struct InputQueue {
+    SpscQueue<InputEvent, kInputQueue> events;
+    int64_t freq;           // clock ticks per second
+    uint16_t down;          // consumer's view of held keys
+    uint32_t dropped;       // changes refused by a full queue (producer)
+    InputLatency latency;
+};
+
+static inline void InputInit(InputQueue& q, int64_t freq) {
+    SpscInit(q.events);
+    q.freq = freq > 0 ? freq : 1;
+    q.down = 0;
+    q.dropped = 0;
+    q.latency.count.store(0);
+    q.latency.maxUs.store(0);
+    q.latency.sumUs.store(0);
+}
+
+// ---- Producer ----
+static inline bool InputPush(InputQueue& q, int64_t time, uint16_t key, bool down) {
+    InputEvent e;
+    e.time = time;
+    e.key = key;
+    e.down = down ? 1 : 0;
+    if (SpscPush(q.events, e)) return true;
+    q.dropped++;
+    return false;
+}
+
+// ---- Consumer ----
+// Applies every event stamped before `end`; later ones stay queued for the
+// next span. Events older than `start` (a stall, or the first tick) count
+// as happening at the start. `now` only feeds the latency figures.
+static inline InputTick InputTake(InputQueue& q, int64_t start, int64_t end, int64_t now) {
+    InputTick t;
+    t.pressed = 0;
+    t.at = 0;
+    t.until = 0;
+    InputEvent e;
+    while (SpscPeek(q.events, e) && e.time < end) {
+        SpscPop(q.events, e);
+        uint8_t step = 0;
+        if (end > start && e.time > start) {
+            int64_t at = (e.time - start) * kInputAtSteps / (end - start);
+            step = (uint8_t)(at < kInputAtSteps - 1 ? at : kInputAtSteps - 1);
+        }
+        if (e.down) {
+            if (!(q.down & e.key)) {
+                if (!t.pressed) t.at = step;
+                t.pressed |= e.key;
+            }
+            q.down |= e.key;
+        } else {
+            if (t.pressed & e.key) t.until = step;
+            q.down &= (uint16_t)~e.key;
+        }
+
+        int64_t lag = now - e.time;
+        uint32_t us = lag > 0 ? (uint32_t)(lag * 1000000 / q.freq) : 0;
+        q.latency.sumUs.fetch_add(us, std::memory_order_relaxed);
+        if (us > q.latency.maxUs.load(std::memory_order_relaxed)) q.latency.maxUs.store(us, std::memory_order_relaxed);
+        q.latency.count.fetch_add(1, std::memory_order_relaxed);
+    }
+    t.down = q.down;
+    return t;
+}
+
+// Whether changes are queued that no tick has taken yet.
+static inline bool InputPending(InputQueue& q) {
+    InputEvent e;
+    return SpscPeek(q.events, e);
+}
+
+// Average and worst latency since the last call, in milliseconds; false if
+// no event was applied in between.
+static inline bool InputTakeLatency(InputQueue& q, double* avgMs, double* maxMs) {
+    uint32_t n = q.latency.count.exchange(0, std::memory_order_relaxed);
+    uint64_t sum = q.latency.sumUs.exchange(0, std::memory_order_relaxed);
+    uint32_t worst = q.latency.maxUs.exchange(0, std::memory_order_relaxed);
+    if (!n) return false;
+    *avgMs = (double)sum / n * 1e-3;
+    *maxMs = worst * 1e-3;
+    return true;
+}
@@ -0,0 +1,331 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "raster.h"
+#include "simd.h"
+
+// ======================================================
+// Fixed-capacity particle pool for visual effects
+//
+// Particles live in structure-of-arrays form in one aligned block
+// allocated by ParticleInit, so a frame never touches the heap: bursts
+// append at the end, dead particles are swap-removed, and a full pool
+// refuses new ones. Integration and shading run 4 (SSE2) or 8 (AVX2)
+// particles at a time with the same float operations as the scalar code;
+// the pixel writes that follow are a scatter and stay scalar.
+//
+// Drawing adds each particle's colour, scaled by the life it has left,
+// into the surface with per-channel saturation. Saturating adds commute,
+// so the picture does not depend on particle order.
+//
+//   ParticleEmit(pool, burst);      // any number per frame
+//   ParticleUpdate(pool, dt);       // once per frame
+//   ParticleDraw(pool, surface, size);
+// ======================================================
+
+struct ParticlePool {
+    float* x;
+    float* y;
+    float* vx;
+    float* vy;
+    float* life;        // seconds left; the particle dies at 0
+    float* fade;        // 1 / lifetime: brightness is life * fade
+    uint32_t* color;    // 0x00RRGGBB at full brightness
+    int32_t* offset;    // draw scratch: top-left pixel, -1 = off the surface
+    uint32_t* shade;    // draw scratch: colour at this frame's brightness
+    int count, capacity;
+    uint32_t dropped;   // particles refused by a full pool
+    uint32_t rng;
+    float gravity;      // px/s^2, +y is down
+    float keep;         // fraction of velocity left after one second
+};
+
+// A cone of `count` particles from (x, y), heading `angle` radians
+// (0 = +x, pi/2 = +y) give or take `spread`.
+struct ParticleBurst {
+    float x, y;
+    float angle, spread;
+    float speedMin, speedMax;   // px/s
+    float lifeMin, lifeMax;     // s
+    uint32_t color;
+    int count;
+};
+
+typedef void (*ParticleIntegrateFn)(ParticlePool& p, int n, float dt, float damp, float gdt);
+typedef void (*ParticleShadeFn)(ParticlePool& p, int n, int w, int h, int stride, int size);
+
+struct ParticleKernels {
+    NgSimdLevel level;
+    ParticleIntegrateFn integrate;  // position, velocity and life over dt
+    ParticleShadeFn shade;          // pixel offset and scaled colour per particle
+};
+
+// ---- Scalar kernels ----
+static inline void ParticleIntegrateScalar(ParticlePool& p, int n, float dt, float damp, float gdt) {
+    for (int i = 0; i < n; i++) {
+        p.x[i] = p.x[i] + p.vx[i] * dt;
+        p.y[i] = p.y[i] + p.vy[i] * dt;
+        p.vx[i] = p.vx[i] * damp;
+        p.vy[i] = p.vy[i] * damp + gdt;
+        p.life[i] = p.life[i] - dt;
+    }
+}
+
+// Brightness in 256ths, applied per channel as (c * b) >> 8.
+static inline void ParticleShadeScalar(ParticlePool& p, int n, int w, int h, int stride, int size) {
+    const float xMax = (float)(w - size + 1), yMax = (float)(h - size + 1);
+    for (int i = 0; i < n; i++) {
+        const float x = p.x[i], y = p.y[i];
+        p.offset[i] = (x >= 0.0f && x < xMax && y >= 0.0f && y < yMax) ? (int)y * stride + (int)x : -1;
+        float b = p.life[i] * p.fade[i];
+        b = b > 0.0f ? b : 0.0f;
+        b = b < 1.0f ? b : 1.0f;
+        const uint32_t s = (uint32_t)(int)(b * 256.0f), c = p.color[i];
+        p.shade[i] = (((c & 0xFF) * s) >> 8) | ((((c >> 8) & 0xFF) * s) >> 8) << 8 | ((((c >> 16) & 0xFF) * s) >> 8) << 16;
+    }
+}
+
+#if defined(NG_HAVE_SSE2)
+// Scales 4 colours by 4 brightnesses (0..256) per channel.
+static inline __m128i ParticleScaleSSE2(__m128i color, __m128i s) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i s16 = _mm_packs_epi32(s, s);
+    s16 = _mm_unpacklo_epi16(s16, s16);
+    __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(color, zero), _mm_unpacklo_epi32(s16, s16));
+    __m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(color, zero), _mm_unpackhi_epi32(s16, s16));
+    return _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8));
+}
+
+static inline void ParticleIntegrateSSE2(ParticlePool& p, int n, float dt, float damp, float gdt) {
+    const __m128 vdt = _mm_set1_ps(dt), vdamp = _mm_set1_ps(damp), vg = _mm_set1_ps(gdt);
+    for (int i = 0; i < n; i += 4) {
+        const __m128 vx = _mm_load_ps(p.vx + i), vy = _mm_load_ps(p.vy + i);
+        _mm_store_ps(p.x + i, _mm_add_ps(_mm_load_ps(p.x + i), _mm_mul_ps(vx, vdt)));
+        _mm_store_ps(p.y + i, _mm_add_ps(_mm_load_ps(p.y + i), _mm_mul_ps(vy, vdt)));
+        _mm_store_ps(p.vx + i, _mm_mul_ps(vx, vdamp));
+        _mm_store_ps(p.vy + i, _mm_add_ps(_mm_mul_ps(vy, vdamp), vg));
+        _mm_store_ps(p.life + i, _mm_sub_ps(_mm_load_ps(p.life + i), vdt));
+    }
+}
+
+static inline void ParticleShadeSSE2(ParticlePool& p, int n, int w, int h, int stride, int size) {
+    const __m128 xMax = _mm_set1_ps((float)(w - size + 1)), yMax = _mm_set1_ps((float)(h - size + 1));
+    const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), k256 = _mm_set1_ps(256.0f);
+    const __m128i vstride = _mm_set1_epi32(stride);
+    for (int i = 0; i < n; i += 4) {
+        const __m128 x = _mm_load_ps(p.x + i), y = _mm_load_ps(p.y + i);
+        const __m128 in = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(x, zero), _mm_cmplt_ps(x, xMax)),
+                                     _mm_and_ps(_mm_cmpge_ps(y, zero), _mm_cmplt_ps(y, yMax)));
+        // y * stride: SSE2 has no 32-bit mullo, so multiply even and odd lanes.
+        const __m128i yi = _mm_cvttps_epi32(y);
+        const __m128i even = _mm_mul_epu32(yi, vstride);
+        const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(yi, 32), vstride);
+        const __m128i row = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, 0x08), _mm_shuffle_epi32(odd, 0x08));
+        const __m128i off = _mm_add_epi32(row, _mm_cvttps_epi32(x));
+        const __m128i mask = _mm_castps_si128(in);
+        _mm_store_si128((__m128i*)(p.offset + i), _mm_or_si128(_mm_and_si128(mask, off), _mm_andnot_si128(mask, _mm_set1_epi32(-1))));
+
+        __m128 b = _mm_mul_ps(_mm_load_ps(p.life + i), _mm_load_ps(p.fade + i));
+        b = _mm_min_ps(_mm_max_ps(b, zero), one);
+        const __m128i s = _mm_cvttps_epi32(_mm_mul_ps(b, k256));
+        _mm_store_si128((__m128i*)(p.shade + i), ParticleScaleSSE2(_mm_load_si128((const __m128i*)(p.color + i)), s));
+    }
+}
+#endif
+
+#if defined(NG_HAVE_AVX2)
+NG_TARGET_AVX2 static inline void ParticleIntegrateAVX2(ParticlePool& p, int n, float dt, float damp, float gdt) {
+    const __m256 vdt = _mm256_set1_ps(dt), vdamp = _mm256_set1_ps(damp), vg = _mm256_set1_ps(gdt);
+    for (int i = 0; i < n; i += 8) {
+        const __m256 vx = _mm256_load_ps(p.vx + i), vy = _mm256_load_ps(p.vy + i);
+        _mm256_store_ps(p.x + i, _mm256_add_ps(_mm256_load_ps(p.x + i), _mm256_mul_ps(vx, vdt)));
+        _mm256_store_ps(p.y + i, _mm256_add_ps(_mm256_load_ps(p.y + i), _mm256_mul_ps(vy, vdt)));
+        _mm256_store_ps(p.vx + i, _mm256_mul_ps(vx, vdamp));
+        _mm256_store_ps(p.vy + i, _mm256_add_ps(_mm256_mul_ps(vy, vdamp), vg));
+        _mm256_store_ps(p.life + i, _mm256_sub_ps(_mm256_load_ps(p.life + i), vdt));
+    }
+}
+
+NG_TARGET_AVX2 static inline void ParticleShadeAVX2(ParticlePool& p, int n, int w, int h, int stride, int size) {
+    const __m256 xMax = _mm256_set1_ps((float)(w - size + 1)), yMax = _mm256_set1_ps((float)(h - size + 1));
+    const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f), k256 = _mm256_set1_ps(256.0f);
+    const __m256i vstride = _mm256_set1_epi32(stride), zi = _mm256_setzero_si256();
+    for (int i = 0; i < n; i += 8) {
+        const __m256 x = _mm256_load_ps(p.x + i), y = _mm256_load_ps(p.y + i);
+        const __m256 in = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(x, zero, _CMP_GE_OQ), _mm256_cmp_ps(x, xMax, _CMP_LT_OQ)),
+                                        _mm256_and_ps(_mm256_cmp_ps(y, zero, _CMP_GE_OQ), _mm256_cmp_ps(y, yMax, _CMP_LT_OQ)));
+        const __m256i off = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_cvttps_epi32(y), vstride), _mm256_cvttps_epi32(x));
+        _mm256_store_si256((__m256i*)(p.offset + i), _mm256_blendv_epi8(_mm256_set1_epi32(-1), off, _mm256_castps_si256(in)));
+
+        __m256 b = _mm256_mul_ps(_mm256_load_ps(p.life + i), _mm256_load_ps(p.fade + i));
+        b = _mm256_min_ps(_mm256_max_ps(b, zero), one);
+        const __m256i s = _mm256_cvttps_epi32(_mm256_mul_ps(b, k256));
+        // Lane-wise unpacks keep colours 0-3 with scales 0-3 and 4-7 with 4-7.
+        __m256i s16 = _mm256_packs_epi32(s, s);
+        s16 = _mm256_unpacklo_epi16(s16, s16);
+        const __m256i c = _mm256_load_si256((const __m256i*)(p.color + i));
+        __m256i lo = _mm256_mullo_epi16(_mm256_unpacklo_epi8(c, zi), _mm256_unpacklo_epi32(s16, s16));
+        __m256i hi = _mm256_mullo_epi16(_mm256_unpackhi_epi8(c, zi), _mm256_unpackhi_epi32(s16, s16));
+        _mm256_store_si256((__m256i*)(p.shade + i), _mm256_packus_epi16(_mm256_srli_epi16(lo, 8), _mm256_srli_epi16(hi, 8)));
+    }
+}
+#endif
+
+static inline ParticleKernels ParticlePickKernels(NgSimdLevel level) {
+    ParticleKernels k = { NG_SIMD_SCALAR, ParticleIntegrateScalar, ParticleShadeScalar };
+#if defined(NG_HAVE_SSE2)
+    if (level >= NG_SIMD_SSE2) { k.level = NG_SIMD_SSE2; k.integrate = ParticleIntegrateSSE2; k.shade = ParticleShadeSSE2; }
+#endif
+#if defined(NG_HAVE_AVX2)
+    if (level >= NG_SIMD_AVX2) { k.level = NG_SIMD_AVX2; k.integrate = ParticleIntegrateAVX2; k.shade = ParticleShadeAVX2; }
+#endif
+    (void)level;
+    return k;
+}
+
+// Kernels used by the pool functions; tools may overwrite this to compare tiers.
+static ParticleKernels g_particleKernels = ParticlePickKernels(NgDetectSimd());
+
+// ---- Pool ----
+// Capacity is rounded up to a multiple of 8 so kernels never need a tail.
+static inline bool ParticleInit(ParticlePool& p, int capacity, float gravity, float keep) {
+    memset(&p, 0, sizeof(p));
+    capacity = (capacity + 7) & ~7;
+    const size_t n = (size_t)capacity;
+    char* block = (char*)NgAlignedAlloc(n * 4 * 9, 32);
+    if (!block) return false;
+    memset(block, 0, n * 4 * 9);
+    p.x = (float*)block;
+    p.y = p.x + n;
+    p.vx = p.y + n;
+    p.vy = p.vx + n;
+    p.life = p.vy + n;
+    p.fade = p.life + n;
+    p.color = (uint32_t*)(p.fade + n);
+    p.offset = (int32_t*)(p.color + n);
+    p.shade = (uint32_t*)(p.offset + n);
+    p.capacity = capacity;
+    p.rng = 0x9E3779B9u;
+    p.gravity = gravity;
+    p.keep = keep;
+    return true;
+}
+
+static inline void ParticleFree(ParticlePool& p) {
+    NgAlignedFree(p.x);
+    memset(&p, 0, sizeof(p));
+}
+
+static inline void ParticleClear(ParticlePool& p) {
+    p.count = 0;
+}
+
+// Uniform in [lo, hi).
+static inline float ParticleRand(ParticlePool& p, float lo, float hi) {
+    p.rng ^= p.rng << 13;
+    p.rng ^= p.rng >> 17;
+    p.rng ^= p.rng << 5;
+    return lo + (hi - lo) * (float)(p.rng >> 8) * (1.0f / 16777216.0f);
+}
+
+static inline bool ParticleSpawn(ParticlePool& p, float x, float y, float vx, float vy, float lifetime, uint32_t color) {
+    if (p.count >= p.capacity || !(lifetime > 0.0f)) {
+        p.dropped++;
+        return false;
+    }
+    const int i = p.count++;
+    p.x[i] = x;
+    p.y[i] = y;
+    p.vx[i] = vx;
+    p.vy[i] = vy;
+    p.life[i] = lifetime;
+    p.fade[i] = 1.0f / lifetime;
+    p.color[i] = color;
+    return true;
+}
+
+static inline void ParticleEmit(ParticlePool& p, const ParticleBurst& b) {
+    for (int i = 0; i < b.count; i++) {
+        const float a = b.angle + ParticleRand(p, -b.spread, b.spread);
+        const float v = ParticleRand(p, b.speedMin, b.speedMax);
+        if (!ParticleSpawn(p, b.x, b.y, cosf(a) * v, sinf(a) * v, ParticleRand(p, b.lifeMin, b.lifeMax), b.color)) return;
+    }
+}
+
+// Moves every particle on by dt and swap-removes the ones that died.
+static inline void ParticleUpdate(ParticlePool& p, float dt) {
+    if (p.count == 0 || !(dt > 0.0f)) return;
+    const float damp = powf(p.keep, dt);
+    g_particleKernels.integrate(p, (p.count + 7) & ~7, dt, damp, p.gravity * dt);
+    for (int i = 0; i < p.count;) {
+        if (p.life[i] > 0.0f) { i++; continue; }
+        const int last = --p.count;
+        p.x[i] = p.x[last];
+        p.y[i] = p.y[last];
+        p.vx[i] = p.vx[last];
+        p.vy[i] = p.vy[last];
+        p.life[i] = p.life[last];
+        p.fade[i] = p.fade[last];
+        p.color[i] = p.color[last];
+    }
+}
+
+// Pixels the live particles cover when drawn `size` px square, as
+// [x0, x1) x [y0, y1); false if there are none.
+static inline bool ParticleBounds(const ParticlePool& p, int size, int* x0, int* y0, int* x1, int* y1) {
+    if (p.count == 0) return false;
+    float minX = p.x[0], maxX = p.x[0], minY = p.y[0], maxY = p.y[0];
+    for (int i = 1; i < p.count; i++) {
+        minX = p.x[i] < minX ? p.x[i] : minX;
+        maxX = p.x[i] > maxX ? p.x[i] : maxX;
+        minY = p.y[i] < minY ? p.y[i] : minY;
+        maxY = p.y[i] > maxY ? p.y[i] : maxY;
+    }
+    *x0 = (int)floorf(minX);
+    *y0 = (int)floorf(minY);
+    *x1 = (int)floorf(maxX) + size;
+    *y1 = (int)floorf(maxY) + size;
+    return true;
+}
+
+// Per-channel saturating add of two 0x00RRGGBB words.
+static inline uint32_t ParticleAddSat(uint32_t a, uint32_t b) {
+    const uint32_t sum = ((a & 0x7F7F7F7F) + (b & 0x7F7F7F7F)) ^ ((a ^ b) & 0x80808080);
+    const uint32_t carry = ((a & b) | ((a | b) & ~sum)) & 0x80808080;
+    return sum | ((carry >> 7) * 0xFF);
+}
+
+// How many particles ahead ParticleDraw prefetches pixels.
+static const int kParticlePrefetch = 16;
+
+// Works out where and how bright every particle lands on `s`; false if
+// nothing will. ParticleDraw does this itself; a tiled draw (tiles.h)
+// records the shaded particles as rects to add.
+static inline bool ParticleShade(ParticlePool& p, const Surface& s, int size) {
+    if (p.count == 0 || size < 1 || s.w < size || s.h < size) return false;
+    g_particleKernels.shade(p, (p.count + 7) & ~7, s.w, s.h, s.stride, size);
+    return true;
+}
+
+// Adds every live particle into the surface as a `size` px square; ones
+// not wholly on the surface are skipped.
+static inline void ParticleDraw(ParticlePool& p, const Surface& s, int size) {
+    if (!ParticleShade(p, s, size)) return;
+    for (int i = 0; i < p.count; i++) {
+#if defined(NG_HAVE_SSE2)
+        // Particles land anywhere in the frame, so most writes miss the
+        // cache; the offsets are known up front, so ask for lines early.
+        const int32_t ahead = i + kParticlePrefetch < p.count ? p.offset[i + kParticlePrefetch] : -1;
+        if (ahead >= 0) _mm_prefetch((const char*)(s.pixels + ahead), _MM_HINT_T0);
+#endif
+        const int32_t off = p.offset[i];
+        if (off < 0) continue;
+        const uint32_t c = p.shade[i];
+        uint32_t* px = s.pixels + off;
+        for (int y = 0; y < size; y++, px += s.stride) {
+            for (int x = 0; x < size; x++) px[x] = ParticleAddSat(px[x], c);
+        }
+    }
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+// ======================================================
+// Frame profiler: per-phase timers, a ring of frame samples, percentiles,
+// CSV export and a two-line overlay.
+//
+// Everything here is compiled only with NG_PROFILE defined; otherwise the
+// NG_PROFILE_* macros expand to nothing and the header adds no code, so
+// release builds stay exactly as small as before.
+//
+//   NG_PROFILE_FRAME();              top of the main loop: closes the last
+//                                    frame and starts a new one
+//   { NG_PROFILE_SCOPE(PROF_RENDER); ... }   time a phase of the frame
+// ======================================================
+
+#if defined(NG_PROFILE)
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+enum ProfPhase {
+    PROF_INPUT,      // message pump / input gathering
+    PROF_UPDATE,     // simulation ticks
+    PROF_RENDER,     // drawing into the backbuffer
+    PROF_PRESENT,    // copying to the window
+    PROF_PHASES
+};
+
+static const char* const kProfPhaseNames[PROF_PHASES] = { "input", "update", "render", "present" };
+
+enum { kProfRingFrames = 4096 }; // power of two
+
+struct ProfFrame {
+    uint64_t startNs;                 // since the profiler's first frame
+    uint32_t frameNs;                 // start to the next frame's start
+    uint32_t phaseNs[PROF_PHASES];
+};
+
+// One writer (the game loop) appends frames. Readers copy the newest frames
+// after an acquire load of `written`; the writer only reuses a slot
+// kProfRingFrames frames later, so a snapshot of recent frames is safe
+// without a lock.
+struct Profiler {
+    ProfFrame ring[kProfRingFrames];
+    std::atomic<uint32_t> written;
+    ProfFrame cur;
+    uint64_t originNs;
+    bool started;
+    bool overlay;
+};
+
+static Profiler g_prof;
+
+static inline uint64_t ProfNowNs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static inline void ProfFrameMark() {
+    uint64_t now = ProfNowNs();
+    if (g_prof.started) {
+        uint64_t span = now - g_prof.originNs - g_prof.cur.startNs;
+        g_prof.cur.frameNs = span > 0xFFFFFFFFu ? 0xFFFFFFFFu : (uint32_t)span;
+        uint32_t n = g_prof.written.load(std::memory_order_relaxed);
+        g_prof.ring[n & (kProfRingFrames - 1)] = g_prof.cur;
+        g_prof.written.store(n + 1, std::memory_order_release);
+    } else {
+        g_prof.originNs = now;
+        g_prof.started = true;
+    }
+    memset(&g_prof.cur, 0, sizeof(g_prof.cur));
+    g_prof.cur.startNs = now - g_prof.originNs;
+}
+
+struct ProfScope {
+    ProfPhase phase;
+    uint64_t t0;
+    explicit ProfScope(ProfPhase p) : phase(p), t0(ProfNowNs()) {}
+    ~ProfScope() { g_prof.cur.phaseNs[phase] += (uint32_t)(ProfNowNs() - t0); }
+};
+
+// Copies up to `max` of the newest frames into out, oldest first.
+static inline int ProfSnapshot(ProfFrame* out, int max) {
+    uint32_t n = g_prof.written.load(std::memory_order_acquire);
+    int count = (int)(n < (uint32_t)max ? n : (uint32_t)max);
+    for (int i = 0; i < count; i++) out[i] = g_prof.ring[(n - (uint32_t)count + (uint32_t)i) & (kProfRingFrames - 1)];
+    return count;
+}
+
+struct ProfStats {
+    int frames;
+    double p50Ms, p99Ms, maxMs;
+    double phaseMs[PROF_PHASES];   // mean per frame
+};
+
+// Frame-time percentiles and mean phase times over the last `window` frames.
+static inline ProfStats ProfComputeStats(int window) {
+    static ProfFrame frames[kProfRingFrames];
+    static uint32_t times[kProfRingFrames];
+    if (window > kProfRingFrames - 64) window = kProfRingFrames - 64;
+    ProfStats st{};
+    st.frames = ProfSnapshot(frames, window);
+    if (st.frames == 0) return st;
+    for (int i = 0; i < st.frames; i++) {
+        times[i] = frames[i].frameNs;
+        for (int p = 0; p < PROF_PHASES; p++) st.phaseMs[p] += frames[i].phaseNs[p] * 1e-6;
+    }
+    for (int p = 0; p < PROF_PHASES; p++) st.phaseMs[p] /= st.frames;
+    std::sort(times, times + st.frames);
+    st.p50Ms = times[(st.frames - 1) / 2] * 1e-6;
+    st.p99Ms = times[(st.frames - 1) * 99 / 100] * 1e-6;
+    st.maxMs = times[st.frames - 1] * 1e-6;
+    return st;
+}
+
+// Overlay text, two lines of at most 63 chars.
+static inline void ProfFormatStats(const ProfStats& st, char* line0, char* line1, int size) {
+    snprintf(line0, size, "frame ms  p50 %.2f  p99 %.2f  max %.2f", st.p50Ms, st.p99Ms, st.maxMs);
+    snprintf(line1, size, "in %.2f  update %.2f  render %.2f  present %.2f",
+             st.phaseMs[PROF_INPUT], st.phaseMs[PROF_UPDATE], st.phaseMs[PROF_RENDER], st.phaseMs[PROF_PRESENT]);
+}
+
+// Every frame still in the ring, one row each, times in milliseconds.
+static inline bool ProfWriteCsv(const char* path) {
+    static ProfFrame frames[kProfRingFrames];
+    int count = ProfSnapshot(frames, kProfRingFrames - 64);
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "start_ms,frame_ms");
+    for (int p = 0; p < PROF_PHASES; p++) fprintf(f, ",%s_ms", kProfPhaseNames[p]);
+    fprintf(f, "\n");
+    for (int i = 0; i < count; i++) {
+        const ProfFrame& fr = frames[i];
+        fprintf(f, "%.4f,%.4f", fr.startNs * 1e-6, fr.frameNs * 1e-6);
+        for (int p = 0; p < PROF_PHASES; p++) fprintf(f, ",%.4f", fr.phaseNs[p] * 1e-6);
+        fprintf(f, "\n");
+    }
+    return fclose(f) == 0;
+}
+
+#define NG_PROFILE_CAT2(a, b) a##b
+#define NG_PROFILE_CAT(a, b) NG_PROFILE_CAT2(a, b)
+#define NG_PROFILE_FRAME() ProfFrameMark()
+#define NG_PROFILE_SCOPE(phase) ProfScope NG_PROFILE_CAT(ngProfScope, __LINE__)(phase)
+
+#else
+
+#define NG_PROFILE_FRAME() ((void)0)
+#define NG_PROFILE_SCOPE(phase) ((void)0)
+
+#endif
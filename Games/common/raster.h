@@ -0,0 +1,164 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+#include "simd.h"
+
+// ======================================================
+// Raster kernels for 32-bit pixel buffers
+//
+// Span fills come in scalar, SSE2 and AVX2 flavours, picked once at runtime.
+// Whole-frame clears larger than the cache use non-temporal stores so they
+// don't evict what the frame is about to draw with.
+// ======================================================
+
+struct Surface {
+    uint32_t* pixels;
+    int w, h;
+    int stride;      // pixels per row
+};
+
+// The part of a surface a draw may write, [x0, x1) x [y0, y1). Clipped
+// variants of the primitives take one so a frame can be drawn a tile at a
+// time (tiles.h); every pixel comes out as the unclipped draw leaves it.
+struct RasterClip {
+    int x0, y0, x1, y1;
+};
+
+typedef void (*RasterSpanFn)(uint32_t* dst, size_t n, uint32_t color);
+
+struct RasterKernels {
+    NgSimdLevel level;
+    RasterSpanFn fill;    // regular stores, stays in cache
+    RasterSpanFn stream;  // non-temporal stores, bypasses cache
+};
+
+// Above this many bytes a clear streams past the cache instead of through
+// it. Anything up to 4K (33 MB) mostly stays in a last-level cache and is
+// read back soon, where regular stores win (raster_bench); 8K doesn't fit,
+// and there streaming is ~2.5x faster.
+static const size_t kRasterStreamBytes = (size_t)64 << 20;
+// Spans shorter than this are cheaper as an inline loop than a kernel call.
+static const size_t kRasterShortSpan = 16;
+
+static inline void RasterFillScalar(uint32_t* dst, size_t n, uint32_t color) {
+    for (size_t i = 0; i < n; i++) dst[i] = color;
+}
+
+#if defined(NG_HAVE_SSE2)
+static inline void RasterFillSSE2(uint32_t* dst, size_t n, uint32_t color) {
+    while (n && ((uintptr_t)dst & 15)) { *dst++ = color; n--; }
+    const __m128i c = _mm_set1_epi32((int)color);
+    for (; n >= 16; n -= 16, dst += 16) {
+        _mm_store_si128((__m128i*)dst + 0, c);
+        _mm_store_si128((__m128i*)dst + 1, c);
+        _mm_store_si128((__m128i*)dst + 2, c);
+        _mm_store_si128((__m128i*)dst + 3, c);
+    }
+    for (; n >= 4; n -= 4, dst += 4) _mm_store_si128((__m128i*)dst, c);
+    while (n--) *dst++ = color;
+}
+
+static inline void RasterStreamSSE2(uint32_t* dst, size_t n, uint32_t color) {
+    while (n && ((uintptr_t)dst & 15)) { *dst++ = color; n--; }
+    const __m128i c = _mm_set1_epi32((int)color);
+    for (; n >= 16; n -= 16, dst += 16) {
+        _mm_stream_si128((__m128i*)dst + 0, c);
+        _mm_stream_si128((__m128i*)dst + 1, c);
+        _mm_stream_si128((__m128i*)dst + 2, c);
+        _mm_stream_si128((__m128i*)dst + 3, c);
+    }
+    for (; n >= 4; n -= 4, dst += 4) _mm_stream_si128((__m128i*)dst, c);
+    while (n--) *dst++ = color;
+    _mm_sfence();
+}
+#endif
+
+#if defined(NG_HAVE_AVX2)
+NG_TARGET_AVX2 static inline void RasterFillAVX2(uint32_t* dst, size_t n, uint32_t color) {
+    const __m256i c = _mm256_set1_epi32((int)color);
+    if (n >= 8) {
+        // One unaligned store covers the head, then continue aligned.
+        _mm256_storeu_si256((__m256i*)dst, c);
+        size_t skip = (32 - ((uintptr_t)dst & 31)) >> 2;
+        dst += skip; n -= skip;
+    }
+    for (; n >= 32; n -= 32, dst += 32) {
+        _mm256_store_si256((__m256i*)dst + 0, c);
+        _mm256_store_si256((__m256i*)dst + 1, c);
+        _mm256_store_si256((__m256i*)dst + 2, c);
+        _mm256_store_si256((__m256i*)dst + 3, c);
+    }
+    for (; n >= 8; n -= 8, dst += 8) _mm256_store_si256((__m256i*)dst, c);
+    while (n--) *dst++ = color;
+}
+
+NG_TARGET_AVX2 static inline void RasterStreamAVX2(uint32_t* dst, size_t n, uint32_t color) {
+    while (n && ((uintptr_t)dst & 31)) { *dst++ = color; n--; }
+    const __m256i c = _mm256_set1_epi32((int)color);
+    for (; n >= 32; n -= 32, dst += 32) {
+        _mm256_stream_si256((__m256i*)dst + 0, c);
+        _mm256_stream_si256((__m256i*)dst + 1, c);
+        _mm256_stream_si256((__m256i*)dst + 2, c);
+        _mm256_stream_si256((__m256i*)dst + 3, c);
+    }
+    for (; n >= 8; n -= 8, dst += 8) _mm256_stream_si256((__m256i*)dst, c);
+    while (n--) *dst++ = color;
+    _mm_sfence();
+}
+#endif
+
+static inline RasterKernels RasterPickKernels(NgSimdLevel level) {
+    RasterKernels k = { NG_SIMD_SCALAR, RasterFillScalar, RasterFillScalar };
+#if defined(NG_HAVE_SSE2)
+    if (level >= NG_SIMD_SSE2) { k.level = NG_SIMD_SSE2; k.fill = RasterFillSSE2; k.stream = RasterStreamSSE2; }
+#endif
+#if defined(NG_HAVE_AVX2)
+    if (level >= NG_SIMD_AVX2) { k.level = NG_SIMD_AVX2; k.fill = RasterFillAVX2; k.stream = RasterStreamAVX2; }
+#endif
+    (void)level;
+    return k;
+}
+
+// Kernels used by the Raster* helpers below. Tools may overwrite this to
+// compare tiers; the games leave it at the detected best.
+static RasterKernels g_raster = RasterPickKernels(NgDetectSimd());
+
+static inline void RasterFillSpan(uint32_t* dst, int n, uint32_t color) {
+    if (n <= 0) return;
+    if ((size_t)n < kRasterShortSpan) {
+        for (int i = 0; i < n; i++) dst[i] = color;
+        return;
+    }
+    g_raster.fill(dst, (size_t)n, color);
+}
+
+static inline void RasterClear(const Surface& s, uint32_t color) {
+    if (s.w <= 0 || s.h <= 0) return;
+    size_t bytes = (size_t)s.stride * (size_t)s.h * 4;
+    RasterSpanFn fn = (bytes >= kRasterStreamBytes) ? g_raster.stream : g_raster.fill;
+    if (s.stride == s.w) {
+        fn(s.pixels, (size_t)s.w * (size_t)s.h, color);
+        return;
+    }
+    for (int y = 0; y < s.h; y++) fn(s.pixels + (size_t)y * s.stride, (size_t)s.w, color);
+}
+
+// Fills [x0, x1) x [y0, y1), clipped to the surface.
+static inline void RasterFillRect(const Surface& s, int x0, int y0, int x1, int y1, uint32_t color) {
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > s.w) x1 = s.w;
+    if (y1 > s.h) y1 = s.h;
+    if (x1 <= x0 || y1 <= y0) return;
+
+    uint32_t* row = s.pixels + (size_t)y0 * s.stride + x0;
+    const int n = x1 - x0;
+    if ((size_t)n < kRasterShortSpan) {
+        for (int y = y0; y < y1; y++, row += s.stride) {
+            for (int x = 0; x < n; x++) row[x] = color;
+        }
+        return;
+    }
+    for (int y = y0; y < y1; y++, row += s.stride) g_raster.fill(row, (size_t)n, color);
+}
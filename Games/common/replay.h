@@ -0,0 +1,209 @@
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ======================================================
+// Input replays: seed + tick rate + per-tick input bits
+//
+// Both cores are deterministic given their start state and one 32-bit
+// input word per fixed tick, so a replay is just those words. File layout
+// (all little-endian):
+//   "NGRP" u32 version, u32 game, u32 seed, u32 tickHz, i32 w, i32 h,
+//   u32 ticks, u64 finalHash, u32 bodyBytes, body
+// The body is a list of runs, each a varint repeat count followed by the
+// varint XOR of the run's input word with the previous run's. Held keys
+// give long runs and a key change flips few bits, so a minute of play
+// takes from under a kilobyte to a few.
+// ======================================================
+
+enum ReplayGame {
+    REPLAY_GAME_PONG = 1,
+    REPLAY_GAME_BIRDUP = 2,
+};
+
+static const uint32_t kReplayMagic = 0x5052474E; // "NGRP"
+static const uint32_t kReplayVersion = 1;
+static const size_t kReplayHeaderBytes = 44;
+
+struct ReplayHeader {
+    uint32_t game;
+    uint32_t seed;
+    uint32_t tickHz;
+    int32_t w, h;
+    uint32_t ticks;
+    uint64_t finalHash;
+};
+
+struct Replay {
+    ReplayHeader hdr;
+    uint8_t* body;
+    size_t size, cap;
+    bool failed;          // out of memory while recording
+
+    // Recording: the run being extended and the word of the run before it
+    uint32_t runValue, runLen, prevValue;
+};
+
+// The step every game passes to its core for a given tick rate; replaying
+// with exactly the same float is part of staying bit-identical.
+static inline float ReplayTickDt(uint32_t tickHz) {
+    return (float)(1.0 / (double)tickHz);
+}
+
+static inline void ReplayFree(Replay& r) {
+    free(r.body);
+    memset(&r, 0, sizeof(r));
+}
+
+static inline void ReplayBegin(Replay& r, uint32_t game, uint32_t seed, uint32_t tickHz, int w, int h) {
+    ReplayFree(r);
+    r.hdr.game = game;
+    r.hdr.seed = seed;
+    r.hdr.tickHz = tickHz;
+    r.hdr.w = w;
+    r.hdr.h = h;
+}
+
+static inline void ReplayPutByte(Replay& r, uint8_t b) {
+    if (r.size == r.cap) {
+        size_t cap = r.cap ? r.cap * 2 : 256;
+        uint8_t* p = (uint8_t*)realloc(r.body, cap);
+        if (!p) { r.failed = true; return; }
+        r.body = p;
+        r.cap = cap;
+    }
+    r.body[r.size++] = b;
+}
+
+static inline void ReplayPutVarint(Replay& r, uint32_t v) {
+    while (v >= 0x80) {
+        ReplayPutByte(r, (uint8_t)(v | 0x80));
+        v >>= 7;
+    }
+    ReplayPutByte(r, (uint8_t)v);
+}
+
+static inline void ReplayFlushRun(Replay& r) {
+    if (!r.runLen) return;
+    ReplayPutVarint(r, r.runLen);
+    ReplayPutVarint(r, r.runValue ^ r.prevValue);
+    r.prevValue = r.runValue;
+    r.runLen = 0;
+}
+
+// Appends one tick's input word.
+static inline void ReplayRecord(Replay& r, uint32_t bits) {
+    if (r.runLen && (bits != r.runValue || r.runLen == 0xFFFFFFFFu)) ReplayFlushRun(r);
+    r.runValue = bits;
+    r.runLen++;
+    r.hdr.ticks++;
+}
+
+// Closes the stream; `hash` is the core's state hash after the last tick.
+static inline void ReplayFinish(Replay& r, uint64_t hash) {
+    ReplayFlushRun(r);
+    r.hdr.finalHash = hash;
+}
+
+static inline void ReplayPutLE(uint8_t* p, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static inline uint64_t ReplayGetLE(const uint8_t* p, int bytes) {
+    uint64_t v = 0;
+    for (int i = 0; i < bytes; i++) v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+
+static inline bool ReplaySave(const Replay& r, const char* path) {
+    if (r.failed) return false;
+    uint8_t h[kReplayHeaderBytes];
+    ReplayPutLE(h + 0, kReplayMagic, 4);
+    ReplayPutLE(h + 4, kReplayVersion, 4);
+    ReplayPutLE(h + 8, r.hdr.game, 4);
+    ReplayPutLE(h + 12, r.hdr.seed, 4);
+    ReplayPutLE(h + 16, r.hdr.tickHz, 4);
+    ReplayPutLE(h + 20, (uint32_t)r.hdr.w, 4);
+    ReplayPutLE(h + 24, (uint32_t)r.hdr.h, 4);
+    ReplayPutLE(h + 28, r.hdr.ticks, 4);
+    ReplayPutLE(h + 32, r.hdr.finalHash, 8);
+    ReplayPutLE(h + 40, (uint32_t)r.size, 4);
+
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    bool ok = fwrite(h, 1, sizeof(h), f) == sizeof(h) &&
+              (r.size == 0 || fwrite(r.body, 1, r.size, f) == r.size);
+    return (fclose(f) == 0) && ok;
+}
+
+static inline bool ReplayLoad(Replay& r, const char* path) {
+    ReplayFree(r);
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    uint8_t h[kReplayHeaderBytes];
+    bool ok = fread(h, 1, sizeof(h), f) == sizeof(h) &&
+              ReplayGetLE(h, 4) == kReplayMagic && ReplayGetLE(h + 4, 4) == kReplayVersion;
+    if (ok) {
+        r.hdr.game = (uint32_t)ReplayGetLE(h + 8, 4);
+        r.hdr.seed = (uint32_t)ReplayGetLE(h + 12, 4);
+        r.hdr.tickHz = (uint32_t)ReplayGetLE(h + 16, 4);
+        r.hdr.w = (int32_t)ReplayGetLE(h + 20, 4);
+        r.hdr.h = (int32_t)ReplayGetLE(h + 24, 4);
+        r.hdr.ticks = (uint32_t)ReplayGetLE(h + 28, 4);
+        r.hdr.finalHash = ReplayGetLE(h + 32, 8);
+        r.size = r.cap = (size_t)ReplayGetLE(h + 40, 4);
+        r.body = (uint8_t*)malloc(r.size ? r.size : 1);
+        ok = r.body && r.hdr.tickHz > 0 && fread(r.body, 1, r.size, f) == r.size;
+    }
+    fclose(f);
+    if (!ok) ReplayFree(r);
+    return ok;
+}
+
+// ======================================================
+// Playback
+// ======================================================
+struct ReplayReader {
+    const uint8_t* p;
+    const uint8_t* end;
+    uint32_t value;   // input word of the current run
+    uint32_t left;    // ticks left in the current run
+    bool bad;         // truncated or malformed body
+};
+
+static inline ReplayReader ReplayRead(const Replay& r) {
+    ReplayReader rd{};
+    rd.p = r.body;
+    rd.end = r.body + r.size;
+    return rd;
+}
+
+static inline bool ReplayGetVarint(ReplayReader& rd, uint32_t* v) {
+    uint32_t x = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (rd.p == rd.end) return false;
+        uint8_t b = *rd.p++;
+        x |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) { *v = x; return true; }
+    }
+    return false;
+}
+
+// Next tick's input word; false once the stream is exhausted.
+static inline bool ReplayNext(ReplayReader& rd, uint32_t* bits) {
+    while (rd.left == 0) {
+        uint32_t len, delta;
+        if (rd.p == rd.end) return false;
+        if (!ReplayGetVarint(rd, &len) || !ReplayGetVarint(rd, &delta)) {
+            rd.bad = true;
+            return false;
+        }
+        rd.value ^= delta;
+        rd.left = len;
+    }
+    rd.left--;
+    *bits = rd.value;
+    return true;
+}
@@ -0,0 +1,331 @@
+#pragma once
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "damage.h"
+#include "raster.h"
+
+// ======================================================
+// Upscaling a fixed-size frame to the window, with letterboxing
+//
+// ScaleFit places the source frame in the window at the largest size
+// that keeps its aspect ratio: a whole multiple for SCALE_INTEGER (crisp,
+// falling back to nearest when the window is smaller than the frame), any
+// size for SCALE_NEAREST and SCALE_BILINEAR. A Scaler holds the per-column
+// and per-row source positions for one layout, so per frame only pixels
+// are touched, and ScalerRun can redo just a damaged part of the output.
+//
+// Integer scaling replicates pixels with SSE2 shuffles and copies repeated
+// rows; bilinear blends in 8-bit fixed point, SSE2 giving the same bits as
+// the scalar path. Nearest gathers through the column table and copies
+// rows that sample the same source row.
+// ======================================================
+
+enum ScaleMode {
+    SCALE_INTEGER = 0,
+    SCALE_NEAREST = 1,
+    SCALE_BILINEAR = 2,
+};
+
+struct ScaleLayout {
+    int srcW, srcH;
+    int dstW, dstH;      // whole output (window) size
+    int x, y, w, h;      // where the frame lands; the rest is bars
+    ScaleMode mode;      // as run (integer may fall back to nearest)
+    int factor;          // SCALE_INTEGER: pixels per source pixel
+};
+
+static inline ScaleLayout ScaleFit(int srcW, int srcH, int dstW, int dstH, ScaleMode mode) {
+    ScaleLayout l;
+    l.srcW = srcW; l.srcH = srcH;
+    l.dstW = dstW; l.dstH = dstH;
+    l.mode = mode;
+    l.factor = 0;
+    if (mode == SCALE_INTEGER) {
+        int kx = dstW / srcW, ky = dstH / srcH;
+        l.factor = kx < ky ? kx : ky;
+        if (l.factor < 1) l.mode = SCALE_NEAREST;
+    }
+    if (l.mode == SCALE_INTEGER) {
+        l.w = srcW * l.factor;
+        l.h = srcH * l.factor;
+    } else if ((int64_t)dstW * srcH <= (int64_t)dstH * srcW) {
+        l.w = dstW;
+        l.h = (int)((int64_t)dstW * srcH / srcW);
+    } else {
+        l.h = dstH;
+        l.w = (int)((int64_t)dstH * srcW / srcH);
+    }
+    if (l.w < 1) l.w = 1;
+    if (l.h < 1) l.h = 1;
+    l.x = (dstW - l.w) / 2;
+    l.y = (dstH - l.h) / 2;
+    return l;
+}
+
+struct Scaler {
+    ScaleLayout layout;
+    int* srcX;          // per output column: source column (left one for bilinear)
+    int* srcY;          // per output row
+    uint8_t* fracX;     // bilinear weights of the right/lower neighbour, 0..255
+    uint8_t* fracY;
+    uint32_t* row;      // bilinear: vertically blended source row
+};
+
+static inline void ScalerFree(Scaler& s) {
+    free(s.srcX); free(s.srcY); free(s.fracX); free(s.fracY);
+    NgAlignedFree(s.row);
+    memset(&s, 0, sizeof(s));
+}
+
+// Source position of output pixel i along one axis. Nearest samples the
+// pixel under the output pixel's centre; bilinear splits the centre
+// between its two neighbours, clamped at the edges.
+static inline void ScaleAxis(int src, int dst, bool bilinear, int* idx, uint8_t* frac) {
+    for (int i = 0; i < dst; i++) {
+        if (!bilinear) {
+            idx[i] = (int)(((int64_t)2 * i + 1) * src / (2 * (int64_t)dst));
+            continue;
+        }
+        // (i + 0.5) * src / dst - 0.5 in 24.8 fixed point
+        int64_t p = (((int64_t)2 * i + 1) * src * 256) / (2 * (int64_t)dst) - 128;
+        if (p < 0) p = 0;
+        int k = (int)(p >> 8);
+        int f = (int)(p & 255);
+        if (k >= src - 1) { k = src - 1; f = 0; }
+        idx[i] = k;
+        frac[i] = (uint8_t)f;
+    }
+}
+
+static inline bool ScalerInit(Scaler& s, const ScaleLayout& l) {
+    ScalerFree(s);
+    s.layout = l;
+    bool bilinear = l.mode == SCALE_BILINEAR;
+    s.srcX = (int*)malloc(sizeof(int) * (size_t)l.w);
+    s.srcY = (int*)malloc(sizeof(int) * (size_t)l.h);
+    s.fracX = (uint8_t*)malloc((size_t)l.w);
+    s.fracY = (uint8_t*)malloc((size_t)l.h);
+    s.row = (uint32_t*)NgAlignedAlloc(sizeof(uint32_t) * ((size_t)l.srcW + 4), 16);
+    if (!s.srcX || !s.srcY || !s.fracX || !s.fracY || !s.row) {
+        ScalerFree(s);
+        return false;
+    }
+    ScaleAxis(l.srcW, l.w, bilinear, s.srcX, s.fracX);
+    ScaleAxis(l.srcH, l.h, bilinear, s.srcY, s.fracY);
+    return true;
+}
+
+// The output pixels that depend on source rect r (window coordinates).
+static inline DamageRect ScaleMapRect(const ScaleLayout& l, DamageRect r) {
+    if (l.mode == SCALE_BILINEAR) { r.x0--; r.y0--; r.x1++; r.y1++; } // neighbours blend in
+    DamageRect o;
+    // Output column i samples source column floor((2i+1) * srcW / 2w), so the
+    // columns sampling [x0, x1) are those with 2i+1 in [2*x0*w/srcW, 2*x1*w/srcW).
+    o.x0 = l.x + (int)(((int64_t)2 * r.x0 * l.w / l.srcW) / 2);
+    o.x1 = l.x + (int)(((int64_t)2 * r.x1 * l.w / l.srcW + 1) / 2) + 1;
+    o.y0 = l.y + (int)(((int64_t)2 * r.y0 * l.h / l.srcH) / 2);
+    o.y1 = l.y + (int)(((int64_t)2 * r.y1 * l.h / l.srcH + 1) / 2) + 1;
+    if (o.x0 < l.x) o.x0 = l.x;
+    if (o.y0 < l.y) o.y0 = l.y;
+    if (o.x1 > l.x + l.w) o.x1 = l.x + l.w;
+    if (o.y1 > l.y + l.h) o.y1 = l.y + l.h;
+    return o;
+}
+
+// Fills the letterbox bars around the frame.
+static inline void ScaleFillBars(const Surface& dst, const ScaleLayout& l, uint32_t color) {
+    RasterFillRect(dst, 0, 0, l.dstW, l.y, color);
+    RasterFillRect(dst, 0, l.y + l.h, l.dstW, l.dstH, color);
+    RasterFillRect(dst, 0, l.y, l.x, l.y + l.h, color);
+    RasterFillRect(dst, l.x + l.w, l.y, l.dstW, l.y + l.h, color);
+}
+
+// ---- Row kernels: output columns [x0, x1) of the frame (frame-relative) ----
+
+static inline void ScaleRowGather(const Scaler& s, const uint32_t* src, uint32_t* dst, int x0, int x1) {
+    for (int x = x0; x < x1; x++) dst[x] = src[s.srcX[x]];
+}
+
+// Integer: source columns [sx0, sx1) each repeated k times from dst[sx0 * k].
+static inline void ScaleRowRepeatScalar(const uint32_t* src, uint32_t* dst, int sx0, int sx1, int k) {
+    uint32_t* d = dst + (size_t)sx0 * k;
+    if (k == 1) {
+        memcpy(d, src + sx0, sizeof(uint32_t) * (size_t)(sx1 - sx0));
+        return;
+    }
+    for (int x = sx0; x < sx1; x++) {
+        for (int i = 0; i < k; i++) *d++ = src[x];
+    }
+}
+
+#if defined(NG_HAVE_SSE2)
+static inline void ScaleRowRepeatSSE2(const uint32_t* src, uint32_t* dst, int sx0, int sx1, int k) {
+    uint32_t* d = dst + (size_t)sx0 * k;
+    int x = sx0;
+    if (k == 2) {
+        for (; x + 4 <= sx1; x += 4, d += 8) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(src + x));
+            _mm_storeu_si128((__m128i*)d, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 1, 0, 0)));
+            _mm_storeu_si128((__m128i*)(d + 4), _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 2, 2)));
+        }
+    } else if (k == 3) {
+        for (; x + 4 <= sx1; x += 4, d += 12) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(src + x));
+            _mm_storeu_si128((__m128i*)d, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 0, 0)));
+            _mm_storeu_si128((__m128i*)(d + 4), _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 2, 1, 1)));
+            _mm_storeu_si128((__m128i*)(d + 8), _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 3, 2)));
+        }
+    } else if (k >= 4) {
+        for (; x < sx1; x++) {
+            __m128i v = _mm_set1_epi32((int)src[x]);
+            int i = 0;
+            for (; i + 4 <= k; i += 4, d += 4) _mm_storeu_si128((__m128i*)d, v);
+            for (; i < k; i++) *d++ = src[x];
+        }
+    }
+    ScaleRowRepeatScalar(src, dst, x, sx1, k);
+}
+#endif
+
+// Bilinear, vertical: out = a + (b - a) * f / 256 per channel, for n pixels.
+static inline void ScaleBlendRowsScalar(const uint32_t* a, const uint32_t* b, uint32_t* out, int n, int f) {
+    int g = 256 - f;
+    for (int i = 0; i < n; i++) {
+        uint32_t p = a[i], q = b[i], r = 0;
+        for (int c = 0; c < 32; c += 8) {
+            r |= ((((p >> c) & 255) * g + ((q >> c) & 255) * f) >> 8) << c;
+        }
+        out[i] = r;
+    }
+}
+
+// Bilinear, horizontal: output columns [x0, x1) from the blended row.
+static inline void ScaleBlendColsScalar(const Scaler& s, const uint32_t* row, uint32_t* dst, int x0, int x1) {
+    for (int x = x0; x < x1; x++) {
+        const uint32_t* p = row + s.srcX[x];
+        int f = s.fracX[x], g = 256 - f;
+        uint32_t r = 0;
+        for (int c = 0; c < 32; c += 8) {
+            r |= ((((p[0] >> c) & 255) * g + ((p[1] >> c) & 255) * f) >> 8) << c;
+        }
+        dst[x] = r;
+    }
+}
+
+#if defined(NG_HAVE_SSE2)
+static inline void ScaleBlendRowsSSE2(const uint32_t* a, const uint32_t* b, uint32_t* out, int n, int f) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i wa = _mm_set1_epi16((short)(256 - f)), wb = _mm_set1_epi16((short)f);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i p = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i q = _mm_loadu_si128((const __m128i*)(b + i));
+        // Sums stay below 2^16, so 16-bit lanes are exact.
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(p, zero), wa),
+                                   _mm_mullo_epi16(_mm_unpacklo_epi8(q, zero), wb));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(p, zero), wa),
+                                   _mm_mullo_epi16(_mm_unpackhi_epi8(q, zero), wb));
+        _mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)));
+    }
+    ScaleBlendRowsScalar(a + i, b + i, out + i, n - i, f);
+}
+
+static inline void ScaleBlendColsSSE2(const Scaler& s, const uint32_t* row, uint32_t* dst, int x0, int x1) {
+    const __m128i zero = _mm_setzero_si128();
+    int x = x0;
+    for (; x + 2 <= x1; x += 2) {
+        // Both neighbours of two output pixels, channels interleaved so one
+        // multiply-add per pixel weighs left against right.
+        __m128i p = _mm_loadl_epi64((const __m128i*)(row + s.srcX[x]));
+        __m128i q = _mm_loadl_epi64((const __m128i*)(row + s.srcX[x + 1]));
+        __m128i pw = _mm_unpacklo_epi8(p, zero), qw = _mm_unpacklo_epi8(q, zero);
+        __m128i pi = _mm_unpacklo_epi16(pw, _mm_srli_si128(pw, 8));
+        __m128i qi = _mm_unpacklo_epi16(qw, _mm_srli_si128(qw, 8));
+        int fp = s.fracX[x], fq = s.fracX[x + 1];
+        __m128i wp = _mm_set1_epi32((fp << 16) | (256 - fp));
+        __m128i wq = _mm_set1_epi32((fq << 16) | (256 - fq));
+        __m128i rp = _mm_srli_epi32(_mm_madd_epi16(pi, wp), 8);
+        __m128i rq = _mm_srli_epi32(_mm_madd_epi16(qi, wq), 8);
+        __m128i r16 = _mm_packs_epi32(rp, rq);
+        _mm_storel_epi64((__m128i*)(dst + x), _mm_packus_epi16(r16, r16));
+    }
+    ScaleBlendColsScalar(s, row, dst, x, x1);
+}
+#endif
+
+// Redraws the output pixels in `region` (window coordinates, clipped to the
+// frame) from `src`. level picks scalar or SSE2 kernels; both give the same
+// pixels. Returns the region actually written (integer scaling widens it
+// to whole source pixels).
+static inline DamageRect ScalerRun(Scaler& s, const Surface& src, const Surface& dst, DamageRect region,
+                                   NgSimdLevel level) {
+    const ScaleLayout& l = s.layout;
+    int x0 = region.x0 - l.x, y0 = region.y0 - l.y, x1 = region.x1 - l.x, y1 = region.y1 - l.y;
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > l.w) x1 = l.w;
+    if (y1 > l.h) y1 = l.h;
+    if (x0 >= x1 || y0 >= y1) return DamageRect{ 0, 0, 0, 0 };
+    bool simd = level >= NG_SIMD_SSE2;
+#if !defined(NG_HAVE_SSE2)
+    simd = false;
+#endif
+    uint32_t* frame = dst.pixels + (size_t)l.y * dst.stride + l.x;
+
+    if (l.mode == SCALE_INTEGER) {
+        int k = l.factor;
+        x0 = x0 / k * k;
+        y0 = y0 / k * k;
+        x1 = (x1 + k - 1) / k * k;
+        y1 = (y1 + k - 1) / k * k;
+        for (int sy = y0 / k; sy < y1 / k; sy++) {
+            const uint32_t* srow = src.pixels + (size_t)sy * src.stride;
+            uint32_t* d = frame + (size_t)sy * k * dst.stride;
+#if defined(NG_HAVE_SSE2)
+            if (simd) ScaleRowRepeatSSE2(srow, d, x0 / k, x1 / k, k);
+            else
+#endif
+            ScaleRowRepeatScalar(srow, d, x0 / k, x1 / k, k);
+            for (int i = 1; i < k; i++) {
+                memcpy(d + (size_t)i * dst.stride + x0, d + x0, sizeof(uint32_t) * (size_t)(x1 - x0));
+            }
+        }
+    } else if (l.mode == SCALE_NEAREST) {
+        for (int y = y0; y < y1; y++) {
+            uint32_t* d = frame + (size_t)y * dst.stride;
+            if (y > y0 && s.srcY[y] == s.srcY[y - 1]) {
+                memcpy(d + x0, d - dst.stride + x0, sizeof(uint32_t) * (size_t)(x1 - x0));
+            } else {
+                ScaleRowGather(s, src.pixels + (size_t)s.srcY[y] * src.stride, d, x0, x1);
+            }
+        }
+    } else {
+        // Source columns the region reads, plus the right neighbour.
+        int c0 = s.srcX[x0], c1 = s.srcX[x1 - 1] + 2;
+        if (c1 > l.srcW) c1 = l.srcW;
+        for (int y = y0; y < y1; y++) {
+            uint32_t* d = frame + (size_t)y * dst.stride;
+            const uint32_t* a = src.pixels + (size_t)s.srcY[y] * src.stride;
+            if (!s.fracY[y]) {
+                memcpy(s.row + c0, a + c0, sizeof(uint32_t) * (size_t)(c1 - c0));
+            } else {
+                const uint32_t* b = a + src.stride;
+#if defined(NG_HAVE_SSE2)
+                if (simd) ScaleBlendRowsSSE2(a + c0, b + c0, s.row + c0, c1 - c0, s.fracY[y]);
+                else
+#endif
+                ScaleBlendRowsScalar(a + c0, b + c0, s.row + c0, c1 - c0, s.fracY[y]);
+            }
+            // The last column has no right neighbour, but its weight is 0.
+            s.row[l.srcW] = s.row[l.srcW - 1];
+#if defined(NG_HAVE_SSE2)
+            if (simd) ScaleBlendColsSSE2(s, s.row, d, x0, x1);
+            else
+#endif
+            ScaleBlendColsScalar(s, s.row, d, x0, x1);
+        }
+    }
+    return DamageRect{ x0 + l.x, y0 + l.y, x1 + l.x, y1 + l.y };
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include <stdint.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "raster.h"
+
+// ======================================================
+// Shape primitives on top of the span kernels in raster.h
+//
+// Coverage follows GDI's conventions closely enough to swap for it: boxes
+// are half-open [x0, x1) x [y0, y1) and a pixel belongs to a filled shape
+// when its centre is inside. Outlines are drawn inside the box.
+// ======================================================
+
+// Outline of width `pen` just inside [x0, x1) x [y0, y1).
+static inline void RasterFrameRect(const Surface& s, int x0, int y0, int x1, int y1, uint32_t color, int pen = 1) {
+    if (x1 - x0 <= 2 * pen || y1 - y0 <= 2 * pen) {
+        RasterFillRect(s, x0, y0, x1, y1, color);
+        return;
+    }
+    RasterFillRect(s, x0, y0, x1, y0 + pen, color);
+    RasterFillRect(s, x0, y1 - pen, x1, y1, color);
+    RasterFillRect(s, x0, y0 + pen, x0 + pen, y1 - pen, color);
+    RasterFillRect(s, x1 - pen, y0 + pen, x1, y1 - pen, color);
+}
+
+// GDI Rectangle(): brush interior with a 1 px pen outline.
+static inline void RasterBox(const Surface& s, int x0, int y0, int x1, int y1, uint32_t fill, uint32_t outline) {
+    RasterFillRect(s, x0 + 1, y0 + 1, x1 - 1, y1 - 1, fill);
+    RasterFrameRect(s, x0, y0, x1, y1, outline);
+}
+
+// Ellipse inscribed in [x0, x1) x [y0, y1).
+static inline void RasterFillEllipse(const Surface& s, int x0, int y0, int x1, int y1, uint32_t color) {
+    if (x1 <= x0 || y1 <= y0) return;
+    const float cx = (x0 + x1) * 0.5f, cy = (y0 + y1) * 0.5f;
+    const float rx = (x1 - x0) * 0.5f, ry = (y1 - y0) * 0.5f;
+    int ya = y0 < 0 ? 0 : y0;
+    int yb = y1 > s.h ? s.h : y1;
+    for (int y = ya; y < yb; y++) {
+        float dy = ((float)y + 0.5f - cy) / ry;
+        float k = 1.0f - dy * dy;
+        if (k < 0.0f) continue;
+        float half = rx * sqrtf(k);
+        int xa = (int)ceilf(cx - half - 0.5f);
+        int xb = (int)floorf(cx + half - 0.5f) + 1;
+        if (xa < 0) xa = 0;
+        if (xb > s.w) xb = s.w;
+        RasterFillSpan(s.pixels + (size_t)y * s.stride + xa, xb - xa, color);
+    }
+}
+
+// GDI Ellipse() with a pen: `pen` px ring in `outline`, brush inside.
+static inline void RasterEllipse(const Surface& s, int x0, int y0, int x1, int y1, uint32_t fill, uint32_t outline, int pen = 1) {
+    RasterFillEllipse(s, x0, y0, x1, y1, outline);
+    RasterFillEllipse(s, x0 + pen, y0 + pen, x1 - pen, y1 - pen, fill);
+}
+
+// 1 px line through both endpoints (inclusive), DDA along the major axis.
+static inline void RasterLine(const Surface& s, int x0, int y0, int x1, int y1, uint32_t color) {
+    int dx = x1 - x0, dy = y1 - y0;
+    int steps = abs(dx) > abs(dy) ? abs(dx) : abs(dy);
+    if (steps == 0) steps = 1;
+    for (int i = 0; i <= steps; i++) {
+        int x = x0 + (dx * i + (dx >= 0 ? steps / 2 : -steps / 2)) / steps;
+        int y = y0 + (dy * i + (dy >= 0 ? steps / 2 : -steps / 2)) / steps;
+        if ((unsigned)x < (unsigned)s.w && (unsigned)y < (unsigned)s.h) s.pixels[(size_t)y * s.stride + x] = color;
+    }
+}
+
+// Pixels whose centres lie inside the triangle, one span per row.
+static inline void RasterFillTriangle(const Surface& s, const int* xs, const int* ys, uint32_t color) {
+    int ymin = ys[0], ymax = ys[0];
+    for (int i = 1; i < 3; i++) {
+        if (ys[i] < ymin) ymin = ys[i];
+        if (ys[i] > ymax) ymax = ys[i];
+    }
+    if (ymin < 0) ymin = 0;
+    if (ymax > s.h) ymax = s.h;
+    for (int y = ymin; y < ymax; y++) {
+        const float yc = (float)y + 0.5f;
+        float lo = 1e30f, hi = -1e30f;
+        for (int e = 0; e < 3; e++) {
+            float ax = (float)xs[e], ay = (float)ys[e];
+            float bx = (float)xs[(e + 1) % 3], by = (float)ys[(e + 1) % 3];
+            if ((yc < ay) == (yc < by)) continue; // edge doesn't cross this row
+            float x = ax + (yc - ay) * (bx - ax) / (by - ay);
+            if (x < lo) lo = x;
+            if (x > hi) hi = x;
+        }
+        if (hi < lo) continue;
+        int xa = (int)ceilf(lo - 0.5f);
+        int xb = (int)ceilf(hi - 0.5f);
+        if (xa < 0) xa = 0;
+        if (xb > s.w) xb = s.w;
+        RasterFillSpan(s.pixels + (size_t)y * s.stride + xa, xb - xa, color);
+    }
+}
+
+// GDI Polygon() for a triangle: brush fill plus a 1 px pen outline.
+static inline void RasterTriangle(const Surface& s, const int* xs, const int* ys, uint32_t fill, uint32_t outline) {
+    RasterFillTriangle(s, xs, ys, fill);
+    for (int i = 0; i < 3; i++) {
+        RasterLine(s, xs[i], ys[i], xs[(i + 1) % 3], ys[(i + 1) % 3], outline);
+    }
+}
+
+// Packs 8-bit channels as a 32 bpp DIB pixel (0x00RRGGBB).
+static inline uint32_t RasterRGB(int r, int g, int b) {
+    return ((uint32_t)r << 16) | ((uint32_t)g << 8) | (uint32_t)b;
+}
+
+// Per-channel lerp between two packed pixels, t clamped to [0, 1].
+static inline uint32_t RasterLerpRGB(uint32_t a, uint32_t b, float t) {
+    if (t < 0.0f) t = 0.0f;
+    if (t > 1.0f) t = 1.0f;
+    int ar = (a >> 16) & 255, ag = (a >> 8) & 255, ab = a & 255;
+    int br = (b >> 16) & 255, bg = (b >> 8) & 255, bb = b & 255;
+    return RasterRGB(ar + (int)((br - ar) * t), ag + (int)((bg - ag) * t), ab + (int)((bb - ab) * t));
+}
+
+// Vertical gradient over the whole surface in bands of `band` rows, each band
+// coloured at t = y / (h - 1) of its first row.
+static inline void RasterVGradient(const Surface& s, uint32_t top, uint32_t bottom, int band) {
+    if (band < 1) band = 1;
+    for (int y = 0; y < s.h; y += band) {
+        float t = (s.h > 1) ? (float)y / (float)(s.h - 1) : 0.0f;
+        RasterFillRect(s, 0, y, s.w, y + band, RasterLerpRGB(top, bottom, t));
+    }
+}
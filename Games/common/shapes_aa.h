@@ -0,0 +1,253 @@
+#pragma once
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+
+#include "raster.h"
+
+// ======================================================
+// Anti-aliased circle and ellipse fills
+//
+// A pixel's coverage is 0.5 - d, clamped to [0, 1], where d is the signed
+// distance from its centre to the boundary: exact for circles, a first-order
+// estimate (f / |grad f|) for ellipses. Each row is split analytically into
+// a solid interior, filled with the raster.h span kernels, and a ramp at
+// either end where every pixel is blended over what is already there. The
+// ramps are evaluated 4 (SSE2) or 8 (AVX2) pixels at a time with the same
+// float operations in the same order as the scalar code, so all tiers
+// produce the same bits.
+//
+// Blending rounds (src*a + dst*(255-a)) / 255 per channel; with a = 255 it
+// writes src, with a = 0 it leaves dst alone.
+// ======================================================
+
+// What the ramp kernels need to know about one row.
+struct AARow {
+    float cx;
+    float irx2, irx4;   // 1/rx^2, 1/rx^4
+    float qy, qy4;      // dy^2/ry^2, dy^2/ry^4 for this row's centre
+};
+
+// Blends `color` into row[x0, x1) with per-pixel coverage.
+typedef void (*AARampFn)(uint32_t* row, int x0, int x1, const AARow& r, uint32_t color);
+
+struct AAKernels {
+    NgSimdLevel level;
+    AARampFn ramp;
+};
+
+static inline int AAAlpha(const AARow& r, float x) {
+    const float dx = (x + 0.5f) - r.cx;
+    const float dx2 = dx * dx;
+    const float g = sqrtf(dx2 * r.irx2 + r.qy);
+    float den = sqrtf(dx2 * r.irx4 + r.qy4);
+    den = den > 1e-20f ? den : 1e-20f;
+    float c = 0.5f - (g - 1.0f) * g / den;
+    c = c > 0.0f ? c : 0.0f;
+    c = c < 1.0f ? c : 1.0f;
+    return (int)(c * 255.0f + 0.5f);
+}
+
+static inline uint32_t AABlend(uint32_t dst, uint32_t src, int a) {
+    uint32_t out = 0;
+    for (int sh = 0; sh < 32; sh += 8) {
+        uint32_t v = ((src >> sh) & 255) * a + ((dst >> sh) & 255) * (255 - a) + 128;
+        out |= ((v + (v >> 8)) >> 8) << sh;
+    }
+    return out;
+}
+
+static inline void AARampScalar(uint32_t* row, int x0, int x1, const AARow& r, uint32_t color) {
+    for (int x = x0; x < x1; x++) row[x] = AABlend(row[x], color, AAAlpha(r, (float)x));
+}
+
+#if defined(NG_HAVE_SSE2)
+// Blends 4 pixels (16 bytes as two halves of 8 x u16) with alphas a0..a3.
+static inline __m128i AABlend4SSE2(__m128i px, __m128i src16, __m128i alpha) {
+    const __m128i zero = _mm_setzero_si128(), k255 = _mm_set1_epi16(255), k128 = _mm_set1_epi16(128);
+    __m128i a16 = _mm_packs_epi32(alpha, alpha);
+    a16 = _mm_unpacklo_epi16(a16, a16);                 // a0 a0 a1 a1 a2 a2 a3 a3
+    const __m128i aLo = _mm_unpacklo_epi32(a16, a16);   // a0 x4, a1 x4
+    const __m128i aHi = _mm_unpackhi_epi32(a16, a16);   // a2 x4, a3 x4
+    __m128i lo = _mm_unpacklo_epi8(px, zero), hi = _mm_unpackhi_epi8(px, zero);
+    lo = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(src16, aLo), _mm_mullo_epi16(lo, _mm_sub_epi16(k255, aLo))), k128);
+    hi = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(src16, aHi), _mm_mullo_epi16(hi, _mm_sub_epi16(k255, aHi))), k128);
+    lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+    hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+    return _mm_packus_epi16(lo, hi);
+}
+
+// Blends the 4 pixels at p, which sit at x..x+3.
+static inline void AARamp4SSE2(uint32_t* p, int x, const AARow& r, __m128i src16) {
+    const __m128 half = _mm_set1_ps(0.5f), one = _mm_set1_ps(1.0f);
+    const __m128 xf = _mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32(x), _mm_set_epi32(3, 2, 1, 0)));
+    const __m128 dx = _mm_sub_ps(_mm_add_ps(xf, half), _mm_set1_ps(r.cx));
+    const __m128 dx2 = _mm_mul_ps(dx, dx);
+    const __m128 g = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx2, _mm_set1_ps(r.irx2)), _mm_set1_ps(r.qy)));
+    const __m128 den = _mm_max_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx2, _mm_set1_ps(r.irx4)), _mm_set1_ps(r.qy4))),
+                                  _mm_set1_ps(1e-20f));
+    __m128 c = _mm_sub_ps(half, _mm_div_ps(_mm_mul_ps(_mm_sub_ps(g, one), g), den));
+    c = _mm_min_ps(_mm_max_ps(c, _mm_setzero_ps()), one);
+    const __m128i a = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(c, _mm_set1_ps(255.0f)), half));
+    _mm_storeu_si128((__m128i*)p, AABlend4SSE2(_mm_loadu_si128((const __m128i*)p), src16, a));
+}
+
+// Ramps are mostly a few pixels long, so the last 1-3 go through a padded
+// copy rather than the much slower scalar path.
+static inline void AARampSSE2(uint32_t* row, int x0, int x1, const AARow& r, uint32_t color) {
+    const __m128i src16 = _mm_unpacklo_epi8(_mm_set1_epi32((int)color), _mm_setzero_si128());
+    int x = x0;
+    for (; x + 4 <= x1; x += 4) AARamp4SSE2(row + x, x, r, src16);
+    if (x < x1) {
+        uint32_t tmp[4];
+        const int n = x1 - x;
+        memcpy(tmp, row + x, (size_t)n * 4);
+        AARamp4SSE2(tmp, x, r, src16);
+        memcpy(row + x, tmp, (size_t)n * 4);
+    }
+}
+#endif
+
+#if defined(NG_HAVE_AVX2)
+NG_TARGET_AVX2 static inline void AARampAVX2(uint32_t* row, int x0, int x1, const AARow& r, uint32_t color) {
+    const __m256 half = _mm256_set1_ps(0.5f), one = _mm256_set1_ps(1.0f), zero = _mm256_setzero_ps();
+    const __m256 tiny = _mm256_set1_ps(1e-20f), k255 = _mm256_set1_ps(255.0f);
+    const __m256 cx = _mm256_set1_ps(r.cx), irx2 = _mm256_set1_ps(r.irx2), irx4 = _mm256_set1_ps(r.irx4);
+    const __m256 qy = _mm256_set1_ps(r.qy), qy4 = _mm256_set1_ps(r.qy4);
+    const __m256i zi = _mm256_setzero_si256();
+    const __m256i src16 = _mm256_unpacklo_epi8(_mm256_set1_epi32((int)color), zi);
+    const __m256i k255i = _mm256_set1_epi16(255), k128 = _mm256_set1_epi16(128);
+    const __m256i step = _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    int x = x0;
+    for (; x + 8 <= x1; x += 8) {
+        const __m256 xf = _mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_set1_epi32(x), step));
+        const __m256 dx = _mm256_sub_ps(_mm256_add_ps(xf, half), cx);
+        const __m256 dx2 = _mm256_mul_ps(dx, dx);
+        const __m256 g = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx2, irx2), qy));
+        const __m256 den = _mm256_max_ps(_mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx2, irx4), qy4)), tiny);
+        __m256 c = _mm256_sub_ps(half, _mm256_div_ps(_mm256_mul_ps(_mm256_sub_ps(g, one), g), den));
+        c = _mm256_min_ps(_mm256_max_ps(c, zero), one);
+        const __m256i a = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(c, k255), half));
+
+        // Unpacks work within 128-bit lanes: lane 0 holds pixels 0-3 and
+        // alphas 0-3, lane 1 pixels 4-7 and alphas 4-7, so they stay paired.
+        __m256i a16 = _mm256_packs_epi32(a, a);
+        a16 = _mm256_unpacklo_epi16(a16, a16);
+        const __m256i aLo = _mm256_unpacklo_epi32(a16, a16);
+        const __m256i aHi = _mm256_unpackhi_epi32(a16, a16);
+        __m256i* p = (__m256i*)(row + x);
+        const __m256i px = _mm256_loadu_si256(p);
+        __m256i lo = _mm256_unpacklo_epi8(px, zi), hi = _mm256_unpackhi_epi8(px, zi);
+        lo = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(src16, aLo),
+                                               _mm256_mullo_epi16(lo, _mm256_sub_epi16(k255i, aLo))), k128);
+        hi = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(src16, aHi),
+                                               _mm256_mullo_epi16(hi, _mm256_sub_epi16(k255i, aHi))), k128);
+        lo = _mm256_srli_epi16(_mm256_add_epi16(lo, _mm256_srli_epi16(lo, 8)), 8);
+        hi = _mm256_srli_epi16(_mm256_add_epi16(hi, _mm256_srli_epi16(hi, 8)), 8);
+        _mm256_storeu_si256(p, _mm256_packus_epi16(lo, hi));
+    }
+#if defined(NG_HAVE_SSE2)
+    AARampSSE2(row, x, x1, r, color);
+#else
+    AARampScalar(row, x, x1, r, color);
+#endif
+}
+#endif
+
+static inline AAKernels AAPickKernels(NgSimdLevel level) {
+    AAKernels k = { NG_SIMD_SCALAR, AARampScalar };
+#if defined(NG_HAVE_SSE2)
+    if (level >= NG_SIMD_SSE2) { k.level = NG_SIMD_SSE2; k.ramp = AARampSSE2; }
+#endif
+#if defined(NG_HAVE_AVX2)
+    if (level >= NG_SIMD_AVX2) { k.level = NG_SIMD_AVX2; k.ramp = AARampAVX2; }
+#endif
+    (void)level;
+    return k;
+}
+
+// Kernels used by the fills below; tools may overwrite this to compare tiers.
+static AAKernels g_aa = AAPickKernels(NgDetectSimd());
+
+// Half-width of the ramp. Distances are exact for circles, so half a pixel
+// either side of the edge covers every partial pixel; for an ellipse the
+// estimate can be off by up to the axis ratio, so the ramp widens with it.
+static inline float AAMargin(float rx, float ry) {
+    return 0.5f * (rx > ry ? rx / ry : ry / rx);
+}
+
+// Pixels an AA ellipse may touch, as [x0, x1) x [y0, y1), unclipped.
+static inline void RasterEllipseAABounds(float cx, float cy, float rx, float ry, int* x0, int* y0, int* x1, int* y1) {
+    const float m = AAMargin(rx, ry);
+    *x0 = (int)floorf(cx - rx - m);
+    *y0 = (int)floorf(cy - ry - m);
+    *x1 = (int)ceilf(cx + rx + m) + 1;
+    *y1 = (int)ceilf(cy + ry + m) + 1;
+}
+
+// Ellipse centred on (cx, cy) with radii rx, ry, in pixel coordinates
+// (pixel x covers [x, x + 1)), blended over the pixels of `clip`. Coverage
+// depends only on a pixel's own position, so clipping never changes it.
+static inline void RasterFillEllipseAAClip(const Surface& s, const RasterClip& clip, float cx, float cy, float rx,
+                                           float ry, uint32_t color) {
+    if (!(rx > 0.0f) || !(ry > 0.0f)) return;
+    const float m = AAMargin(rx, ry);
+    const float orx = rx + m, ory = ry + m;   // past this, coverage is 0
+    const float irx = rx - m, iry = ry - m;   // inside this, coverage is 1
+    int ya = (int)floorf(cy - ory - 0.5f), yb = (int)ceilf(cy + ory - 0.5f) + 1;
+    if (ya < clip.y0) ya = clip.y0;
+    if (yb > clip.y1) yb = clip.y1;
+
+    AARow r;
+    r.cx = cx;
+    r.irx2 = 1.0f / (rx * rx);
+    r.irx4 = r.irx2 * r.irx2;
+    const float iry2 = 1.0f / (ry * ry), iry4 = iry2 * iry2;
+    const float iory2 = 1.0f / (ory * ory), iiry2 = iry > 0.0f ? 1.0f / (iry * iry) : 0.0f;
+
+    for (int y = ya; y < yb; y++) {
+        const float dy = ((float)y + 0.5f) - cy;
+        const float dy2 = dy * dy;
+        const float ko = 1.0f - dy2 * iory2;
+        if (ko <= 0.0f) continue;
+        const float ho = orx * sqrtf(ko);
+        int xa = (int)floorf(cx - ho - 0.5f), xb = (int)ceilf(cx + ho - 0.5f) + 1;
+        if (xa < clip.x0) xa = clip.x0;
+        if (xb > clip.x1) xb = clip.x1;
+        if (xb <= xa) continue;
+
+        // Solid interior: pixel centres within the inner ellipse.
+        int ia = xa, ib = xa;
+        if (irx > 0.0f && iry > 0.0f) {
+            const float ki = 1.0f - dy2 * iiry2;
+            if (ki > 0.0f) {
+                const float hi = irx * sqrtf(ki);
+                ia = (int)ceilf(cx - hi - 0.5f);
+                ib = (int)floorf(cx + hi - 0.5f) + 1;
+                if (ia < xa) ia = xa;
+                if (ib > xb) ib = xb;
+                if (ib <= ia) ia = ib = xa;
+            }
+        }
+
+        r.qy = dy2 * iry2;
+        r.qy4 = dy2 * iry4;
+        uint32_t* row = s.pixels + (size_t)y * s.stride;
+        if (ib > ia) {
+            g_aa.ramp(row, xa, ia, r, color);
+            RasterFillSpan(row + ia, ib - ia, color);
+            g_aa.ramp(row, ib, xb, r, color);
+        } else {
+            g_aa.ramp(row, xa, xb, r, color);
+        }
+    }
+}
+
+static inline void RasterFillEllipseAA(const Surface& s, float cx, float cy, float rx, float ry, uint32_t color) {
+    const RasterClip all = { 0, 0, s.w, s.h };
+    RasterFillEllipseAAClip(s, all, cx, cy, rx, ry, color);
+}
+
+static inline void RasterFillCircleAA(const Surface& s, float cx, float cy, float r, uint32_t color) {
+    RasterFillEllipseAA(s, cx, cy, r, r, color);
+}
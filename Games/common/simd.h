@@ -0,0 +1,92 @@
+#pragma once
+#include <stdint.h>
+#include <stdlib.h>
+
+// ======================================================
+// SIMD helpers shared by the games and headless tools
+//
+// SSE2 is the x64 baseline and is used unconditionally when the compiler
+// targets it. AVX2 kernels are compiled with NG_TARGET_AVX2 so the rest of
+// the executable stays baseline, and are only called after NgHasAVX2().
+// ======================================================
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NG_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(NG_HAVE_SSE2) && (defined(_MSC_VER) || defined(__GNUC__) || defined(__clang__))
+#define NG_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define NG_TARGET_AVX2
+#else
+#define NG_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+// Kernel tiers; headless tools may force a lower tier to compare paths.
+enum NgSimdLevel {
+    NG_SIMD_SCALAR = 0,
+    NG_SIMD_SSE2 = 1,
+    NG_SIMD_AVX2 = 2,
+};
+
+static inline bool NgHasAVX2() {
+#if !defined(NG_HAVE_AVX2)
+    return false;
+#elif defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    const int osxsave = 1 << 27, avx = 1 << 28;
+    if ((info[2] & (osxsave | avx)) != (osxsave | avx)) return false;
+    if ((_xgetbv(0) & 6) != 6) return false; // OS saves XMM + YMM state
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init(); // may run from a static initializer
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+static inline NgSimdLevel NgDetectSimd() {
+    static int cached = -1;
+    if (cached < 0) {
+        int level = NG_SIMD_SCALAR;
+#if defined(NG_HAVE_SSE2)
+        level = NG_SIMD_SSE2;
+        if (NgHasAVX2()) level = NG_SIMD_AVX2;
+#endif
+        cached = level;
+    }
+    return (NgSimdLevel)cached;
+}
+
+// Kernel-table pick for a requested level, clamped to what the CPU supports.
+static inline NgSimdLevel NgClampSimd(int requested) {
+    int best = NgDetectSimd();
+    if (requested < 0 || requested > best) return (NgSimdLevel)best;
+    return (NgSimdLevel)requested;
+}
+
+static inline void* NgAlignedAlloc(size_t bytes, size_t align) {
+#if defined(_MSC_VER) || defined(__MINGW32__)
+    return _aligned_malloc(bytes, align);
+#else
+    void* p = nullptr;
+    if (posix_memalign(&p, align, bytes) != 0) return nullptr;
+    return p;
+#endif
+}
+
+static inline void NgAlignedFree(void* p) {
+#if defined(_MSC_VER) || defined(__MINGW32__)
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+#include "raster.h"
+#include "simd.h"
+
+// ======================================================
+// Owned pixel surfaces (sprites) and blits between surfaces
+//
+// A sprite is just a Surface whose pixels this module allocated. Blits
+// clip against the destination; keyed blits skip pixels equal to the key.
+// ======================================================
+
+// Colour-key for sprite pixels that should not be drawn.
+static const uint32_t kSpriteKey = 0x00FF00FF;
+
+static inline bool SpriteAlloc(Surface& s, int w, int h) {
+    s.w = w;
+    s.h = h;
+    s.stride = w;
+    s.pixels = (uint32_t*)NgAlignedAlloc((size_t)w * h * 4, 32);
+    return s.pixels != nullptr;
+}
+
+static inline void SpriteFree(Surface& s) {
+    NgAlignedFree(s.pixels);
+    s = Surface{};
+}
+
+// Copies the whole of src over dst (same size) in as few block moves as the
+// strides allow.
+static inline void BlitAll(const Surface& dst, const Surface& src) {
+    if (dst.stride == src.stride && dst.stride == dst.w) {
+        memcpy(dst.pixels, src.pixels, (size_t)dst.w * dst.h * 4);
+        return;
+    }
+    for (int y = 0; y < dst.h; y++) {
+        memcpy(dst.pixels + (size_t)y * dst.stride, src.pixels + (size_t)y * src.stride, (size_t)dst.w * 4);
+    }
+}
+
+// Clips src rows [sy0, sy1) placed with its origin at (dx, dy) against dst.
+// Returns false when nothing is visible; otherwise fills the visible span.
+static inline bool BlitClip(const Surface& dst, const Surface& src, int dx, int dy, int sy0, int sy1,
+                            int* sx, int* sy, int* ox, int* oy, int* w, int* h) {
+    if (sy0 < 0) sy0 = 0;
+    if (sy1 > src.h) sy1 = src.h;
+    int x0 = dx, y0 = dy + sy0;
+    int x1 = dx + src.w, y1 = dy + sy1;
+    int cx0 = x0 < 0 ? 0 : x0, cy0 = y0 < 0 ? 0 : y0;
+    int cx1 = x1 > dst.w ? dst.w : x1, cy1 = y1 > dst.h ? dst.h : y1;
+    if (cx1 <= cx0 || cy1 <= cy0) return false;
+    *sx = cx0 - dx;
+    *sy = cy0 - dy;
+    *ox = cx0;
+    *oy = cy0;
+    *w = cx1 - cx0;
+    *h = cy1 - cy0;
+    return true;
+}
+
+// Opaque copy of src rows [sy0, sy1) with src's origin at (dx, dy).
+static inline void BlitRows(const Surface& dst, const Surface& src, int dx, int dy, int sy0, int sy1) {
+    int sx, sy, ox, oy, w, h;
+    if (!BlitClip(dst, src, dx, dy, sy0, sy1, &sx, &sy, &ox, &oy, &w, &h)) return;
+    for (int y = 0; y < h; y++) {
+        memcpy(dst.pixels + (size_t)(oy + y) * dst.stride + ox,
+               src.pixels + (size_t)(sy + y) * src.stride + sx, (size_t)w * 4);
+    }
+}
+
+static inline void Blit(const Surface& dst, const Surface& src, int dx, int dy) {
+    BlitRows(dst, src, dx, dy, 0, src.h);
+}
+
+// Copy of src at (dx, dy) that leaves dst untouched wherever src == key.
+static inline void BlitKeyed(const Surface& dst, const Surface& src, int dx, int dy, uint32_t key = kSpriteKey) {
+    int sx, sy, ox, oy, w, h;
+    if (!BlitClip(dst, src, dx, dy, 0, src.h, &sx, &sy, &ox, &oy, &w, &h)) return;
+    for (int y = 0; y < h; y++) {
+        uint32_t* d = dst.pixels + (size_t)(oy + y) * dst.stride + ox;
+        const uint32_t* s = src.pixels + (size_t)(sy + y) * src.stride + sx;
+        int x = 0;
+#if defined(NG_HAVE_SSE2)
+        const __m128i k = _mm_set1_epi32((int)key);
+        for (; x + 4 <= w; x += 4) {
+            __m128i sp = _mm_loadu_si128((const __m128i*)(s + x));
+            __m128i dp = _mm_loadu_si128((const __m128i*)(d + x));
+            __m128i hole = _mm_cmpeq_epi32(sp, k);
+            _mm_storeu_si128((__m128i*)(d + x), _mm_or_si128(_mm_and_si128(hole, dp), _mm_andnot_si128(hole, sp)));
+        }
+#endif
+        for (; x < w; x++) {
+            if (s[x] != key) d[x] = s[x];
+        }
+    }
+}
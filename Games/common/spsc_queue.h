@@ -0,0 +1,59 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+
+// ======================================================
+// Bounded single-producer / single-consumer queue
+//
+// A fixed ring of N items (N a power of two) with free-running head and
+// tail counters. Only the producer writes `tail` and only the consumer
+// writes `head`, so push and pop are each one acquire load and one
+// release store: no locks, no allocation, and neither side ever waits.
+// A full queue refuses the push; the caller decides what to drop.
+//
+//   producer: if (!SpscPush(q, item)) ...dropped...;
+//   consumer: T item; while (SpscPop(q, item)) use(item);
+//
+// SpscPeek lets the consumer look at the oldest item and leave it queued.
+// ======================================================
+
+template <typename T, uint32_t N>
+struct SpscQueue {
+    static_assert((N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+    T items[N];
+    std::atomic<uint32_t> head;   // next to pop; consumer-owned
+    std::atomic<uint32_t> tail;   // next to push; producer-owned
+};
+
+// Call before either thread starts.
+template <typename T, uint32_t N>
+static inline void SpscInit(SpscQueue<T, N>& q) {
+    q.head.store(0, std::memory_order_relaxed);
+    q.tail.store(0, std::memory_order_relaxed);
+}
+
+template <typename T, uint32_t N>
+static inline bool SpscPush(SpscQueue<T, N>& q, const T& item) {
+    uint32_t tail = q.tail.load(std::memory_order_relaxed);
+    if (tail - q.head.load(std::memory_order_acquire) >= N) return false;
+    q.items[tail & (N - 1)] = item;
+    q.tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T, uint32_t N>
+static inline bool SpscPop(SpscQueue<T, N>& q, T& item) {
+    uint32_t head = q.head.load(std::memory_order_relaxed);
+    if (head == q.tail.load(std::memory_order_acquire)) return false;
+    item = q.items[head & (N - 1)];
+    q.head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T, uint32_t N>
+static inline bool SpscPeek(SpscQueue<T, N>& q, T& item) {
+    uint32_t head = q.head.load(std::memory_order_relaxed);
+    if (head == q.tail.load(std::memory_order_acquire)) return false;
+    item = q.items[head & (N - 1)];
+    return true;
+}
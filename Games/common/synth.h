@@ -0,0 +1,259 @@
+#pragma once
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+
+#include "simd.h"
+#include "spsc_queue.h"
+
+// ======================================================
+// Procedural sound effects: a tiny synthesizer and mixer
+//
+// A sound is one oscillator (square, triangle, saw, sine or pitched noise)
+// whose pitch slides from freq0 to freq1 over the sound, under an attack /
+// hold / release envelope. The game thread triggers sounds with SynthPlay,
+// which only pushes a SynthEvent onto a lock-free SPSC queue; the audio
+// thread's SynthRender drains the queue, starts voices (stealing the
+// oldest when all are busy) and mixes them into 16-bit mono PCM. Nothing
+// on the audio side allocates, locks or waits.
+//
+// Voices are generated one sample at a time (each oscillator is a running
+// recurrence), then summed into the mix bus and converted to PCM with
+// SSE2, four samples per instruction; the scalar path gives the same bits.
+// ======================================================
+
+enum {
+    kSynthRate = 44100,     // samples per second, mono
+    kSynthVoices = 16,
+    kSynthBlock = 256,      // samples mixed per pass
+    kSynthQueue = 64,       // pending triggers
+};
+
+enum SynthWave {
+    SYNTH_SQUARE = 0,
+    SYNTH_TRIANGLE = 1,
+    SYNTH_SAW = 2,
+    SYNTH_SINE = 3,
+    SYNTH_NOISE = 4,        // a new random level every period: pitch sets the grain
+};
+
+struct SynthSound {
+    SynthWave wave;
+    float freq0, freq1;             // Hz at the start and end of the sound
+    float attack, hold, release;    // seconds
+    float volume;                   // 0..1
+    float duty;                     // square: fraction of the period spent high
+};
+
+struct SynthEvent {
+    SynthSound sound;
+    float pitch;        // multiplies both frequencies
+    double time;        // trigger time on the caller's clock, in seconds
+};
+
+struct SynthVoice {
+    SynthSound sound;
+    float phase, freq, sweep;   // sweep: frequency ratio per sample
+    float noiseLevel;
+    uint32_t noise;
+    int age, attackLen, releaseAt, length;  // samples
+    float invAttack, invRelease;
+    bool active;
+};
+
+// Trigger-to-mix latency of started sounds: the time from SynthPlay until
+// the block holding the sound's first sample, plus whatever audio the
+// caller says is queued ahead of that block. Written by the audio thread.
+struct SynthLatency {
+    std::atomic<uint32_t> count, maxUs;
+    std::atomic<uint64_t> sumUs;
+};
+
+struct Synth {
+    SpscQueue<SynthEvent, kSynthQueue> events;
+    SynthVoice voices[kSynthVoices];
+    float mix[kSynthBlock];
+    float tmp[kSynthBlock];
+    float master;               // output gain
+    NgSimdLevel level;
+    uint64_t rendered;          // samples so far (audio thread)
+    uint32_t stolen;            // voices cut short (audio thread)
+    uint32_t dropped;           // triggers refused by a full queue (game thread)
+    uint32_t noiseSeed;
+    SynthLatency latency;
+};
+
+static inline void SynthInit(Synth& s, NgSimdLevel level) {
+    SpscInit(s.events);
+    memset(s.voices, 0, sizeof(s.voices));
+    s.master = 0.5f;
+    s.level = level;
+    s.rendered = 0;
+    s.stolen = s.dropped = 0;
+    s.noiseSeed = 0x2545F491u;
+    s.latency.count.store(0);
+    s.latency.maxUs.store(0);
+    s.latency.sumUs.store(0);
+}
+
+// ---- Game thread ----
+static inline bool SynthPlay(Synth& s, const SynthSound& sound, float pitch, double time) {
+    SynthEvent e;
+    e.sound = sound;
+    e.pitch = pitch;
+    e.time = time;
+    if (SpscPush(s.events, e)) return true;
+    s.dropped++;
+    return false;
+}
+
+// Average and worst latency since the last call, in milliseconds; false if
+// no sound started in between.
+static inline bool SynthTakeLatency(Synth& s, double* avgMs, double* maxMs) {
+    uint32_t n = s.latency.count.exchange(0, std::memory_order_relaxed);
+    uint64_t sum = s.latency.sumUs.exchange(0, std::memory_order_relaxed);
+    uint32_t worst = s.latency.maxUs.exchange(0, std::memory_order_relaxed);
+    if (!n) return false;
+    *avgMs = (double)sum / n * 1e-3;
+    *maxMs = worst * 1e-3;
+    return true;
+}
+
+// ---- Audio thread ----
+// A sound that is still playing restarts on its own voice, as on a sound
+// chip, so rapid repeats don't stack up and clip.
+static inline void SynthStart(Synth& s, const SynthEvent& e) {
+    SynthVoice* v = nullptr;
+    for (SynthVoice& c : s.voices) {
+        if (c.active && memcmp(&c.sound, &e.sound, sizeof(SynthSound)) == 0) { v = &c; break; }
+    }
+    if (!v) {
+        for (SynthVoice& c : s.voices) {
+            if (!c.active) { v = &c; break; }
+            if (!v || c.age > v->age) v = &c;
+        }
+        if (v->active) s.stolen++;
+    }
+    const SynthSound& k = e.sound;
+    v->sound = k;
+    v->phase = 0.0f;
+    v->freq = k.freq0 * e.pitch / (float)kSynthRate;
+    v->attackLen = (int)(k.attack * kSynthRate);
+    v->releaseAt = v->attackLen + (int)(k.hold * kSynthRate);
+    v->length = v->releaseAt + (int)(k.release * kSynthRate);
+    if (v->length < 1) v->length = 1;
+    v->invAttack = v->attackLen ? 1.0f / (float)v->attackLen : 0.0f;
+    v->invRelease = v->length > v->releaseAt ? 1.0f / (float)(v->length - v->releaseAt) : 0.0f;
+    v->sweep = (k.freq0 > 0.0f && k.freq1 > 0.0f) ? powf(k.freq1 / k.freq0, 1.0f / (float)v->length) : 1.0f;
+    s.noiseSeed = s.noiseSeed * 1664525u + 1013904223u;
+    v->noise = s.noiseSeed | 1u;
+    v->noiseLevel = 0.0f;
+    v->age = 0;
+    v->active = true;
+}
+
+// n samples of one voice, enveloped and at its volume, into out.
+static inline void SynthVoiceRender(SynthVoice& v, float* out, int n) {
+    const SynthSound& k = v.sound;
+    float phase = v.phase, freq = v.freq;
+    int i = 0;
+    for (; i < n && v.age < v.length; i++, v.age++) {
+        float x;
+        switch (k.wave) {
+        case SYNTH_SQUARE:   x = phase < k.duty ? 1.0f : -1.0f; break;
+        case SYNTH_TRIANGLE: x = 4.0f * fabsf(phase - 0.5f) - 1.0f; break;
+        case SYNTH_SAW:      x = 2.0f * phase - 1.0f; break;
+        case SYNTH_SINE:     x = sinf(6.2831853f * phase); break;
+        default:             x = v.noiseLevel; break;
+        }
+        float env = 1.0f;
+        if (v.age < v.attackLen) env = (float)v.age * v.invAttack;
+        else if (v.age >= v.releaseAt) env = 1.0f - (float)(v.age - v.releaseAt) * v.invRelease;
+        out[i] = x * env * k.volume;
+
+        phase += freq;
+        freq *= v.sweep;
+        if (phase >= 1.0f) {
+            phase -= (float)(int)phase;
+            v.noise ^= v.noise << 13; v.noise ^= v.noise >> 17; v.noise ^= v.noise << 5;
+            v.noiseLevel = (float)(int32_t)v.noise * (1.0f / 2147483648.0f);
+        }
+    }
+    for (; i < n; i++) out[i] = 0.0f;
+    v.phase = phase;
+    v.freq = freq;
+    if (v.age >= v.length) v.active = false;
+}
+
+static inline void SynthAddScalar(float* mix, const float* src, int n) {
+    for (int i = 0; i < n; i++) mix[i] += src[i];
+}
+
+// Rounds to nearest (even on ties) and saturates, as cvtps2dq + packssdw do.
+static inline void SynthToPcmScalar(const float* mix, int16_t* out, int n, float gain) {
+    for (int i = 0; i < n; i++) {
+        long r = lrintf(mix[i] * gain);
+        out[i] = (int16_t)(r < -32768 ? -32768 : r > 32767 ? 32767 : r);
+    }
+}
+
+#if defined(NG_HAVE_SSE2)
+static inline void SynthAddSSE2(float* mix, const float* src, int n) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(mix + i, _mm_add_ps(_mm_loadu_ps(mix + i), _mm_loadu_ps(src + i)));
+    }
+    SynthAddScalar(mix + i, src + i, n - i);
+}
+
+static inline void SynthToPcmSSE2(const float* mix, int16_t* out, int n, float gain) {
+    const __m128 g = _mm_set1_ps(gain);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i a = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(mix + i), g));
+        __m128i b = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(mix + i + 4), g));
+        _mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(a, b));
+    }
+    SynthToPcmScalar(mix + i, out + i, n - i, gain);
+}
+#endif
+
+// Fills out with the next `frames` samples. `now` is the caller's clock
+// (the one SynthPlay times are on) and `ahead` the seconds of audio already
+// queued in front of out[0]; both only feed the latency figures.
+static inline void SynthRender(Synth& s, int16_t* out, int frames, double now, double ahead) {
+    SynthEvent e;
+    while (SpscPop(s.events, e)) {
+        SynthStart(s, e);
+        double secs = now - e.time + ahead;
+        uint32_t us = secs > 0.0 ? (uint32_t)(secs * 1e6) : 0;
+        s.latency.sumUs.fetch_add(us, std::memory_order_relaxed);
+        if (us > s.latency.maxUs.load(std::memory_order_relaxed)) s.latency.maxUs.store(us, std::memory_order_relaxed);
+        s.latency.count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool simd = s.level >= NG_SIMD_SSE2;
+    const float gain = s.master * 32767.0f;
+    for (int done = 0; done < frames;) {
+        int n = frames - done < kSynthBlock ? frames - done : kSynthBlock;
+        memset(s.mix, 0, sizeof(float) * (size_t)n);
+        for (SynthVoice& v : s.voices) {
+            if (!v.active) continue;
+            SynthVoiceRender(v, s.tmp, n);
+#if defined(NG_HAVE_SSE2)
+            if (simd) SynthAddSSE2(s.mix, s.tmp, n);
+            else
+#endif
+            SynthAddScalar(s.mix, s.tmp, n);
+        }
+#if defined(NG_HAVE_SSE2)
+        if (simd) SynthToPcmSSE2(s.mix, out + done, n, gain);
+        else
+#endif
+        SynthToPcmScalar(s.mix, out + done, n, gain);
+        done += n;
+    }
+    (void)simd;
+    s.rendered += (uint64_t)frames;
+}
@@ -0,0 +1,469 @@
+#pragma once
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+#include "raster.h"
+#include "shapes_aa.h"
+#include "font.h"
+#include "particles.h"
+
+// ======================================================
+// Tile-parallel rendering
+//
+// A frame is recorded as a list of draw commands, each with the box of
+// pixels it may touch. TileRender bins them into kTileW x kTileH tiles
+// (32 KB of pixels, so a tile stays in L1 while every command on it
+// draws) with a counting sort that keeps record order, then rasterizes
+// the tiles on a TilePool: threads started once and woken per frame,
+// pulling tile indices off an atomic counter alongside the caller.
+// Binning and waking cost about as much as one extra thread saves on a
+// 1080p frame, so callers should only tile with 3 or more threads.
+//
+// Each command draws through a clipped primitive whose pixels depend only
+// on their own position and previous value, and each tile replays its
+// commands in record order, so the frame is bit-identical to drawing the
+// same commands straight onto the surface, for any number of threads.
+// Command and bin storage grows to the biggest frame seen and is reused,
+// so a steady stream of frames allocates nothing.
+//
+//   TileFrameBegin(frame, surface);
+//   TileFill(frame, ...); TileEllipseAA(frame, ...); ...
+//   TileRender(frame, &pool);   // or nullptr: the caller draws every tile
+// ======================================================
+
+static const int kTileW = 128;
+static const int kTileH = 64;
+
+enum TileCmdKind {
+    TILE_FILL,         // solid rect
+    TILE_COPY,         // opaque copy from another surface
+    TILE_ELLIPSE_AA,   // RasterFillEllipseAA
+    TILE_TEXT,         // TextRunDraw
+    TILE_ADD,          // per-channel saturating add over a rect: one particle
+};
+
+struct TileCmd {
+    TileCmdKind kind;
+    RasterClip box;        // pixels it may touch, within the surface
+    uint32_t color;
+    float cx, cy, rx, ry;  // ellipse
+    int x, y;              // copy: where src's origin lands; text: origin
+    Surface src;           // copy
+    const void* ref;       // the TextRun, which must outlive TileRender
+};
+
+struct TileFrame {
+    Surface target;
+    int cols, rows;          // tiles across and down
+    TileCmd* cmds;
+    int count, capacity;
+    int32_t* binStart;       // tile t's commands are bins[binStart[t] .. binStart[t + 1])
+    int binCapacity;
+    int32_t* bins;
+    int refCapacity;
+    int grows;               // times storage grew; settles once the biggest frame is seen
+    uint32_t dropped;        // commands lost to a failed allocation
+};
+
+// Grows `p` to hold at least `need` items, doubling; false if out of memory.
+template <typename T>
+static inline bool TileReserve(TileFrame& f, T*& p, int& capacity, int need) {
+    if (need <= capacity) return true;
+    int grown = capacity ? capacity * 2 : 256;
+    if (grown < need) grown = need;
+    T* q = (T*)realloc(p, (size_t)grown * sizeof(T));
+    if (!q) return false;
+    p = q;
+    capacity = grown;
+    f.grows++;
+    return true;
+}
+
+static inline void TileFrameFree(TileFrame& f) {
+    free(f.cmds);
+    free(f.binStart);
+    free(f.bins);
+    memset(&f, 0, sizeof(f));
+}
+
+static inline void TileFrameBegin(TileFrame& f, const Surface& target) {
+    f.target = target;
+    f.cols = (target.w + kTileW - 1) / kTileW;
+    f.rows = (target.h + kTileH - 1) / kTileH;
+    f.count = 0;
+}
+
+static inline bool TileClipBox(const Surface& s, RasterClip& b) {
+    if (b.x0 < 0) b.x0 = 0;
+    if (b.y0 < 0) b.y0 = 0;
+    if (b.x1 > s.w) b.x1 = s.w;
+    if (b.y1 > s.h) b.y1 = s.h;
+    return b.x0 < b.x1 && b.y0 < b.y1;
+}
+
+// A new command covering `box`, or null if it covers nothing on the target.
+static inline TileCmd* TilePush(TileFrame& f, TileCmdKind kind, RasterClip box) {
+    if (!TileClipBox(f.target, box)) return nullptr;
+    if (!TileReserve(f, f.cmds, f.capacity, f.count + 1)) {
+        f.dropped++;
+        return nullptr;
+    }
+    TileCmd* c = &f.cmds[f.count++];
+    memset(c, 0, sizeof(*c));
+    c->kind = kind;
+    c->box = box;
+    return c;
+}
+
+// ---- Recording ----
+static inline void TileFill(TileFrame& f, int x0, int y0, int x1, int y1, uint32_t color) {
+    TileCmd* c = TilePush(f, TILE_FILL, RasterClip{ x0, y0, x1, y1 });
+    if (c) c->color = color;
+}
+
+// Target rect [x0, x1) x [y0, y1) from `src` placed with its origin at
+// (dx, dy); (0, 0) restores from a same-sized copy such as a background.
+static inline void TileCopy(TileFrame& f, const Surface& src, int dx, int dy, int x0, int y0, int x1, int y1) {
+    if (x0 < dx) x0 = dx;
+    if (y0 < dy) y0 = dy;
+    if (x1 > dx + src.w) x1 = dx + src.w;
+    if (y1 > dy + src.h) y1 = dy + src.h;
+    TileCmd* c = TilePush(f, TILE_COPY, RasterClip{ x0, y0, x1, y1 });
+    if (!c) return;
+    c->src = src;
+    c->x = dx;
+    c->y = dy;
+}
+
+static inline void TileEllipseAA(TileFrame& f, float cx, float cy, float rx, float ry, uint32_t color) {
+    if (!(rx > 0.0f) || !(ry > 0.0f)) return;
+    RasterClip b;
+    RasterEllipseAABounds(cx, cy, rx, ry, &b.x0, &b.y0, &b.x1, &b.y1);
+    TileCmd* c = TilePush(f, TILE_ELLIPSE_AA, b);
+    if (!c) return;
+    c->color = color;
+    c->cx = cx;
+    c->cy = cy;
+    c->rx = rx;
+    c->ry = ry;
+}
+
+static inline void TileText(TileFrame& f, const TextRun& run, int x, int y, uint32_t color) {
+    if (run.count == 0) return;
+    RasterClip b = { INT32_MAX, INT32_MAX, INT32_MIN, INT32_MIN };
+    for (int i = 0; i < run.count; i++) {
+        const FontRect& r = run.rects[i];
+        if (x + r.x0 < b.x0) b.x0 = x + r.x0;
+        if (y + r.y0 < b.y0) b.y0 = y + r.y0;
+        if (x + r.x1 > b.x1) b.x1 = x + r.x1;
+        if (y + r.y1 > b.y1) b.y1 = y + r.y1;
+    }
+    TileCmd* c = TilePush(f, TILE_TEXT, b);
+    if (!c) return;
+    c->ref = &run;
+    c->x = x;
+    c->y = y;
+    c->color = color;
+}
+
+// ParticleDraw as one command per particle, so each tile only visits the
+// particles on it. The pool is shaded and copied out now and can move on.
+static inline void TileParticles(TileFrame& f, ParticlePool& p, int size) {
+    if (!ParticleShade(p, f.target, size)) return;
+    for (int i = 0; i < p.count; i++) {
+        if (p.offset[i] < 0) continue;
+        const int x = (int)p.x[i], y = (int)p.y[i];
+        TileCmd* c = TilePush(f, TILE_ADD, RasterClip{ x, y, x + size, y + size });
+        if (c) c->color = p.shade[i];
+    }
+}
+
+// ---- Drawing ----
+// The part of command `c` inside `clip`.
+static inline void TileDrawCmd(const Surface& s, const TileCmd& c, const RasterClip& clip) {
+    RasterClip r = c.box;
+    if (r.x0 < clip.x0) r.x0 = clip.x0;
+    if (r.y0 < clip.y0) r.y0 = clip.y0;
+    if (r.x1 > clip.x1) r.x1 = clip.x1;
+    if (r.y1 > clip.y1) r.y1 = clip.y1;
+    if (r.x1 <= r.x0 || r.y1 <= r.y0) return;
+
+    switch (c.kind) {
+    case TILE_FILL:
+        RasterFillRect(s, r.x0, r.y0, r.x1, r.y1, c.color);
+        break;
+    case TILE_COPY:
+        for (int y = r.y0; y < r.y1; y++) {
+            memcpy(s.pixels + (size_t)y * s.stride + r.x0,
+                   c.src.pixels + (size_t)(y - c.y) * c.src.stride + (r.x0 - c.x), (size_t)(r.x1 - r.x0) * 4);
+        }
+        break;
+    case TILE_ELLIPSE_AA:
+        RasterFillEllipseAAClip(s, r, c.cx, c.cy, c.rx, c.ry, c.color);
+        break;
+    case TILE_TEXT: {
+        const TextRun& run = *(const TextRun*)c.ref;
+        for (int i = 0; i < run.count; i++) {
+            const FontRect& fr = run.rects[i];
+            int x0 = c.x + fr.x0, y0 = c.y + fr.y0, x1 = c.x + fr.x1, y1 = c.y + fr.y1;
+            if (x0 < r.x0) x0 = r.x0;
+            if (y0 < r.y0) y0 = r.y0;
+            if (x1 > r.x1) x1 = r.x1;
+            if (y1 > r.y1) y1 = r.y1;
+            RasterFillRect(s, x0, y0, x1, y1, c.color);
+        }
+        break;
+    }
+    case TILE_ADD:
+        for (int y = r.y0; y < r.y1; y++) {
+            uint32_t* row = s.pixels + (size_t)y * s.stride;
+            for (int x = r.x0; x < r.x1; x++) row[x] = ParticleAddSat(row[x], c.color);
+        }
+        break;
+    }
+}
+
+static inline void TileDrawTile(const TileFrame& f, int t) {
+    const int tx = t % f.cols, ty = t / f.cols;
+    RasterClip clip = { tx * kTileW, ty * kTileH, (tx + 1) * kTileW, (ty + 1) * kTileH };
+    if (clip.x1 > f.target.w) clip.x1 = f.target.w;
+    if (clip.y1 > f.target.h) clip.y1 = f.target.h;
+    for (int k = f.binStart[t]; k < f.binStart[t + 1]; k++) TileDrawCmd(f.target, f.cmds[f.bins[k]], clip);
+}
+
+// Every command in order over the whole target, on the calling thread: what
+// the tiles add up to, and the fallback when binning storage can't grow.
+static inline void TileDrawAll(const TileFrame& f) {
+    for (int i = 0; i < f.count; i++) TileDrawCmd(f.target, f.cmds[i], f.cmds[i].box);
+}
+
+// Counting sort of (tile, command) references by tile, commands in record
+// order within each tile. False if storage couldn't grow.
+static inline bool TileBin(TileFrame& f) {
+    const int tiles = f.cols * f.rows;
+    if (!TileReserve(f, f.binStart, f.binCapacity, tiles + 1)) return false;
+    memset(f.binStart, 0, (size_t)(tiles + 1) * 4);
+    int refs = 0;
+    for (int i = 0; i < f.count; i++) {
+        const RasterClip& b = f.cmds[i].box;
+        const int tx0 = b.x0 / kTileW, tx1 = (b.x1 - 1) / kTileW;
+        const int ty0 = b.y0 / kTileH, ty1 = (b.y1 - 1) / kTileH;
+        for (int ty = ty0; ty <= ty1; ty++) {
+            for (int tx = tx0; tx <= tx1; tx++) f.binStart[ty * f.cols + tx + 1]++;
+        }
+        refs += (tx1 - tx0 + 1) * (ty1 - ty0 + 1);
+    }
+    if (!TileReserve(f, f.bins, f.refCapacity, refs)) return false;
+    for (int t = 0; t < tiles; t++) f.binStart[t + 1] += f.binStart[t];
+    // binStart[t] doubles as tile t's write cursor, then is shifted back.
+    for (int i = 0; i < f.count; i++) {
+        const RasterClip& b = f.cmds[i].box;
+        const int tx0 = b.x0 / kTileW, tx1 = (b.x1 - 1) / kTileW;
+        const int ty0 = b.y0 / kTileH, ty1 = (b.y1 - 1) / kTileH;
+        for (int ty = ty0; ty <= ty1; ty++) {
+            for (int tx = tx0; tx <= tx1; tx++) f.bins[f.binStart[ty * f.cols + tx]++] = i;
+        }
+    }
+    for (int t = tiles; t > 0; t--) f.binStart[t] = f.binStart[t - 1];
+    f.binStart[0] = 0;
+    return true;
+}
+
+static inline void TileRunTiles(const TileFrame& f, std::atomic<int>& next) {
+    const int tiles = f.cols * f.rows;
+    for (int t; (t = next.fetch_add(1, std::memory_order_relaxed)) < tiles;) TileDrawTile(f, t);
+}
+
+// ---- Worker pool ----
+// `count` threads beside the one calling TileRender, started once by
+// TilePoolStart and asleep between frames. The games get CreateThread and
+// an auto-reset event per worker, like their other threads, so no C++
+// thread runtime is linked in; the headless tools get std::thread.
+#if defined(_WIN32)
+struct TilePool;
+
+struct TileWorkerSlot {
+    TilePool* pool;
+    HANDLE thread;
+    HANDLE wake;             // a frame (or quit) is waiting
+};
+
+struct TilePool {
+    TileWorkerSlot* slots;
+    int count;
+    HANDLE done;             // the last worker finished the frame
+    std::atomic<int> busy;   // workers still on this frame
+    std::atomic<bool> quit;
+    const TileFrame* frame;
+    std::atomic<int> next;   // next tile to draw
+};
+
+static DWORD WINAPI TileWorker(LPVOID param) {
+    TileWorkerSlot& slot = *(TileWorkerSlot*)param;
+    TilePool& p = *slot.pool;
+    for (;;) {
+        WaitForSingleObject(slot.wake, INFINITE);
+        if (p.quit.load()) return 0;
+        TileRunTiles(*p.frame, p.next);
+        if (p.busy.fetch_sub(1) == 1) SetEvent(p.done);
+    }
+}
+
+// Cores to render on, for `TilePoolStart(pool, TileDefaultThreads() - 1)`.
+static inline int TileDefaultThreads() {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    const int n = (int)info.dwNumberOfProcessors;
+    if (n < 1) return 1;
+    return n < 16 ? n : 16;
+}
+
+// Starts up to `workers` threads; fewer (down to none, when TileRender
+// draws alone) if the system runs out.
+static inline void TilePoolStart(TilePool& p, int workers) {
+    p.slots = nullptr;
+    p.count = 0;
+    p.done = NULL;
+    p.busy = 0;
+    p.quit = false;
+    p.frame = nullptr;
+    if (workers < 1) return;
+    p.done = CreateEventA(NULL, FALSE, FALSE, NULL);
+    p.slots = (TileWorkerSlot*)calloc((size_t)workers, sizeof(TileWorkerSlot));
+    if (!p.done || !p.slots) return;
+    for (int i = 0; i < workers; i++) {
+        TileWorkerSlot& slot = p.slots[p.count];
+        slot.pool = &p;
+        slot.wake = CreateEventA(NULL, FALSE, FALSE, NULL);
+        slot.thread = slot.wake ? CreateThread(NULL, 0, TileWorker, &slot, 0, NULL) : NULL;
+        if (!slot.thread) {
+            if (slot.wake) CloseHandle(slot.wake);
+            break;
+        }
+        p.count++;
+    }
+}
+
+static inline void TilePoolStop(TilePool& p) {
+    p.quit = true;
+    for (int i = 0; i < p.count; i++) SetEvent(p.slots[i].wake);
+    for (int i = 0; i < p.count; i++) {
+        WaitForSingleObject(p.slots[i].thread, INFINITE);
+        CloseHandle(p.slots[i].thread);
+        CloseHandle(p.slots[i].wake);
+    }
+    if (p.done) CloseHandle(p.done);
+    free(p.slots);
+    p.slots = nullptr;
+    p.done = NULL;
+    p.count = 0;
+}
+
+// Every tile of `f` drawn by the workers and the caller.
+static inline void TilePoolRun(TilePool& p, const TileFrame& f) {
+    p.frame = &f;
+    p.next.store(0, std::memory_order_relaxed);
+    p.busy.store(p.count);
+    for (int i = 0; i < p.count; i++) SetEvent(p.slots[i].wake);
+    TileRunTiles(f, p.next);
+    WaitForSingleObject(p.done, INFINITE);
+}
+#else
+struct TilePool {
+    std::thread* workers;
+    int count;
+    std::mutex lock;
+    std::condition_variable wake, idle;
+    uint64_t generation;     // bumped per frame
+    int busy;                // workers still on this frame
+    bool quit;
+    const TileFrame* frame;
+    std::atomic<int> next;   // next tile to draw
+};
+
+static inline void TileWorker(TilePool* p) {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> hold(p->lock);
+    for (;;) {
+        p->wake.wait(hold, [&] { return p->quit || p->generation != seen; });
+        if (p->quit) return;
+        seen = p->generation;
+        const TileFrame* f = p->frame;
+        hold.unlock();
+        TileRunTiles(*f, p->next);
+        hold.lock();
+        if (--p->busy == 0) p->idle.notify_one();
+    }
+}
+
+// Cores to render on, for `TilePoolStart(pool, TileDefaultThreads() - 1)`.
+static inline int TileDefaultThreads() {
+    const int n = (int)std::thread::hardware_concurrency();
+    if (n < 1) return 1;
+    return n < 16 ? n : 16;
+}
+
+static inline void TilePoolStart(TilePool& p, int workers) {
+    p.workers = nullptr;
+    p.count = 0;
+    p.generation = 0;
+    p.busy = 0;
+    p.quit = false;
+    p.frame = nullptr;
+    if (workers < 1) return;
+    p.workers = new std::thread[workers];
+    for (int i = 0; i < workers; i++) p.workers[i] = std::thread(TileWorker, &p);
+    p.count = workers;
+}
+
+static inline void TilePoolStop(TilePool& p) {
+    {
+        std::lock_guard<std::mutex> hold(p.lock);
+        p.quit = true;
+    }
+    p.wake.notify_all();
+    for (int i = 0; i < p.count; i++) p.workers[i].join();
+    delete[] p.workers;
+    p.workers = nullptr;
+    p.count = 0;
+}
+
+// Every tile of `f` drawn by the workers and the caller.
+static inline void TilePoolRun(TilePool& p, const TileFrame& f) {
+    {
+        std::lock_guard<std::mutex> hold(p.lock);
+        p.frame = &f;
+        p.next.store(0, std::memory_order_relaxed);
+        p.busy = p.count;
+        p.generation++;
+    }
+    p.wake.notify_all();
+    TileRunTiles(f, p.next);
+    std::unique_lock<std::mutex> hold(p.lock);
+    p.idle.wait(hold, [&] { return p.busy == 0; });
+}
+#endif
+
+// Draws the recorded frame. The caller takes tiles too, and returns once
+// every tile is done.
+static inline void TileRender(TileFrame& f, TilePool* pool) {
+    if (f.count == 0) return;
+    if (!TileBin(f)) {
+        TileDrawAll(f);
+        return;
+    }
+    if (!pool || pool->count == 0) {
+        for (int t = 0; t < f.cols * f.rows; t++) TileDrawTile(f, t);
+        return;
+    }
+    TilePoolRun(*pool, f);
+}
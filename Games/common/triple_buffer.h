@@ -0,0 +1,67 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+
+// ======================================================
+// Triple buffer: lock-free handoff of whole snapshots between one writer
+// thread and one reader thread
+//
+// Three slots: the writer fills its back slot, the reader holds its front
+// slot, and the third sits in the middle as the newest finished snapshot.
+// Publishing swaps back and middle; acquiring swaps middle and front. Each
+// swap is one atomic exchange, so neither side ever waits for the other,
+// the reader always gets the newest snapshot, and a slot is never written
+// while the reader holds it. Snapshots the reader was too slow for are
+// simply overwritten.
+//
+//   writer: T& s = TripleBufferBack(tb); ...fill s...; TripleBufferPublish(tb);
+//   reader: if (TripleBufferAcquire(tb)) use(TripleBufferFront(tb));
+// ======================================================
+
+enum { kTripleFresh = 4 };   // set in `middle` when it holds an unread snapshot
+
+template <typename T>
+struct TripleBuffer {
+    T slots[3];
+    std::atomic<uint32_t> middle;   // slot index | kTripleFresh
+    uint32_t back;                  // writer's slot
+    uint32_t front;                 // reader's slot
+};
+
+// Call before either thread starts. Every slot starts as a copy of `init`,
+// so the reader's front slot is valid before the first publish.
+template <typename T>
+static inline void TripleBufferInit(TripleBuffer<T>& tb, const T& init) {
+    for (T& s : tb.slots) s = init;
+    tb.back = 0;
+    tb.middle.store(1, std::memory_order_relaxed);
+    tb.front = 2;
+}
+
+// ---- Writer side ----
+template <typename T>
+static inline T& TripleBufferBack(TripleBuffer<T>& tb) {
+    return tb.slots[tb.back];
+}
+
+// Hands the back slot to the reader; the writer gets the old middle slot
+// (never the one the reader holds) to fill next.
+template <typename T>
+static inline void TripleBufferPublish(TripleBuffer<T>& tb) {
+    tb.back = tb.middle.exchange(tb.back | kTripleFresh, std::memory_order_acq_rel) & 3u;
+}
+
+// ---- Reader side ----
+// Takes the newest snapshot if one arrived since the last call; false
+// leaves the front slot as it was.
+template <typename T>
+static inline bool TripleBufferAcquire(TripleBuffer<T>& tb) {
+    if (!(tb.middle.load(std::memory_order_relaxed) & kTripleFresh)) return false;
+    tb.front = tb.middle.exchange(tb.front, std::memory_order_acq_rel) & 3u;
+    return true;
+}
+
+template <typename T>
+static inline const T& TripleBufferFront(const TripleBuffer<T>& tb) {
+    return tb.slots[tb.front];
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+// ======================================================
+// Non-blocking IPv4 UDP sockets on Winsock or BSD sockets
+//
+// Just enough for netplay: open a socket on a port, resolve a peer, send
+// datagrams, and poll for received ones without waiting. Windows builds
+// link ws2_32 (MinGW: -lws2_32).
+// ======================================================
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#if defined(_MSC_VER)
+#pragma comment(lib, "ws2_32.lib")
+#endif
+typedef SOCKET UdpSocket;
+static const UdpSocket kUdpInvalid = INVALID_SOCKET;
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int UdpSocket;
+static const UdpSocket kUdpInvalid = -1;
+#endif
+
+struct UdpAddr {
+    sockaddr_in sa;
+};
+
+static inline bool UdpStartup() {
+#if defined(_WIN32)
+    WSADATA wsa;
+    return WSAStartup(MAKEWORD(2, 2), &wsa) == 0;
+#else
+    return true;
+#endif
+}
+
+static inline void UdpCleanup() {
+#if defined(_WIN32)
+    WSACleanup();
+#endif
+}
+
+static inline void UdpClose(UdpSocket s) {
+    if (s == kUdpInvalid) return;
+#if defined(_WIN32)
+    closesocket(s);
+#else
+    close(s);
+#endif
+}
+
+// Non-blocking socket bound to `port` on all interfaces (0 = any free port).
+static inline UdpSocket UdpOpen(uint16_t port) {
+    UdpSocket s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s == kUdpInvalid) return kUdpInvalid;
+    sockaddr_in sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sin_family = AF_INET;
+    sa.sin_addr.s_addr = htonl(INADDR_ANY);
+    sa.sin_port = htons(port);
+#if defined(_WIN32)
+    u_long nonBlocking = 1;
+    bool ok = ioctlsocket(s, FIONBIO, &nonBlocking) == 0;
+#else
+    bool ok = fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK) == 0;
+#endif
+    if (!ok || bind(s, (const sockaddr*)&sa, sizeof(sa)) != 0) {
+        UdpClose(s);
+        return kUdpInvalid;
+    }
+    return s;
+}
+
+// Port the socket is bound to (useful after UdpOpen(0)).
+static inline uint16_t UdpLocalPort(UdpSocket s) {
+    sockaddr_in sa;
+    socklen_t len = sizeof(sa);
+    if (getsockname(s, (sockaddr*)&sa, &len) != 0) return 0;
+    return ntohs(sa.sin_port);
+}
+
+static inline bool UdpResolve(const char* host, uint16_t port, UdpAddr& out) {
+    addrinfo hints, *res = nullptr;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    if (getaddrinfo(host, nullptr, &hints, &res) != 0 || !res) return false;
+    memset(&out, 0, sizeof(out));
+    memcpy(&out.sa, res->ai_addr, sizeof(out.sa));
+    out.sa.sin_port = htons(port);
+    freeaddrinfo(res);
+    return true;
+}
+
+static inline bool UdpSameAddr(const UdpAddr& a, const UdpAddr& b) {
+    return a.sa.sin_addr.s_addr == b.sa.sin_addr.s_addr && a.sa.sin_port == b.sa.sin_port;
+}
+
+static inline bool UdpSend(UdpSocket s, const UdpAddr& to, const void* data, int size) {
+    return sendto(s, (const char*)data, size, 0, (const sockaddr*)&to.sa, sizeof(to.sa)) == size;
+}
+
+// One waiting datagram; its size, or 0 if none is waiting.
+static inline int UdpRecv(UdpSocket s, void* buf, int cap, UdpAddr* from) {
+    sockaddr_in sa;
+    socklen_t len = sizeof(sa);
+    int n = (int)recvfrom(s, (char*)buf, cap, 0, (sockaddr*)&sa, &len);
+    if (n <= 0) return 0;
+    if (from) from->sa = sa;
+    return n;
+}
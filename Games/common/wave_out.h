@@ -0,0 +1,111 @@
+#pragma once
+#include <windows.h>
+#include <mmsystem.h>
+#include <stdint.h>
+#include <atomic>
+
+#include "synth.h"
+
+// ======================================================
+// Synth output through waveOut, on its own thread
+//
+// A few short PCM buffers circulate between the driver and an audio
+// thread. The driver signals an event whenever it finishes one; the
+// thread refills every finished buffer with SynthRender and queues it
+// again. Buffers are allocated once, so the refill path only mixes.
+// Windows builds link winmm (MinGW: -lwinmm).
+// ======================================================
+
+#if defined(_MSC_VER)
+#pragma comment(lib, "winmm.lib")
+#endif
+
+enum {
+    kWaveBuffers = 3,
+    kWaveFrames = 512,      // 11.6 ms at 44.1 kHz; latency is about 2-3 of these
+};
+
+struct WaveOut {
+    HWAVEOUT dev;
+    WAVEHDR hdr[kWaveBuffers];
+    int16_t pcm[kWaveBuffers][kWaveFrames];
+    HANDLE done, thread;
+    std::atomic<bool> quit;
+    Synth* synth;
+};
+
+// Seconds on the QPC clock: the clock SynthPlay times must use.
+static inline double WaveNow() {
+    static LARGE_INTEGER freq;
+    if (!freq.QuadPart) QueryPerformanceFrequency(&freq);
+    LARGE_INTEGER t;
+    QueryPerformanceCounter(&t);
+    return (double)t.QuadPart / (double)freq.QuadPart;
+}
+
+static inline void WaveFill(WaveOut& w, WAVEHDR& h) {
+    // The other buffers are queued in front of this one.
+    const double ahead = (double)(kWaveBuffers - 1) * kWaveFrames / kSynthRate;
+    SynthRender(*w.synth, (int16_t*)h.lpData, kWaveFrames, WaveNow(), ahead);
+    h.dwFlags &= ~WHDR_DONE;
+    waveOutWrite(w.dev, &h, sizeof(h));
+}
+
+static DWORD WINAPI WaveThread(LPVOID param) {
+    WaveOut& w = *(WaveOut*)param;
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+    while (!w.quit.load()) {
+        WaitForSingleObject(w.done, 100);
+        for (WAVEHDR& h : w.hdr) {
+            if (h.dwFlags & WHDR_DONE) WaveFill(w, h);
+        }
+    }
+    return 0;
+}
+
+// Opens the default device and starts playing `synth`; false (and no
+// sound) if there is no device.
+static inline bool WaveOpen(WaveOut& w, Synth& synth) {
+    memset(w.hdr, 0, sizeof(w.hdr));
+    w.synth = &synth;
+    w.quit = false;
+    w.thread = NULL;
+    w.done = CreateEventA(NULL, FALSE, FALSE, NULL);
+    if (!w.done) return false;
+
+    WAVEFORMATEX fmt = {};
+    fmt.wFormatTag = WAVE_FORMAT_PCM;
+    fmt.nChannels = 1;
+    fmt.nSamplesPerSec = kSynthRate;
+    fmt.wBitsPerSample = 16;
+    fmt.nBlockAlign = 2;
+    fmt.nAvgBytesPerSec = kSynthRate * 2;
+    if (waveOutOpen(&w.dev, WAVE_MAPPER, &fmt, (DWORD_PTR)w.done, 0, CALLBACK_EVENT) != MMSYSERR_NOERROR) {
+        CloseHandle(w.done);
+        w.done = NULL;
+        return false;
+    }
+    for (int i = 0; i < kWaveBuffers; i++) {
+        WAVEHDR& h = w.hdr[i];
+        h.lpData = (LPSTR)w.pcm[i];
+        h.dwBufferLength = sizeof(w.pcm[i]);
+        waveOutPrepareHeader(w.dev, &h, sizeof(h));
+        WaveFill(w, h);
+    }
+    w.thread = CreateThread(NULL, 0, WaveThread, &w, 0, NULL);
+    return true;
+}
+
+static inline void WaveClose(WaveOut& w) {
+    if (!w.done) return;
+    w.quit = true;
+    if (w.thread) {
+        WaitForSingleObject(w.thread, INFINITE);
+        CloseHandle(w.thread);
+    }
+    waveOutReset(w.dev);
+    for (WAVEHDR& h : w.hdr) waveOutUnprepareHeader(w.dev, &h, sizeof(h));
+    waveOutClose(w.dev);
+    CloseHandle(w.done);
+    w.done = NULL;
+}
@@ -1,14 +1,37 @@
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
+#include <atomic>
+
+#include "pong_core.h"
+#include "pong_chaos.h"
+#include "pong_net.h"
+#include "pong_fx.h"
+#include "pong_sfx.h"
+#include "../common/raster.h"
+#include "../common/shapes_aa.h"
+#include "../common/cpu_meter.h"
+#include "../common/damage.h"
+#include "../common/font.h"
+#include "../common/input_queue.h"
+#include "../common/replay.h"
+#include "../common/scale.h"
+#include "../common/tiles.h"
+#include "../common/profiler.h"
+#include "../common/triple_buffer.h"
+#include "../common/udp.h"
+#include "../common/wave_out.h"
 
 
 // ======================================================
 // Backbuffer (DIBSection + Memory DC)  -> no flicker text
 // ======================================================
-static bool g_running = true;
+static std::atomic<bool> g_running(true);
+static HWND g_hwnd = NULL;
 
 static BITMAPINFO g_bmi{};
 static void* g_pixels = nullptr;
@@ -17,7 +40,30 @@ static int g_w = 0, g_h = 0;
 static HDC g_memDC = NULL;
 static HBITMAP g_dib = NULL;
 static HBITMAP g_oldBmp = NULL;
-static HFONT g_font = NULL;
+static Font g_font;                       // bitmap font atlas, built once
+
+static uint32_t* g_background = nullptr; // Clear + centre line at the current size
+static bool g_backgroundDirty = true;
+
+// -render-threads=N: redraws bigger than kTileMinArea pixels (resizes,
+// chaos mode, high-resolution windows) are recorded and rasterized in
+// tiles on N threads (tiles.h); smaller ones draw straight through. Below
+// kTileMinThreads the tiles' overhead eats the gain, so they stay off.
+static TilePool g_tilePool;
+static TileFrame g_tileFrame;
+static const int64_t kTileMinArea = 256 * 1024;
+static const int kTileMinThreads = 3;
+
+// -fixed: the game renders at a fixed logical size into g_pixels (plain
+// memory, allocated once) and every present scales the damage into the
+// window-sized DIB, letterboxed. Otherwise the DIB is the backbuffer.
+static bool g_fixed = false;
+static ScaleMode g_scaleMode = SCALE_INTEGER;
+static Scaler g_scaler;
+static void* g_viewPixels = nullptr;      // fixed mode: the DIB
+static int g_viewW = 0, g_viewH = 0;      // client area
+static int g_viewCapW = 0, g_viewCapH = 0; // fixed mode: DIB size, only ever grows
+static bool g_viewDirty = true;           // fixed mode: bars + whole frame on the next present
 
 static inline uint32_t RGBX(uint8_t r, uint8_t g, uint8_t b) {
     return (uint32_t)r | ((uint32_t)g << 8) | ((uint32_t)b << 16);
@@ -29,21 +75,21 @@ static void DestroyBackbuffer() {
             SelectObject(g_memDC, g_oldBmp);
             DeleteObject(g_dib);
             g_dib = NULL;
-            g_pixels = nullptr;
+            g_viewPixels = nullptr;
+            if (!g_fixed) g_pixels = nullptr;
         }
         DeleteDC(g_memDC);
         g_memDC = NULL;
     }
-    if (g_font) {
-        DeleteObject(g_font);
-        g_font = NULL;
+    if (g_fixed) {
+        NgAlignedFree(g_pixels);
+        g_pixels = nullptr;
+        ScalerFree(g_scaler);
     }
 }
 
-static void ResizeBackbuffer(HWND hwnd, int w, int h) {
-    g_w = (w > 0) ? w : 1;
-    g_h = (h > 0) ? h : 1;
-
+// Replaces the memory DC's DIB with a top-down w x h one.
+static void* CreateDib(HWND hwnd, int w, int h) {
     if (!g_memDC) {
         HDC hdc = GetDC(hwnd);
         g_memDC = CreateCompatibleDC(hdc);
@@ -54,48 +100,76 @@ static void ResizeBackbuffer(HWND hwnd, int w, int h) {
         SelectObject(g_memDC, g_oldBmp);
         DeleteObject(g_dib);
         g_dib = NULL;
-        g_pixels = nullptr;
     }
 
     g_bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-    g_bmi.bmiHeader.biWidth = g_w;
-    g_bmi.bmiHeader.biHeight = -g_h; // top-down
+    g_bmi.bmiHeader.biWidth = w;
+    g_bmi.bmiHeader.biHeight = -h; // top-down
     g_bmi.bmiHeader.biPlanes = 1;
     g_bmi.bmiHeader.biBitCount = 32;
     g_bmi.bmiHeader.biCompression = BI_RGB;
 
-    g_dib = CreateDIBSection(g_memDC, &g_bmi, DIB_RGB_COLORS, &g_pixels, NULL, 0);
+    void* bits = nullptr;
+    g_dib = CreateDIBSection(g_memDC, &g_bmi, DIB_RGB_COLORS, &bits, NULL, 0);
     g_oldBmp = (HBITMAP)SelectObject(g_memDC, g_dib);
+    return bits;
+}
+
+// Fixed mode: the logical backbuffer, before the window exists.
+static bool InitFixedBackbuffer(int w, int h) {
+    g_w = w;
+    g_h = h;
+    g_pixels = NgAlignedAlloc((size_t)w * h * 4, 64);
+    if (g_pixels) memset(g_pixels, 0, (size_t)w * h * 4); // WM_PAINT may scale it before the first frame
+    g_backgroundDirty = true;
+    if (!g_font.scale) FontInit(g_font, 2);
+    return g_pixels != nullptr;
+}
 
-    if (!g_font) {
-        g_font = CreateFontA(
-            18, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE,
-            ANSI_CHARSET, OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS,
-            CLEARTYPE_QUALITY, DEFAULT_PITCH | FF_DONTCARE,
-            "Segoe UI"
-        );
+// Fixed mode: a new window size only re-lays out the scaler. The DIB is
+// reallocated only to grow (in 256 px steps), never to shrink.
+static void ResizeView(HWND hwnd, int w, int h) {
+    if (w > g_viewCapW || h > g_viewCapH || !g_viewPixels) {
+        g_viewCapW = (w > g_viewCapW) ? (w + 255) & ~255 : g_viewCapW;
+        g_viewCapH = (h > g_viewCapH) ? (h + 255) & ~255 : g_viewCapH;
+        g_viewPixels = CreateDib(hwnd, g_viewCapW, g_viewCapH);
     }
+    if (!g_viewPixels || !ScalerInit(g_scaler, ScaleFit(g_w, g_h, w, h, g_scaleMode))) {
+        ScalerFree(g_scaler); // presents nothing rather than scaling with no tables
+    }
+    g_viewDirty = true;
 }
 
-static void Clear(uint32_t color) {
-    uint32_t* p = (uint32_t*)g_pixels;
-    for (int y = 0; y < g_h; y++) {
-        for (int x = 0; x < g_w; x++) {
-            p[y * g_w + x] = color;
-        }
+static void ResizeBackbuffer(HWND hwnd, int w, int h) {
+    g_viewW = (w > 0) ? w : 1;
+    g_viewH = (h > 0) ? h : 1;
+    if (g_fixed) {
+        ResizeView(hwnd, g_viewW, g_viewH);
+        return;
     }
+
+    g_w = g_viewW;
+    g_h = g_viewH;
+    g_pixels = CreateDib(hwnd, g_w, g_h);
+    g_backgroundDirty = true;
+
+    if (!g_font.scale) FontInit(g_font, 2);
 }
 
-static void FillRectI(int x0, int y0, int x1, int y1, uint32_t color) {
-    if (x0 < 0) x0 = 0; if (y0 < 0) y0 = 0;
-    if (x1 > g_w) x1 = g_w; if (y1 > g_h) y1 = g_h;
-    if (x1 <= x0 || y1 <= y0) return;
+static Surface Backbuffer() {
+    return Surface{ (uint32_t*)g_pixels, g_w, g_h, g_w };
+}
 
-    uint32_t* p = (uint32_t*)g_pixels;
-    for (int y = y0; y < y1; y++) {
-        uint32_t* row = p + y * g_w + x0;
-        for (int x = x0; x < x1; x++) *row++ = color;
-    }
+static Surface ViewSurface() {
+    return Surface{ (uint32_t*)g_viewPixels, g_viewW, g_viewH, g_viewCapW };
+}
+
+static void Clear(uint32_t color) {
+    RasterClear(Backbuffer(), color);
+}
+
+static void FillRectI(int x0, int y0, int x1, int y1, uint32_t color) {
+    RasterFillRect(Backbuffer(), x0, y0, x1, y1, color);
 }
 
 static void DrawCenterLine(uint32_t color) {
@@ -105,302 +179,923 @@ static void DrawCenterLine(uint32_t color) {
     }
 }
 
-static void DrawTextBB(int x, int y, const char* text, COLORREF color = RGB(240, 240, 240)) {
-    SetBkMode(g_memDC, TRANSPARENT);
-    SetTextColor(g_memDC, color);
-    HFONT old = (HFONT)SelectObject(g_memDC, g_font);
-    TextOutA(g_memDC, x, y, text, (int)lstrlenA(text));
-    SelectObject(g_memDC, old);
+// Text colours are COLORREFs (as GDI took them) and are written as real
+// 0x00RRGGBB pixels so they keep the colours the GDI text had.
+static inline uint32_t TextPixel(COLORREF c) {
+    return ((uint32_t)(c & 0xFF) << 16) | (c & 0xFF00) | ((c >> 16) & 0xFF);
 }
 
 // ======================================================
-// Input (simple key state + edge detection)
+// Input: timestamped key events (common/input_queue.h)
 // ======================================================
-static bool g_keyDown[256]{};
-static bool g_keyPressed[256]{};
+// The window procedure stamps each key change with QPC and queues it; each
+// tick takes the changes inside its span of real time, so presses land at
+// the point in the tick they happened and none are lost between frames.
+static InputQueue g_input;
+static uint16_t g_inputCarry = 0;   // presses a stalled netplay tick didn't use
+static HANDLE g_simWake = NULL;     // threaded mode: set on every key, wakes an idle simulation
+
+// Windows virtual keys -> PongKey bits consumed by UpdateGame
+static const struct { uint8_t vk; uint16_t key; } kKeyMap[] = {
+    { 'W', PONG_KEY_W }, { 'S', PONG_KEY_S },
+    { VK_UP, PONG_KEY_UP }, { VK_DOWN, PONG_KEY_DOWN },
+    { VK_SPACE, PONG_KEY_SPACE }, { VK_RETURN, PONG_KEY_RETURN },
+    { '1', PONG_KEY_1 }, { '2', PONG_KEY_2 }, { 'R', PONG_KEY_R },
+};
 
-static void BeginInputFrame() {
-    for (int i = 0; i < 256; i++) g_keyPressed[i] = false;
+static void PushKey(uint8_t vk, bool down) {
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    for (const auto& k : kKeyMap) {
+        if (k.vk == vk) InputPush(g_input, now.QuadPart, k.key, down);
+    }
+    if (g_simWake) SetEvent(g_simWake);
 }
-static void OnKeyDown(uint8_t vk) {
-    if (!g_keyDown[vk]) g_keyPressed[vk] = true;
-    g_keyDown[vk] = true;
+
+// The input for the tick covering [start, end) in QPC time.
+static PongInput TakeInput(LONGLONG start, LONGLONG end, LONGLONG now) {
+    InputTick t = InputTake(g_input, start, end, now);
+    PongInput in;
+    in.down = t.down;
+    in.pressed = (uint16_t)(t.pressed | g_inputCarry);
+    in.at = g_inputCarry ? 0 : t.at;
+    in.until = g_inputCarry ? 0 : t.until;
+    g_inputCarry = 0;
+    return in;
 }
-static void OnKeyUp(uint8_t vk) { g_keyDown[vk] = false; }
 
 // ======================================================
-// Pong game state
+// Pong game state (simulation lives in pong_core.h)
+// ======================================================
+static PongState g_game{};
+
+// ======================================================
+// Chaos mode (-chaos=N): N balls in play at once (pong_chaos.h)
 // ======================================================
-struct Paddle {
-    float x, y;      // center
-    float w, h;
-    float speed;
+static ChaosBalls g_chaos;
+static bool g_chaosMode = false;
+
+// ======================================================
+// Replay recording (-record=path): seed, tick rate and every tick's input
+// ======================================================
+static Replay g_replay;
+static bool g_recording = false;
+static char g_recordPath[MAX_PATH];
+
+static void StartRecording(uint32_t seed, int tickHz) {
+    ReplayBegin(g_replay, REPLAY_GAME_PONG, seed, (uint32_t)tickHz, g_game.w, g_game.h);
+    g_recording = true;
+}
+
+// Writes the replay out. Called at exit, and on resize since a replay has
+// one playfield size and a resize resets the game under it.
+static void StopRecording() {
+    if (!g_recording) return;
+    g_recording = false;
+    ReplayFinish(g_replay, PongHash(g_game));
+    if (!ReplaySave(g_replay, g_recordPath)) {
+        MessageBoxA(NULL, g_recordPath, "PONG: could not write replay", MB_OK | MB_ICONERROR);
+    }
+    ReplayFree(g_replay);
+}
+
+static void ResizeGame(int w, int h) {
+    StopRecording();
+    g_game.w = w;
+    g_game.h = h;
+    ResetGame(g_game);
+    if (g_chaosMode) {
+        ChaosResize(g_chaos, w, h);
+        ChaosServe(g_game, g_chaos);
+    }
+}
+
+// Blend positions between the last two ticks. Anything discontinuous
+// (serve, score, reset, resize, menu) snaps to the current tick.
+static PongState InterpolateState(const PongState& prev, const PongState& cur, float alpha) {
+    PongState view = cur;
+    if (prev.state != cur.state || prev.w != cur.w || prev.h != cur.h) return view;
+    view.left.y = prev.left.y + (cur.left.y - prev.left.y) * alpha;
+    view.right.y = prev.right.y + (cur.right.y - prev.right.y) * alpha;
+    if (prev.ball.inPlay == cur.ball.inPlay && prev.scoreL == cur.scoreL && prev.scoreR == cur.scoreR) {
+        view.ball.x = prev.ball.x + (cur.ball.x - prev.ball.x) * alpha;
+        view.ball.y = prev.ball.y + (cur.ball.y - prev.ball.y) * alpha;
+    }
+    return view;
+}
+
+// Netplay session (see NetOpen below); when started, g_game mirrors its state.
+enum NetMode { NETMODE_OFF = 0, NETMODE_HOST, NETMODE_JOIN };
+
+static NetMode g_netMode = NETMODE_OFF;
+static bool g_netStarted = false;
+static NetSession g_net;
+static UdpSocket g_sock = kUdpInvalid;
+static UdpAddr g_peer;
+static NetLagQueue g_netLag;
+static double g_netLastHello = -1.0, g_netLastRecv = 0.0;
+static uint32_t g_netSeed;         // the host's, sent in NET_WELCOME
+static char g_netText[128];
+
+// What the scene shows of the session, copied out so a render thread never
+// reads the session itself.
+struct NetHud {
+    bool active, started;
+    int side;
+    char text[128];
 };
 
-struct Ball {
-    float x, y;
-    float r;
-    float vx, vy;
-    bool inPlay;
+static NetHud CurrentNetHud() {
+    NetHud hud;
+    hud.active = g_netMode != NETMODE_OFF;
+    hud.started = g_netStarted;
+    hud.side = g_net.side;
+    memcpy(hud.text, g_netText, sizeof(hud.text));
+    return hud;
+}
+
+// ======================================================
+// Sound: procedural effects (pong_sfx.h) played through waveOut
+// ======================================================
+static Synth g_synth;
+static WaveOut g_wave;
+static bool g_sound = false;    // a device is open (and no -mute)
+
+// ======================================================
+// Effects: particle bursts (pong_fx.h), owned by whichever thread renders
+// ======================================================
+static ParticlePool g_fx;
+static PongState g_fxPrev;      // the state the last frame showed
+static bool g_fxHavePrev = false;
+static LONGLONG g_fxLast = 0;   // QPC time of the last frame
+
+// Emits for what changed since the last frame and moves the particles on
+// by the real time that passed.
+static void UpdateEffects(const PongState& s) {
+    if (!g_fx.capacity) return;
+    LARGE_INTEGER now, freq;
+    QueryPerformanceCounter(&now);
+    QueryPerformanceFrequency(&freq);
+    float dt = g_fxLast ? (float)((double)(now.QuadPart - g_fxLast) / (double)freq.QuadPart) : 0.0f;
+    if (dt > 0.1f) dt = 0.1f;
+    g_fxLast = now.QuadPart;
+    ParticleUpdate(g_fx, dt);
+    // In chaos mode balls score and bounce every frame; bursts would bury the court.
+    if (g_fxHavePrev && !g_chaosMode) PongEffects(g_fx, g_fxPrev, s);
+    g_fxPrev = s;
+    g_fxHavePrev = true;
+}
+
+// Particle squares grow with the window so bursts read the same at 4K.
+static int EffectSize() {
+    return 1 + g_h / 400;
+}
+
+// ======================================================
+// Scene + damage tracking: only restore, redraw and present what changed
+// ======================================================
+// Every drawable lives in a fixed slot (slot order = draw order). Comparing
+// slots with the previous frame yields the damage; damaged regions are
+// restored from a cached copy of the static background and only items that
+// touch the damage are redrawn.
+enum SceneSlot {
+    SLOT_LEFT, SLOT_RIGHT, SLOT_BALL, SLOT_BALLS, SLOT_FX, SLOT_HUD, SLOT_SCORE, SLOT_SERVE,
+    SLOT_TITLE, SLOT_OPT0, SLOT_OPT1, SLOT_HELP0, SLOT_HELP1, SLOT_NET,
+#if defined(NG_PROFILE)
+    SLOT_PROF0, SLOT_PROF1,
+#endif
+    SLOT_COUNT
 };
 
-enum AppState {
-    STATE_MENU = 0,
-    STATE_PLAYING = 1,
+enum SceneItemKind { ITEM_NONE = 0, ITEM_RECT, ITEM_CIRCLE, ITEM_BALLS, ITEM_PARTICLES, ITEM_TEXT };
+
+struct SceneItem {
+    SceneItemKind kind;
+    DamageRect rect;   // screen pixels the item can touch, clipped
+    uint32_t color;    // RGBX for rects and circles, COLORREF for text
+    int x, y;          // text origin
+    float cx, cy, r;   // circle, sub-pixel: any change moves its edge pixels
+    char text[128];
 };
 
-static Paddle g_left{}, g_right{};
-static Ball g_ball{};
-static int g_scoreL = 0, g_scoreR = 0;
-
-static AppState g_state = STATE_MENU;
-// 0 = 2 Players, 1 = Player vs Computer
-static int g_menuSelection = 0;
-
-// AI mode
-static bool g_aiMode = false;
-static float g_aiTargetY = 0.0f;
-static int g_aiMoveDelayFrames = 0;
-static int g_aiMoveFrameCounter = 0;
-static int g_aiCheckFrameCounter = 0;
-static int g_aiHitCount = 0;
-static int g_aiMaxMoveDelay = 10;
-static float g_aiCmdVelY = 0.0f;
-static float g_aiVelY = 0.0f;
-
-static float Clamp(float v, float lo, float hi) {
-    if (v < lo) return lo;
-    if (v > hi) return hi;
-    return v;
-}
-
-static void EnterStartMenu() {
-    g_state = STATE_MENU;
-    g_menuSelection = 0;
-    g_ball.inPlay = false;
-}
-
-static void ResetRound(bool serveToRight) {
-    g_ball.x = g_w * 0.5f;
-    g_ball.y = g_h * 0.5f;
-    g_ball.vx = serveToRight ? 320.0f : -320.0f;
-    g_ball.vy = (serveToRight ? 1.0f : -1.0f) * 120.0f;
-    g_ball.inPlay = false;
-    
-    // Reset AI movement delay when round starts
-    if (g_aiMode) {
-        g_aiMoveFrameCounter = 0;
-        g_aiCheckFrameCounter = 0;
-        g_aiCmdVelY = 0.0f;
-        g_aiVelY = 0.0f;
-        // Determine movement delay based on score difference
-        int scoreDiff = g_scoreL - g_scoreR;
-        if (scoreDiff >= 2) {
-            g_aiMaxMoveDelay = 2;
-        } else {
-            g_aiMaxMoveDelay = (rand() % 2 == 0) ? 6 : 12; // Either 6 or 12 frames
-        }
-        g_aiMoveDelayFrames = g_aiMaxMoveDelay;
-        g_aiTargetY = g_right.y;
-    }
-}
-
-static void ResetGame() {
-    g_scoreL = g_scoreR = 0;
-
-    g_left.w = 14;  g_left.h = 110; g_left.speed = 520.0f;
-    g_right.w = 14; g_right.h = 110; g_right.speed = 520.0f;
-
-    g_left.x = 40.0f;
-    g_right.x = (float)g_w - 40.0f;
-    g_left.y = g_right.y = g_h * 0.5f;
-
-    g_ball.r = 8.0f;
-    
-    // Reset AI state
-    g_aiHitCount = 0;
-    g_aiMoveFrameCounter = 0;
-    g_aiCheckFrameCounter = 0;
-    g_aiMoveDelayFrames = 10;
-    g_aiMaxMoveDelay = 10;
-    g_aiCmdVelY = 0.0f;
-    g_aiVelY = 0.0f;
-    
-    ResetRound(true);
-}
-
-static bool CircleAABB(float cx, float cy, float r, float rx0, float ry0, float rx1, float ry1) {
-    float closestX = Clamp(cx, rx0, rx1);
-    float closestY = Clamp(cy, ry0, ry1);
-    float dx = cx - closestX;
-    float dy = cy - closestY;
-    return (dx*dx + dy*dy) <= (r*r);
-}
-
-static void BounceFromPaddle(const Paddle& p, bool isLeft) {
-    float rel = (g_ball.y - p.y) / (p.h * 0.5f);
-    rel = Clamp(rel, -1.0f, 1.0f);
-
-    float baseSpeed = 240.0f;
-    float extra = 70.0f * fabsf(rel);
-
-    float dir = isLeft ? 1.0f : -1.0f;
-    g_ball.vx = dir * (baseSpeed + extra);
-    g_ball.vy = rel * 320.0f;
-
-    if (isLeft) g_ball.x = p.x + p.w * 0.5f + g_ball.r + 1.0f;
-    else        g_ball.x = p.x - p.w * 0.5f - g_ball.r - 1.0f;
-    
-    // Track AI hits for perfect response feature
-    if (g_aiMode && !isLeft) {
-        g_aiHitCount++;
-        g_aiMoveFrameCounter = 0;
-        g_aiCmdVelY = 0.0f;
-        g_aiVelY = 0.0f;
-        
-        // Every 7th hit gets perfect response (no movement delay)
-        if (g_aiHitCount % 7 == 0) {
-            g_aiMoveDelayFrames = 0;
-        } else {
-            // Adaptive movement delay based on score
-            int scoreDiff = g_scoreL - g_scoreR;
-            if (scoreDiff >= 2) {
-                g_aiMaxMoveDelay = 2;
-            } else {
-                g_aiMaxMoveDelay = (rand() % 2 == 0) ? 6 : 12; // Either 6 or 12 frames
-            }
-            g_aiMoveDelayFrames = g_aiMaxMoveDelay;
+struct DamageStats {
+    int64_t restored, drawn, presented;
+    int frames;
+};
+
+static SceneItem g_prevScene[SLOT_COUNT];
+static TextRun g_textRuns[SLOT_COUNT];   // laid-out glyphs of each text slot
+static DamageList g_damage;
+static DamageStats g_damageStats;
+
+static bool SameItem(const SceneItem& a, const SceneItem& b) {
+    if (a.kind != b.kind) return false;
+    if (a.kind == ITEM_NONE) return true;
+    if (a.kind == ITEM_PARTICLES || a.kind == ITEM_BALLS) return false;   // they move every frame
+    return a.color == b.color && a.rect.x0 == b.rect.x0 && a.rect.y0 == b.rect.y0 &&
+           a.rect.x1 == b.rect.x1 && a.rect.y1 == b.rect.y1 &&
+           (a.kind != ITEM_CIRCLE || (a.cx == b.cx && a.cy == b.cy && a.r == b.r)) &&
+           (a.kind != ITEM_TEXT || strcmp(a.text, b.text) == 0);
+}
+
+static DamageRect ClipToScreen(DamageRect r) {
+    if (r.x0 < 0) r.x0 = 0;
+    if (r.y0 < 0) r.y0 = 0;
+    if (r.x1 > g_w) r.x1 = g_w;
+    if (r.y1 > g_h) r.y1 = g_h;
+    return r;
+}
+
+static void SetRectItem(SceneItem& it, int x0, int y0, int x1, int y1, uint32_t color) {
+    DamageRect r = ClipToScreen(DamageRect{ x0, y0, x1, y1 });
+    if (DamageEmpty(r)) return;
+    it.kind = ITEM_RECT;
+    it.rect = r;
+    it.color = color;
+}
+
+// Anti-aliased; its rect is every pixel the edge ramp can reach.
+static void SetCircleItem(SceneItem& it, float cx, float cy, float r, uint32_t color) {
+    DamageRect b;
+    RasterEllipseAABounds(cx, cy, r, r, &b.x0, &b.y0, &b.x1, &b.y1);
+    b = ClipToScreen(b);
+    if (DamageEmpty(b) || !(r > 0.0f)) return;
+    it.kind = ITEM_CIRCLE;
+    it.rect = b;
+    it.color = color;
+    it.cx = cx;
+    it.cy = cy;
+    it.r = r;
+}
+
+static void SetTextItem(SceneItem* scene, int slot, int x, int y, const char* text, COLORREF color = RGB(240, 240, 240)) {
+    SceneItem& it = scene[slot];
+    it.kind = ITEM_TEXT;
+    it.x = x;
+    it.y = y;
+    it.color = color;
+    lstrcpynA(it.text, text, (int)sizeof(it.text));
+
+    // The slot's run is only laid out again when its string changes.
+    TextRun& run = g_textRuns[slot];
+    TextRunSet(run, g_font, it.text);
+    it.rect = ClipToScreen(DamageRect{ x, y, x + run.w, y + run.h });
+    if (DamageEmpty(it.rect)) it.kind = ITEM_NONE;
+}
+
+#if defined(NG_PROFILE)
+// Profiler overlay (F2), refreshed with the title-bar stats; F3 or
+// -profile-csv=path write the frame samples out.
+static char g_profText[2][64];
+static char g_profCsvPath[MAX_PATH] = "pong_profile.csv";
+
+static void RefreshProfileOverlay() {
+    ProfStats st = ProfComputeStats(1024);
+    ProfFormatStats(st, g_profText[0], g_profText[1], (int)sizeof(g_profText[0]));
+}
+#endif
+
+static void BuildScene(const PongState& s, const NetHud& net, SceneItem* scene) {
+    memset(scene, 0, sizeof(SceneItem) * SLOT_COUNT);
+
+#if defined(NG_PROFILE)
+    if (g_prof.overlay) {
+        int y = g_h - 2 * (g_font.lineH + 4) - 8;
+        SetTextItem(scene, SLOT_PROF0, 12, y, g_profText[0], RGB(255, 235, 150));
+        SetTextItem(scene, SLOT_PROF1, 12, y + g_font.lineH + 4, g_profText[1], RGB(255, 235, 150));
+    }
+#endif
+
+    if (net.active) {
+        if (!net.started) {
+            SetTextItem(scene, SLOT_TITLE, g_w / 2 - 30, g_h / 2 - 90, "PONG");
+            SetTextItem(scene, SLOT_NET, g_w / 2 - 120, g_h / 2 - 45, net.text);
+            SetTextItem(scene, SLOT_HELP1, g_w / 2 - 120, g_h / 2 - 20, "ESC = Quit");
+            return;
+        }
+        SetTextItem(scene, SLOT_NET, 12, g_h - g_font.lineH - 10, net.text, RGB(150, 150, 170));
+    }
+
+    if (s.state == STATE_MENU) {
+        const int cx = g_w / 2;
+        const int top = g_h / 2 - 90;
+        COLORREF normal = RGB(240, 240, 240);
+        COLORREF hi = RGB(255, 235, 150);
+
+        SetTextItem(scene, SLOT_TITLE, cx - 30, top, "PONG");
+        SetTextItem(scene, SLOT_OPT0, cx - 120, top + 45, "1) 2 Players", (s.menuSelection == 0) ? hi : normal);
+        SetTextItem(scene, SLOT_OPT1, cx - 120, top + 70, "2) Player vs Computer", (s.menuSelection == 1) ? hi : normal);
+        SetTextItem(scene, SLOT_HELP0, cx - 120, top + 110, "Use Up/Down then Enter (or press 1/2)");
+        SetTextItem(scene, SLOT_HELP1, cx - 120, top + 130, "ESC = Quit");
+        return;
+    }
+
+    uint32_t paddleC = RGBX(15, 232, 73);
+    SetRectItem(scene[SLOT_LEFT], (int)(s.left.x - s.left.w * 0.5f), (int)(s.left.y - s.left.h * 0.5f),
+                (int)(s.left.x + s.left.w * 0.5f), (int)(s.left.y + s.left.h * 0.5f), paddleC);
+    SetRectItem(scene[SLOT_RIGHT], (int)(s.right.x - s.right.w * 0.5f), (int)(s.right.y - s.right.h * 0.5f),
+                (int)(s.right.x + s.right.w * 0.5f), (int)(s.right.y + s.right.h * 0.5f), paddleC);
+
+    uint32_t ballC = RGBX(252, 186, 4);
+    if (g_chaosMode) {
+        // Thousands of small moving circles: cheaper to redraw the court
+        // than to track a rect per ball.
+        scene[SLOT_BALLS].kind = ITEM_BALLS;
+        scene[SLOT_BALLS].rect = DamageRect{ 0, 0, g_w, g_h };
+        scene[SLOT_BALLS].color = ballC;
+    } else {
+        SetCircleItem(scene[SLOT_BALL], s.ball.x, s.ball.y, s.ball.r, ballC);
+    }
+
+    DamageRect fx;
+    if (ParticleBounds(g_fx, EffectSize(), &fx.x0, &fx.y0, &fx.x1, &fx.y1)) {
+        fx = ClipToScreen(fx);
+        if (!DamageEmpty(fx)) {
+            scene[SLOT_FX].kind = ITEM_PARTICLES;
+            scene[SLOT_FX].rect = fx;
         }
-        g_aiTargetY = g_right.y;
+    }
+
+    // Controls and mode never change mid-game; the score gets its own run
+    // on the line below so a point only redraws those few glyphs.
+    const char* hud = s.aiMode
+        ? "W/S (Left)   Up/Down (Right)   Space=Serve   R=Reset   Mode: vs Computer"
+        : "W/S (Left)   Up/Down (Right)   Space=Serve   R=Reset   Mode: 2 Players";
+    if (net.started) {
+        hud = (net.side == 0) ? "You: Left paddle   W/S or Up/Down   Space=Serve   Mode: Netplay"
+                              : "You: Right paddle   W/S or Up/Down   Space=Serve   Mode: Netplay";
+    }
+    SetTextItem(scene, SLOT_HUD, 12, 10, hud);
+    char score[32];
+    wsprintfA(score, "Score: %d - %d", s.scoreL, s.scoreR);
+    SetTextItem(scene, SLOT_SCORE, 12, 10 + g_font.lineH + 4, score);
+
+    if (!s.ball.inPlay && !g_chaosMode) {
+        SetTextItem(scene, SLOT_SERVE, g_w / 2 - 60, g_h / 2 - 10, "Press SPACE to serve");
     }
 }
 
-static void UpdateGame(float dt) {
-    if (g_keyPressed[VK_ESCAPE]) g_running = false;
-    if (g_keyPressed['R']) ResetGame();
+static void DrawItem(const SceneItem& it, int slot) {
+    if (it.kind == ITEM_RECT) {
+        FillRectI(it.rect.x0, it.rect.y0, it.rect.x1, it.rect.y1, it.color);
+    } else if (it.kind == ITEM_CIRCLE) {
+        RasterFillCircleAA(Backbuffer(), it.cx, it.cy, it.r, it.color);
+    } else if (it.kind == ITEM_BALLS) {
+        const Surface s = Backbuffer();
+        for (int i = 0; i < g_chaos.count; i++) RasterFillCircleAA(s, g_chaos.x[i], g_chaos.y[i], g_chaos.r, it.color);
+    } else if (it.kind == ITEM_PARTICLES) {
+        ParticleDraw(g_fx, Backbuffer(), EffectSize());
+    } else if (it.kind == ITEM_TEXT) {
+        TextRunDraw(Backbuffer(), g_textRuns[slot], it.x, it.y, TextPixel(it.color));
+    }
+}
 
-    // Start menu: choose mode before playing
-    if (g_state == STATE_MENU) {
-        if (g_keyPressed[VK_UP] || g_keyPressed['W']) g_menuSelection--;
-        if (g_keyPressed[VK_DOWN] || g_keyPressed['S']) g_menuSelection++;
-        g_menuSelection = (int)Clamp((float)g_menuSelection, 0.0f, 1.0f);
+// DrawItem, recorded for the tiles.
+static void RecordItem(TileFrame& f, const SceneItem& it, int slot) {
+    if (it.kind == ITEM_RECT) {
+        TileFill(f, it.rect.x0, it.rect.y0, it.rect.x1, it.rect.y1, it.color);
+    } else if (it.kind == ITEM_CIRCLE) {
+        TileEllipseAA(f, it.cx, it.cy, it.r, it.r, it.color);
+    } else if (it.kind == ITEM_BALLS) {
+        for (int i = 0; i < g_chaos.count; i++) TileEllipseAA(f, g_chaos.x[i], g_chaos.y[i], g_chaos.r, g_chaos.r, it.color);
+    } else if (it.kind == ITEM_PARTICLES) {
+        TileParticles(f, g_fx, EffectSize());
+    } else if (it.kind == ITEM_TEXT) {
+        TileText(f, g_textRuns[slot], it.x, it.y, TextPixel(it.color));
+    }
+}
+
+static void RebuildBackground() {
+    free(g_background);
+    g_background = (uint32_t*)malloc((size_t)g_w * g_h * 4);
+    Clear(RGBX(30, 30, 40));
+    DrawCenterLine(RGBX(80, 80, 95));
+    if (g_background) memcpy(g_background, g_pixels, (size_t)g_w * g_h * 4);
+}
 
-        if (g_keyPressed['1']) g_menuSelection = 0;
-        if (g_keyPressed['2']) g_menuSelection = 1;
+static void RenderGame(const PongState& s, const NetHud& net) {
+    UpdateEffects(s);
+    SceneItem scene[SLOT_COUNT];
+    BuildScene(s, net, scene);
 
-        if (g_keyPressed[VK_RETURN] || g_keyPressed[VK_SPACE] || g_keyPressed['1'] || g_keyPressed['2']) {
-            g_aiMode = (g_menuSelection == 1);
-            ResetGame();
-            g_state = STATE_PLAYING;
+    DamageReset(g_damage, g_w, g_h);
+    if (g_backgroundDirty || !g_background) {
+        RebuildBackground();
+        g_backgroundDirty = false;
+        DamageAddAll(g_damage);
+    } else {
+        for (int i = 0; i < SLOT_COUNT; i++) {
+            if (SameItem(g_prevScene[i], scene[i])) continue;
+            if (g_prevScene[i].kind != ITEM_NONE) DamageAdd(g_damage, g_prevScene[i].rect);
+            if (scene[i].kind != ITEM_NONE) DamageAdd(g_damage, scene[i].rect);
         }
-        return;
     }
 
-    // Left paddle (always human controlled)
-    float dyL = 0.0f;
-    if (g_keyDown['W']) dyL -= g_left.speed * dt;
-    if (g_keyDown['S']) dyL += g_left.speed * dt;
-    g_left.y = Clamp(g_left.y + dyL, g_left.h * 0.5f, g_h - g_left.h * 0.5f);
-
-    // Right paddle (human or AI)
-    float dyR = 0.0f;
-    if (g_aiMode) {
-        // AI updates its perceived ball height only every 24 frames (reaction sampling)
-        if (g_ball.inPlay && g_ball.vx > 0) { // Ball moving towards AI
-            g_aiCheckFrameCounter++;
-            if (g_aiCheckFrameCounter >= 24) {
-                g_aiTargetY = g_ball.y;
-                g_aiCheckFrameCounter = 0;
+    // Redrawing an item that touches the damage repaints all of it, which
+    // can cover items drawn earlier, so grow the damage to whole items
+    // until it stops changing.
+    bool redraw[SLOT_COUNT] = {};
+    for (bool grew = true; grew;) {
+        grew = false;
+        for (int i = 0; i < SLOT_COUNT; i++) {
+            if (scene[i].kind == ITEM_NONE || redraw[i] || !DamageTouches(g_damage, scene[i].rect)) continue;
+            redraw[i] = true;
+            if (!DamageCovers(g_damage, scene[i].rect)) {
+                DamageAdd(g_damage, scene[i].rect);
+                grew = true;
             }
         }
+    }
 
-        // Smooth movement: update a commanded velocity every N frames, then ease actual velocity toward it.
-        g_aiMoveFrameCounter++;
-        const int delay = (g_aiMoveDelayFrames < 0) ? 0 : g_aiMoveDelayFrames;
-        if (delay == 0 || g_aiMoveFrameCounter >= delay) {
-            float diff = g_aiTargetY - g_right.y;
-            const float deadZonePx = 2.0f;
-            const float kp = 8.0f; // px -> px/sec
-            if (fabsf(diff) <= deadZonePx) {
-                g_aiCmdVelY = 0.0f;
+    const int64_t area = DamageArea(g_damage);
+    g_damageStats.restored += area;
+    if (g_tilePool.count > 0 && g_background && area >= kTileMinArea) {
+        const Surface background = { g_background, g_w, g_h, g_w };
+        TileFrameBegin(g_tileFrame, Backbuffer());
+        for (int i = 0; i < g_damage.count; i++) {
+            const DamageRect& r = g_damage.rects[i];
+            TileCopy(g_tileFrame, background, 0, 0, r.x0, r.y0, r.x1, r.y1);
+        }
+        for (int i = 0; i < SLOT_COUNT; i++) {
+            if (!redraw[i]) continue;
+            RecordItem(g_tileFrame, scene[i], i);
+            g_damageStats.drawn += DamageRectArea(scene[i].rect);
+        }
+        TileRender(g_tileFrame, &g_tilePool);
+    } else {
+        if (g_background) DamageRestore(g_damage, (uint32_t*)g_pixels, g_background, g_w);
+        for (int i = 0; i < SLOT_COUNT; i++) {
+            if (!redraw[i]) continue;
+            DrawItem(scene[i], i);
+            g_damageStats.drawn += DamageRectArea(scene[i].rect);
+        }
+    }
+    memcpy(g_prevScene, scene, sizeof(scene));
+}
+
+// Fixed mode: scales just the window pixels the damage maps to (the whole
+// frame and the bars after a resize or repaint) and blits those.
+static void PresentScaled(HDC hdc) {
+    const Surface view = ViewSurface();
+    const ScaleLayout& l = g_scaler.layout;
+    const NgSimdLevel level = NgDetectSimd();
+    if (!g_viewPixels) return;
+    if (g_viewDirty) {
+        ScaleFillBars(view, l, RGBX(0, 0, 0));
+        ScalerRun(g_scaler, Backbuffer(), view, DamageRect{ 0, 0, g_viewW, g_viewH }, level);
+        BitBlt(hdc, 0, 0, g_viewW, g_viewH, g_memDC, 0, 0, SRCCOPY);
+        g_viewDirty = false;
+        return;
+    }
+    for (int i = 0; i < g_damage.count; i++) {
+        DamageRect r = ScalerRun(g_scaler, Backbuffer(), view, ScaleMapRect(l, g_damage.rects[i]), level);
+        if (!DamageEmpty(r)) BitBlt(hdc, r.x0, r.y0, r.x1 - r.x0, r.y1 - r.y0, g_memDC, r.x0, r.y0, SRCCOPY);
+    }
+}
+
+static void PresentDamage(HWND hwnd) {
+    HDC hdc = GetDC(hwnd);
+    if (g_fixed) {
+        PresentScaled(hdc);
+    } else {
+        for (int i = 0; i < g_damage.count; i++) {
+            const DamageRect& r = g_damage.rects[i];
+            BitBlt(hdc, r.x0, r.y0, r.x1 - r.x0, r.y1 - r.y0, g_memDC, r.x0, r.y0, SRCCOPY);
+        }
+    }
+    ReleaseDC(hwnd, hdc);
+    g_damageStats.presented += DamageArea(g_damage);
+    g_damageStats.frames++;
+}
+
+// Reports average pixels touched per frame in the title bar, against the
+// 2 * w * h a full clear + full blit would cost.
+static void ReportDamageStats(HWND hwnd) {
+    if (g_damageStats.frames == 0) return;
+    const DamageStats& st = g_damageStats;
+    int64_t fill = (st.restored + st.drawn) / st.frames;
+    int64_t blit = st.presented / st.frames;
+    int64_t full = 2 * (int64_t)g_w * g_h;
+    char title[256];
+    int n = wsprintfA(title, "PONG (GDI, single-file, no flicker)  |  fill %d px/frame, blit %d px/frame (%d%% of full redraw)",
+                      (int)fill, (int)blit, full ? (int)((fill + blit) * 100 / full) : 0);
+    static CpuMeter cpu;
+    static double cpuPerMin = -1.0;
+    if (!cpu.wall) CpuMeterInit(cpu);
+    CpuMeterTake(cpu, 2000, &cpuPerMin);
+    if (cpuPerMin >= 0.0) n += snprintf(title + n, sizeof(title) - n, "  |  cpu %.1f s/min", cpuPerMin);
+    double avgMs, maxMs;
+    if (InputTakeLatency(g_input, &avgMs, &maxMs)) {
+        n += snprintf(title + n, sizeof(title) - n, "  |  input %.1f ms (max %.1f)", avgMs, maxMs);
+    }
+    if (g_sound && SynthTakeLatency(g_synth, &avgMs, &maxMs)) {
+        wsprintfA(title + n, "  |  sound %d ms (max %d)", (int)(avgMs + 0.5), (int)(maxMs + 0.5));
+    }
+    SetWindowTextA(hwnd, title);
+    g_damageStats = DamageStats{};
+}
+
+// ======================================================
+// Timing: fixed simulation tick + frame pacing
+// ======================================================
+enum PaceMode {
+    PACE_PRECISE = 0, // waitable timer for the bulk, spin the last stretch
+    PACE_OFF = 1,     // render as fast as possible
+};
+
+static int g_tickHz = 120;
+static PaceMode g_paceMode = PACE_PRECISE;
+static const DWORD kIdleWaitMs = 250;   // at rest: longest sleep between stats refreshes
+static LARGE_INTEGER g_qpcFreq;
+static HANDLE g_paceTimer = NULL;
+
+static int ArgInt(const char* cmd, const char* key, int def) {
+    const char* p = cmd ? strstr(cmd, key) : nullptr;
+    return p ? atoi(p + strlen(key)) : def;
+}
+
+// Copies the value after `key` up to the next space (or between quotes);
+// false if absent.
+static bool ArgStr(const char* cmd, const char* key, char* out, int size) {
+    const char* p = cmd ? strstr(cmd, key) : nullptr;
+    if (!p || size < 1) return false;
+    p += strlen(key);
+    char end = ' ';
+    if (*p == '"') { end = '"'; p++; }
+    int n = 0;
+    while (p[n] && p[n] != end && n < size - 1) { out[n] = p[n]; n++; }
+    out[n] = 0;
+    return n > 0;
+}
+
+static double Seconds(LONGLONG ticks) {
+    return (double)ticks / (double)g_qpcFreq.QuadPart;
+}
+
+static int DisplayRefreshHz() {
+    DEVMODEA dm{};
+    dm.dmSize = sizeof(dm);
+    if (EnumDisplaySettingsA(NULL, ENUM_CURRENT_SETTINGS, &dm) && dm.dmDisplayFrequency > 1) {
+        return (int)dm.dmDisplayFrequency;
+    }
+    return 60;
+}
+
+// Dispatches waiting key messages, so they are stamped when they arrive
+// rather than at the next frame's message pump.
+static void PumpKeys() {
+    MSG msg;
+    while (PeekMessage(&msg, NULL, WM_KEYFIRST, WM_KEYLAST, PM_REMOVE)) {
+        TranslateMessage(&msg);
+        DispatchMessage(&msg);
+    }
+}
+
+// Sleeps until `deadline` (QPC ticks). Sleep() alone overshoots by up to a
+// scheduler quantum, so coarse waiting stops ~1 ms early and spins the rest.
+// Keys arriving meanwhile wake the wait and are handled on the spot (only
+// the window's thread ever has any).
+static void WaitUntil(LONGLONG deadline, HANDLE timer) {
+    for (;;) {
+        if (HIWORD(GetQueueStatus(QS_KEY))) PumpKeys();
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        double remaining = Seconds(deadline - now.QuadPart);
+        if (remaining <= 0.0) return;
+        if (remaining > 0.002) {
+            if (timer) {
+                LARGE_INTEGER due;
+                due.QuadPart = -(LONGLONG)((remaining - 0.001) * 1e7); // relative, 100 ns units
+                SetWaitableTimer(timer, &due, 0, NULL, NULL, FALSE);
+                MsgWaitForMultipleObjects(1, &timer, FALSE, INFINITE, QS_KEY);
             } else {
-                g_aiCmdVelY = Clamp(diff * kp, -g_right.speed, g_right.speed);
+                MsgWaitForMultipleObjects(0, NULL, FALSE, 1, QS_KEY);
             }
-            g_aiMoveFrameCounter = 0;
         }
+    }
+}
+
+// ======================================================
+// Netplay (-host=PORT / -join=HOST:PORT): versus over UDP with rollback
+// ======================================================
+// The host plays the left paddle and the client the right; either key set
+// moves your own paddle. The host answers the first HELLO with its seed,
+// tick rate and playfield size, and both then run a NetSession (pong_net.h)
+// whose state is what gets drawn. -netlag=ms, -netjitter=ms and
+// -netloss=percent delay and drop outgoing packets for testing.
+
+// Opens the socket for -host=PORT or -join=HOST:PORT; false (after telling
+// the user) if that fails.
+static bool NetOpen(const char* cmdLine) {
+    char arg[128];
+    uint16_t port = 0;
+    if (ArgStr(cmdLine, "-host=", arg, (int)sizeof(arg))) {
+        g_netMode = NETMODE_HOST;
+        port = (uint16_t)atoi(arg);
+    } else if (ArgStr(cmdLine, "-join=", arg, (int)sizeof(arg))) {
+        g_netMode = NETMODE_JOIN;
+    } else {
+        return true;
+    }
+    if (!UdpStartup()) {
+        MessageBoxA(NULL, "Winsock is not available", "PONG: netplay", MB_OK | MB_ICONERROR);
+        return false;
+    }
+    if (g_netMode == NETMODE_JOIN) {
+        char* colon = strrchr(arg, ':');
+        if (colon) *colon = 0;
+        if (!colon || !UdpResolve(arg, (uint16_t)atoi(colon + 1), g_peer)) {
+            MessageBoxA(NULL, "Use -join=HOST:PORT", "PONG: cannot reach host", MB_OK | MB_ICONERROR);
+            return false;
+        }
+    }
+    g_sock = UdpOpen(port);
+    if (g_sock == kUdpInvalid) {
+        MessageBoxA(NULL, "Could not open the UDP port", "PONG: netplay", MB_OK | MB_ICONERROR);
+        return false;
+    }
+    LARGE_INTEGER clock;
+    QueryPerformanceCounter(&clock);
+    NetLagInit(g_netLag, ArgInt(cmdLine, "-netlag=", 0) * 1e-3, ArgInt(cmdLine, "-netjitter=", 0) * 1e-3,
+               ArgInt(cmdLine, "-netloss=", 0) * 0.01f, (uint64_t)clock.QuadPart);
+    if (g_netMode == NETMODE_HOST) {
+        wsprintfA(g_netText, "Waiting for a player on port %d...", (int)port);
+    } else {
+        wsprintfA(g_netText, "Connecting to %s...", arg);
+    }
+    return true;
+}
 
-        // Ease actual velocity toward command (prevents jitter when diff sign flips)
-        const float accel = 3200.0f; // px/sec^2
-        float dv = g_aiCmdVelY - g_aiVelY;
-        float maxDv = accel * dt;
-        g_aiVelY += Clamp(dv, -maxDv, +maxDv);
+static void NetClose() {
+    if (g_netMode == NETMODE_OFF) return;
+    UdpClose(g_sock);
+    UdpCleanup();
+}
 
-        dyR = g_aiVelY * dt;
+// Sends through the lag injector; anything due goes out now.
+static void NetSend(const uint8_t* data, int size, double now) {
+    NetLagPush(g_netLag, data, size, now);
+    uint8_t out[kNetPacketMax];
+    while (int n = NetLagPop(g_netLag, now, out)) UdpSend(g_sock, g_peer, out, n);
+}
+
+static void NetStart(int side, const NetWelcome& wel) {
+    g_tickHz = (int)wel.tickHz;
+    NetInit(g_net, side, wel.seed, wel.w, wel.h, wel.tickHz);
+    g_game = g_net.state;
+    g_netStarted = true;
+}
 
-        // Prevent overshoot: if we're about to cross the target, snap to it and zero velocity.
-        float diffNow = g_aiTargetY - g_right.y;
-        if (fabsf(diffNow) <= fabsf(dyR)) {
-            dyR = diffNow;
-            g_aiVelY = 0.0f;
-            g_aiCmdVelY = 0.0f;
+// Handles everything that has arrived, and keeps saying HELLO until the
+// host answers.
+static void NetPoll(double now, uint32_t seed) {
+    uint8_t buf[kNetPacketMax];
+    UdpAddr from;
+    while (int n = UdpRecv(g_sock, buf, (int)sizeof(buf), &from)) {
+        int kind = NetPacketKind(buf, n);
+        if (kind == NET_HELLO && g_netMode == NETMODE_HOST && (!g_netStarted || UdpSameAddr(from, g_peer))) {
+            NetWelcome wel = { seed, (uint32_t)g_tickHz, g_game.w, g_game.h };
+            g_peer = from;
+            if (!g_netStarted) NetStart(0, wel);
+            NetSend(buf, NetWriteWelcome(buf, wel.seed, wel.tickHz, wel.w, wel.h), now);
+        } else if (kind == NET_WELCOME && g_netMode == NETMODE_JOIN && !g_netStarted) {
+            NetStart(1, NetReadWelcome(buf));
+        } else if (kind == NET_INPUT && g_netStarted && UdpSameAddr(from, g_peer)) {
+            NetReceiveInput(g_net, buf, n);
+        } else {
+            continue;
         }
+        g_netLastRecv = now;
+    }
+    if (g_netMode == NETMODE_JOIN && !g_netStarted && now - g_netLastHello >= 0.25) {
+        g_netLastHello = now;
+        NetSend(buf, NetWriteHello(buf), now);
+    }
+}
+
+static uint8_t NetLocalInput(const PongInput& in) {
+    uint8_t bits = 0;
+    if (in.down & (PONG_KEY_W | PONG_KEY_UP)) bits |= NET_UP;
+    if (in.down & (PONG_KEY_S | PONG_KEY_DOWN)) bits |= NET_DOWN;
+    if (in.pressed & PONG_KEY_SPACE) bits |= NET_SERVE;
+    return bits;
+}
+
+// Status line, refreshed with the title-bar stats: round trip, how often
+// and how deep the session rolled back, and what re-simulating cost.
+static void RefreshNetText(double now) {
+    if (!g_netStarted) return;
+    const NetStats& st = g_net.stats;
+    if (now - g_netLastRecv > 3.0) {
+        lstrcpynA(g_netText, "Opponent not responding...", (int)sizeof(g_netText));
+        return;
+    }
+    double frames = st.frames ? (double)st.frames : 1.0;
+    snprintf(g_netText, sizeof(g_netText), "rtt %d ms   rollbacks %.3f/frame, max %u deep   resim %.1f us/frame   stalls %u",
+             g_net.rttTicks * 1000 / g_tickHz, st.rollbacks / frames, st.maxRollback,
+             st.resimSecs * 1e6 / frames, (unsigned)st.stalls);
+}
+
+// One fixed tick, local or networked. False if a stalled netplay tick left
+// the input unused (edge-triggered keys should then stay latched).
+// Netplay sends no press point, so presses apply from the start of a tick.
+static bool StepGame(const PongInput& in, float stepDt, double now) {
+    if (g_chaosMode) {
+        // No sounds: hundreds of hits a second are only noise.
+        ChaosUpdate(g_game, g_chaos, in, stepDt);
+        return true;
+    }
+    const PongState before = g_game;
+    bool ticked = true;
+    if (g_netMode == NETMODE_OFF) {
+        UpdateGame(g_game, in, stepDt);
+        if (g_recording) ReplayRecord(g_replay, PongInputBits(in));
     } else {
-        // Human control
-        if (g_keyDown[VK_UP]) dyR -= g_right.speed * dt;
-        if (g_keyDown[VK_DOWN]) dyR += g_right.speed * dt;
+        NetPoll(now, g_netSeed);
+        if (!g_netStarted) return true;
+        ticked = NetTick(g_net, NetLocalInput(in));
+        uint8_t pkt[kNetPacketMax];
+        NetSend(pkt, NetWriteInput(g_net, pkt), now);
+        g_game = g_net.state;
     }
-    g_right.y = Clamp(g_right.y + dyR, g_right.h * 0.5f, g_h - g_right.h * 0.5f);
+    if (g_sound) PongSounds(g_synth, before, g_game, WaveNow());
+    return ticked;
+}
+
+// Steps the tick covering [start, end) in QPC time with the keys of that span.
+static void RunTick(LONGLONG start, LONGLONG end, LONGLONG now, float stepDt) {
+    PongInput in = TakeInput(start, end, now);
+    if (!StepGame(in, stepDt, Seconds(now))) g_inputCarry = in.pressed;
+}
+
+// Nothing will change until a key goes down, so the simulation can stop
+// ticking and wait for one (never in netplay: the peer keeps ticking).
+// Called by whichever thread ticks.
+static bool SimAtRest() {
+    if (g_chaosMode && g_game.state != STATE_MENU) return false;   // its balls are always in play
+    return g_netMode == NETMODE_OFF && PongAtRest(g_game) && !g_input.down && !InputPending(g_input);
+}
+
+// ======================================================
+// Threaded mode (-threaded): simulation and rendering on their own threads
+// ======================================================
+// The UI thread only pumps messages and queues keys. The simulation thread
+// runs the fixed tick and publishes every result through a triple buffer;
+// the render thread draws the newest one into the DIB it owns (interpolated
+// as in the serial loop) and presents it. Neither ever waits for the other,
+// so a slow blit or a modal resize no longer holds up ticks or input.
+// At rest both sleep on an event: the simulation until a key, the renderer
+// until a new frame, a resize or a repaint.
+// Frame profiling (NG_PROFILE) covers the serial loop only.
+struct PongFrame {
+    PongState prev, cur;
+    LONGLONG tickAt;     // QPC time cur was simulated
+    double tickDt;
+    NetHud net;
+};
 
-    if (!g_ball.inPlay && g_keyPressed[VK_SPACE]) g_ball.inPlay = true;
+static bool g_threaded = false;
+static TripleBuffer<PongFrame> g_frames;
+static LONGLONG g_framePeriod;
+static std::atomic<uint32_t> g_viewResize(0), g_gameResize(0);  // w | h << 16 from WM_SIZE, 0 = none
+static std::atomic<bool> g_repaint(false);                      // WM_PAINT: present the whole frame
+static HANDLE g_renderWake = NULL;                              // a frame, resize or repaint is waiting
 
-    if (g_ball.inPlay) {
-        g_ball.x += g_ball.vx * dt;
-        g_ball.y += g_ball.vy * dt;
+static DWORD WINAPI SimThread(LPVOID) {
+    HANDLE timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    LONGLONG nextTick = now.QuadPart, lastStats = now.QuadPart;
+    PongState prev = g_game;
 
-        if (g_ball.y - g_ball.r < 0) {
-            g_ball.y = g_ball.r;
-            g_ball.vy = -g_ball.vy;
-        }
-        if (g_ball.y + g_ball.r > g_h) {
-            g_ball.y = g_h - g_ball.r;
-            g_ball.vy = -g_ball.vy;
+    while (g_running) {
+        // A joining client takes the host's tick rate.
+        const LONGLONG period = g_qpcFreq.QuadPart / g_tickHz;
+        const float stepDt = ReplayTickDt((uint32_t)g_tickHz);
+        if (uint32_t size = g_gameResize.exchange(0)) {
+            if (!g_netStarted) ResizeGame((int)(size & 0xFFFF), (int)(size >> 16));
+            prev = g_game;
         }
 
-        float lx0 = g_left.x - g_left.w * 0.5f;
-        float ly0 = g_left.y - g_left.h * 0.5f;
-        float lx1 = g_left.x + g_left.w * 0.5f;
-        float ly1 = g_left.y + g_left.h * 0.5f;
+        QueryPerformanceCounter(&now);
+        if (now.QuadPart - nextTick > g_qpcFreq.QuadPart / 4) nextTick = now.QuadPart; // don't spiral after a stall
+        int ticks = 0;
+        for (; nextTick <= now.QuadPart; nextTick += period, ticks++) {
+            prev = g_game;
+            RunTick(nextTick - period, nextTick, now.QuadPart, stepDt);
+        }
+        if (now.QuadPart - lastStats >= g_qpcFreq.QuadPart / 2) {
+            RefreshNetText(Seconds(now.QuadPart));
+            lastStats = now.QuadPart;
+        }
+        if (ticks) {
+            PongFrame& f = TripleBufferBack(g_frames);
+            f.prev = prev;
+            f.cur = g_game;
+            f.tickAt = now.QuadPart;
+            f.tickDt = 1.0 / g_tickHz;
+            f.net = CurrentNetHud();
+            TripleBufferPublish(g_frames);
+            SetEvent(g_renderWake);
+        }
+        if (SimAtRest()) {
+            // The frame at rest is published; sleep until a key (the wait
+            // is a pause, not play, so don't catch up afterwards).
+            WaitForSingleObject(g_simWake, kIdleWaitMs);
+            QueryPerformanceCounter(&now);
+            nextTick = now.QuadPart;
+            continue;
+        }
+        WaitUntil(nextTick, timer);
+    }
+    if (timer) CloseHandle(timer);
+    return 0;
+}
 
-        float rx0 = g_right.x - g_right.w * 0.5f;
-        float ry0 = g_right.y - g_right.h * 0.5f;
-        float rx1 = g_right.x + g_right.w * 0.5f;
-        float ry1 = g_right.y + g_right.h * 0.5f;
+static DWORD WINAPI RenderThread(LPVOID) {
+    HANDLE timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    LONGLONG nextFrame = now.QuadPart + g_framePeriod, lastStats = now.QuadPart;
 
-        if (g_ball.vx < 0 && CircleAABB(g_ball.x, g_ball.y, g_ball.r, lx0, ly0, lx1, ly1)) {
-            BounceFromPaddle(g_left, true);
-        } else if (g_ball.vx > 0 && CircleAABB(g_ball.x, g_ball.y, g_ball.r, rx0, ry0, rx1, ry1)) {
-            BounceFromPaddle(g_right, false);
+    while (g_running) {
+        if (uint32_t size = g_viewResize.exchange(0)) {
+            ResizeBackbuffer(g_hwnd, (int)(size & 0xFFFF), (int)(size >> 16));
         }
+        const bool fresh = TripleBufferAcquire(g_frames);
+        const PongFrame& f = TripleBufferFront(g_frames);
+        QueryPerformanceCounter(&now);
+        double alpha = Seconds(now.QuadPart - f.tickAt) / f.tickDt;
+        RenderGame(InterpolateState(f.prev, f.cur, (float)(alpha < 1.0 ? alpha : 1.0)), f.net);
+        if (g_repaint.exchange(false)) {
+            DamageAddAll(g_damage);
+            g_viewDirty = true;
+        }
+        PresentDamage(g_hwnd);
 
-        if (g_ball.x + g_ball.r < 0) {
-            g_scoreR++;
-            ResetRound(false);
-        } else if (g_ball.x - g_ball.r > g_w) {
-            g_scoreL++;
-            ResetRound(true);
+        if (now.QuadPart - lastStats >= g_qpcFreq.QuadPart / 2) {
+            ReportDamageStats(g_hwnd);
+            lastStats = now.QuadPart;
+        }
+        if (!fresh && g_damage.count == 0 && !g_viewDirty) {
+            // That frame changed nothing and no newer one is waiting.
+            WaitForSingleObject(g_renderWake, kIdleWaitMs);
+            QueryPerformanceCounter(&now);
+            nextFrame = now.QuadPart + g_framePeriod;
+            continue;
+        }
+        if (g_paceMode == PACE_PRECISE) {
+            WaitUntil(nextFrame, timer);
+            QueryPerformanceCounter(&now);
+            nextFrame += g_framePeriod;
+            if (nextFrame < now.QuadPart) nextFrame = now.QuadPart + g_framePeriod;
         }
     }
+    if (timer) CloseHandle(timer);
+    return 0;
 }
 
-static void RenderGame(HWND hwnd) {
-    (void)hwnd;
+// Runs until quit. The UI thread blocks in GetMessage between messages.
+static void RunThreaded(LONGLONG framePeriod) {
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    PongFrame first;
+    first.prev = first.cur = g_game;
+    first.tickAt = now.QuadPart;
+    first.tickDt = 1.0 / g_tickHz;
+    first.net = CurrentNetHud();
+    TripleBufferInit(g_frames, first);
+    g_framePeriod = framePeriod;
+    g_renderWake = CreateEventA(NULL, FALSE, FALSE, NULL);
+    g_simWake = CreateEventA(NULL, FALSE, FALSE, NULL);
+
+    HANDLE threads[2] = {
+        CreateThread(NULL, 0, SimThread, NULL, 0, NULL),
+        CreateThread(NULL, 0, RenderThread, NULL, 0, NULL),
+    };
+    MSG msg;
+    while (g_running && GetMessage(&msg, NULL, 0, 0) > 0) {
+        TranslateMessage(&msg);
+        DispatchMessage(&msg);
+    }
+    g_running = false;
+    SetEvent(g_simWake);
+    SetEvent(g_renderWake);
+    // The render thread may be blocked setting the title; keep pumping
+    // until both threads have finished.
+    while (WaitForMultipleObjects(2, threads, TRUE, 10) == WAIT_TIMEOUT) {
+        while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) DispatchMessage(&msg);
+    }
+    CloseHandle(threads[0]);
+    CloseHandle(threads[1]);
+    CloseHandle(g_simWake);
+    CloseHandle(g_renderWake);
+    g_simWake = g_renderWake = NULL;
 }
 
 // ======================================================
 // Window Proc
 // ======================================================
-static HWND g_hwnd = NULL;
-
 LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
     switch (msg) {
     case WM_CLOSE:
@@ -414,15 +1109,49 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
     case WM_SIZE: {
         int w = LOWORD(lParam);
         int h = HIWORD(lParam);
+        if (g_fixed && (w == 0 || h == 0)) return 0; // minimized: keep the layout
+        if (g_threaded) {
+            uint32_t size = (uint32_t)(w > 0 ? w : 1) | (uint32_t)(h > 0 ? h : 1) << 16;
+            g_viewResize = size;
+            SetEvent(g_renderWake);
+            if (!g_fixed) {
+                g_gameResize = size;
+                SetEvent(g_simWake);
+            }
+            return 0;
+        }
         ResizeBackbuffer(hwnd, w, h);
-        ResetGame();
+        // A session's playfield is fixed, and so is a -fixed one.
+        if (!g_netStarted && !g_fixed) ResizeGame(g_w, g_h);
+        return 0;
+    }
+    case WM_PAINT: {
+        // Partial presents leave uncovered areas stale; the memory DC
+        // always holds the whole last frame, so repaint from it.
+        PAINTSTRUCT ps;
+        HDC hdc = BeginPaint(hwnd, &ps);
+        if (g_threaded) {
+            g_repaint = true; // the render thread owns the memory DC
+            SetEvent(g_renderWake);
+        } else if (g_fixed) {
+            g_viewDirty = true; // the DIB may be new since the last present
+            PresentScaled(hdc);
+        } else if (g_memDC) {
+            BitBlt(hdc, 0, 0, g_viewW, g_viewH, g_memDC, 0, 0, SRCCOPY);
+        }
+        EndPaint(hwnd, &ps);
         return 0;
     }
     case WM_KEYDOWN:
-        OnKeyDown((uint8_t)wParam);
+#if defined(NG_PROFILE)
+        if (wParam == VK_F2) g_prof.overlay = !g_prof.overlay;
+        if (wParam == VK_F3) ProfWriteCsv(g_profCsvPath);
+#endif
+        if (wParam == VK_ESCAPE) g_running = false;
+        if (!(lParam & (1 << 30))) PushKey((uint8_t)wParam, true); // not auto-repeat
         return 0;
     case WM_KEYUP:
-        OnKeyUp((uint8_t)wParam);
+        PushKey((uint8_t)wParam, false);
         return 0;
     default:
         return DefWindowProc(hwnd, msg, wParam, lParam);
@@ -432,7 +1161,7 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 // ======================================================
 // WinMain + Loop
 // ======================================================
-int WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, int nCmdShow) {
+int WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR cmdLine, int nCmdShow) {
     const char* CLASS_NAME = "PongWindow";
 
     WNDCLASSA wc{};
@@ -444,6 +1173,25 @@ int WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, int nCmdShow) {
 
     RegisterClassA(&wc);
 
+    // -fixed[=WxH] renders at a fixed logical size (default 800x600) that
+    // -scale=integer|nearest|bilinear fits to the window. Set up before the
+    // window so its first WM_SIZE already goes through the scaler.
+    if (cmdLine && strstr(cmdLine, "-fixed")) {
+        char arg[32];
+        int fw = 800, fh = 600;
+        if (ArgStr(cmdLine, "-fixed=", arg, (int)sizeof(arg)) && sscanf(arg, "%dx%d", &fw, &fh) != 2) fw = fh = 0;
+        if (fw < 160 || fh < 120 || fw > 4096 || fh > 4096) {
+            MessageBoxA(NULL, "Use -fixed=WxH, from 160x120 to 4096x4096", "PONG", MB_OK | MB_ICONERROR);
+            return 1;
+        }
+        if (ArgStr(cmdLine, "-scale=", arg, (int)sizeof(arg))) {
+            if (strcmp(arg, "nearest") == 0) g_scaleMode = SCALE_NEAREST;
+            if (strcmp(arg, "bilinear") == 0) g_scaleMode = SCALE_BILINEAR;
+        }
+        g_fixed = true;
+        if (!InitFixedBackbuffer(fw, fh)) return 1;
+    }
+
     g_hwnd = CreateWindowExA(
         0, CLASS_NAME, "PONG (GDI, single-file, no flicker)",
         WS_OVERLAPPEDWINDOW,
@@ -453,88 +1201,149 @@ int WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, int nCmdShow) {
 
     ShowWindow(g_hwnd, nCmdShow);
 
+    // Command line: -tick=N (simulation Hz), -fps=N (frame cap, default
+    // display refresh), -pace=off (uncapped), -seed=N (AI choices, default
+    // from the clock), -record=path (write a replay on exit), -host=PORT or
+    // -join=HOST:PORT (netplay, see NetOpen), -threaded (simulate and render
+    // on their own threads), -fixed[=WxH] and -scale=MODE (see above),
+    // -mute (no sound), -chaos=N (N balls at once; serial, offline and
+    // unrecorded, since the balls live outside PongState), -render-threads=N
+    // (big redraws in tiles on N threads, default one per core; fewer than
+    // 3 = off).
+    LARGE_INTEGER clock;
+    QueryPerformanceCounter(&clock);
+    uint32_t seed = (uint32_t)ArgInt(cmdLine, "-seed=", (int)(clock.QuadPart & 0x7FFFFFFF));
+
     RECT r; GetClientRect(g_hwnd, &r);
     ResizeBackbuffer(g_hwnd, r.right - r.left, r.bottom - r.top);
-    ResetGame();
+    InitGame(g_game, g_w, g_h, seed);
+
+    g_tickHz = ArgInt(cmdLine, "-tick=", g_tickHz);
+    if (g_tickHz < 10) g_tickHz = 10;
+    if (g_tickHz > 1000) g_tickHz = 1000;
+    int fps = ArgInt(cmdLine, "-fps=", DisplayRefreshHz());
+    if (fps < 10) fps = 10;
+    if (cmdLine && strstr(cmdLine, "-pace=off")) g_paceMode = PACE_OFF;
+    if (!NetOpen(cmdLine)) {
+        DestroyBackbuffer();
+        return 1;
+    }
+    g_netSeed = seed;
+    g_threaded = cmdLine && strstr(cmdLine, "-threaded");
+    const int chaosBalls = ArgInt(cmdLine, "-chaos=", 0);
+    if (chaosBalls > 0 && g_netMode == NETMODE_OFF) {
+        g_chaosMode = ChaosInit(g_chaos, chaosBalls < 100000 ? chaosBalls : 100000, g_w, g_h);
+        if (g_chaosMode) g_threaded = false;
+    }
+    SynthInit(g_synth, NgDetectSimd());
+    g_sound = !(cmdLine && strstr(cmdLine, "-mute")) && WaveOpen(g_wave, g_synth);
+    ParticleInit(g_fx, kFxCapacity, kFxGravity, kFxKeep);
+    const int renderThreads = ArgInt(cmdLine, "-render-threads=", TileDefaultThreads());
+    TilePoolStart(g_tilePool, renderThreads >= kTileMinThreads ? renderThreads - 1 : 0);
+    // A replay holds one player's keys, so netplay isn't recorded.
+    if (g_netMode == NETMODE_OFF && !g_chaosMode && ArgStr(cmdLine, "-record=", g_recordPath, (int)sizeof(g_recordPath))) {
+        StartRecording(seed, g_tickHz);
+    }
+#if defined(NG_PROFILE)
+    bool profCsvAtExit = ArgStr(cmdLine, "-profile-csv=", g_profCsvPath, (int)sizeof(g_profCsvPath));
+#endif
 
-    LARGE_INTEGER freq;
-    QueryPerformanceFrequency(&freq);
+    QueryPerformanceFrequency(&g_qpcFreq);
+    InputInit(g_input, g_qpcFreq.QuadPart);
+    g_paceTimer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+
+    const LONGLONG framePeriod = g_qpcFreq.QuadPart / fps;
 
     LARGE_INTEGER last;
     QueryPerformanceCounter(&last);
+    LONGLONG nextFrame = last.QuadPart + framePeriod;
+    double accumulator = 0.0;
+    PongState prev = g_game;
+    LONGLONG lastStats = last.QuadPart;
 
-    const double target_dt = 1.0 / 60.0;
+    if (g_threaded) RunThreaded(framePeriod); // returns at quit, skipping the serial loop
 
     while (g_running) {
-        BeginInputFrame();
-
-        MSG msg;
-        while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
-            if (msg.message == WM_QUIT) g_running = false;
-            TranslateMessage(&msg);
-            DispatchMessage(&msg);
+        NG_PROFILE_FRAME();
+        {
+            NG_PROFILE_SCOPE(PROF_INPUT);
+            MSG msg;
+            while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
+                if (msg.message == WM_QUIT) g_running = false;
+                TranslateMessage(&msg);
+                DispatchMessage(&msg);
+            }
         }
 
         LARGE_INTEGER now;
         QueryPerformanceCounter(&now);
-        double dt = (double)(now.QuadPart - last.QuadPart) / (double)freq.QuadPart;
+        double frameDt = Seconds(now.QuadPart - last.QuadPart);
         last = now;
-        if (dt > 0.05) dt = 0.05;
-
-        UpdateGame((float)dt);
-
-        // Render everything to backbuffer
-        Clear(RGBX(30, 30, 40));
-        DrawCenterLine(RGBX(80, 80, 95));
-
-        if (g_state == STATE_MENU) {
-            const int cx = g_w / 2;
-            const int top = g_h / 2 - 90;
-            DrawTextBB(cx - 30, top, "PONG");
-
-            const char* opt0 = "1) 2 Players";
-            const char* opt1 = "2) Player vs Computer";
-            COLORREF normal = RGB(240, 240, 240);
-            COLORREF hi = RGB(255, 235, 150);
-
-            DrawTextBB(cx - 120, top + 45,  opt0, (g_menuSelection == 0) ? hi : normal);
-            DrawTextBB(cx - 120, top + 70,  opt1, (g_menuSelection == 1) ? hi : normal);
-            DrawTextBB(cx - 120, top + 110, "Use Up/Down then Enter (or press 1/2)");
-            DrawTextBB(cx - 120, top + 130, "ESC = Quit");
-        } else {
-            uint32_t paddleC = RGBX(15, 232, 73);
-            FillRectI((int)(g_left.x - g_left.w * 0.5f),  (int)(g_left.y - g_left.h * 0.5f),
-                      (int)(g_left.x + g_left.w * 0.5f),  (int)(g_left.y + g_left.h * 0.5f), paddleC);
-
-            FillRectI((int)(g_right.x - g_right.w * 0.5f), (int)(g_right.y - g_right.h * 0.5f),
-                      (int)(g_right.x + g_right.w * 0.5f), (int)(g_right.y + g_right.h * 0.5f), paddleC);
-
-            uint32_t ballC = RGBX(252, 186, 4);
-            FillRectI((int)(g_ball.x - g_ball.r), (int)(g_ball.y - g_ball.r),
-                      (int)(g_ball.x + g_ball.r), (int)(g_ball.y + g_ball.r), ballC);
-
-            char hud[180];
-            const char* mode = g_aiMode ? "vs Computer" : "2 Players";
-            wsprintfA(hud, "W/S (Left)   Up/Down (Right)   Space=Serve   R=Reset   Mode: %s   Score: %d - %d", mode, g_scoreL, g_scoreR);
-            DrawTextBB(12, 10, hud);
-
-            if (!g_ball.inPlay) {
-                DrawTextBB(g_w / 2 - 60, g_h / 2 - 10, "Press SPACE to serve");
-            }
+        if (frameDt > 0.25) frameDt = 0.25; // don't spiral after a stall (debugger, drag)
+        accumulator += frameDt;
+
+        // A joining client takes the host's tick rate.
+        const double tickDt = 1.0 / (double)g_tickHz;
+        const float stepDt = ReplayTickDt((uint32_t)g_tickHz); // what replays step with too
+        const LONGLONG period = g_qpcFreq.QuadPart / g_tickHz;
+
+        // The simulation trails real time by the accumulator, so each tick
+        // stands for the span of real time ending `accumulator - tickDt`
+        // before now, and takes the keys of that span.
+        while (accumulator >= tickDt) {
+            NG_PROFILE_SCOPE(PROF_UPDATE);
+            prev = g_game;
+            LONGLONG end = now.QuadPart - (LONGLONG)((accumulator - tickDt) * (double)g_qpcFreq.QuadPart);
+            RunTick(end - period, end, now.QuadPart, stepDt);
+            accumulator -= tickDt;
         }
 
-        
-        HDC hdc = GetDC(g_hwnd);
-        BitBlt(hdc, 0, 0, g_w, g_h, g_memDC, 0, 0, SRCCOPY);
-        ReleaseDC(g_hwnd, hdc);
+        {
+            NG_PROFILE_SCOPE(PROF_RENDER);
+            RenderGame(InterpolateState(prev, g_game, (float)(accumulator / tickDt)), CurrentNetHud());
+        }
+        {
+            NG_PROFILE_SCOPE(PROF_PRESENT);
+            PresentDamage(g_hwnd);
+        }
+        if (now.QuadPart - lastStats >= g_qpcFreq.QuadPart / 2) {
+            ReportDamageStats(g_hwnd);
+            RefreshNetText(Seconds(now.QuadPart));
+#if defined(NG_PROFILE)
+            RefreshProfileOverlay();
+#endif
+            lastStats = now.QuadPart;
+        }
 
-        
-        if (dt < target_dt) {
-            DWORD ms = (DWORD)((target_dt - dt) * 1000.0);
-            if (ms > 0) Sleep(ms);
+        if (SimAtRest() && g_damage.count == 0 && !g_viewDirty) {
+            // A still scene that is already on screen: block until input
+            // (or the next stats refresh) instead of drawing it again. The
+            // wait is a pause, not play, so the clock restarts after it.
+            MsgWaitForMultipleObjects(0, NULL, FALSE, kIdleWaitMs, QS_ALLINPUT);
+            QueryPerformanceCounter(&last);
+            accumulator = 0.0;
+            prev = g_game;
+            nextFrame = last.QuadPart + framePeriod;
+        } else if (g_paceMode == PACE_PRECISE) {
+            WaitUntil(nextFrame, g_paceTimer);
+            QueryPerformanceCounter(&now);
+            nextFrame += framePeriod;
+            if (nextFrame < now.QuadPart) nextFrame = now.QuadPart + framePeriod; // fell behind: resync
         }
     }
 
+    StopRecording();
+    NetClose();
+    if (g_sound) WaveClose(g_wave);
+    ParticleFree(g_fx);
+    ChaosFree(g_chaos);
+    TilePoolStop(g_tilePool);
+    TileFrameFree(g_tileFrame);
+#if defined(NG_PROFILE)
+    if (profCsvAtExit) ProfWriteCsv(g_profCsvPath);
+#endif
+    if (g_paceTimer) CloseHandle(g_paceTimer);
     DestroyBackbuffer();
+    free(g_background);
     return 0;
 }
@@ -0,0 +1,398 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "pong_core.h"
+#include "../common/simd.h"
+
+// ======================================================
+// Chaos mode: hundreds to thousands of balls in one court
+//
+// The balls live in structure-of-arrays form in one aligned block sized by
+// ChaosInit, next to a uniform grid for the broadphase; a step never
+// touches the heap. Each step
+//   - moves both paddles (each AI follows the ball that reaches it first),
+//   - integrates every ball and reflects it off the top and bottom walls,
+//     4 (SSE2) or 8 (AVX2) balls at a time with the same float operations
+//     as the scalar code, so every tier gives bit-identical states,
+//   - scores and re-serves each ball that left the court on its own, as
+//     ResetRound does for the single ball,
+//   - bins the balls into grid cells two radii wide with a counting sort,
+//     so touching balls are always in the same or neighbouring cells, and
+//     resolves ball-ball and ball-paddle contacts from there.
+// Balls are resolved in grid order, which depends only on the state, so a
+// chaos game is as deterministic as a normal one.
+//
+//   ChaosInit(chaos, balls, w, h);
+//   ChaosUpdate(state, chaos, input, dt);   // instead of UpdateGame
+//   ChaosFree(chaos);
+// ======================================================
+
+struct ChaosBalls {
+    float* x;
+    float* y;
+    float* vx;
+    float* vy;
+    int count, capacity;   // capacity is count rounded up to 8
+    float r;               // every ball has the same radius
+
+    // Uniform grid, rebuilt each step: the balls of cell c are
+    // order[cellStart[c] .. cellStart[c + 1]).
+    float cell;            // cell size, 2r
+    int cols, rows;
+    int32_t* cellStart;    // cols * rows + 1
+    int32_t* order;
+    int32_t* cellOf;       // each ball's cell
+
+    uint32_t pairTests;    // last step: pairs the grid handed out
+    uint32_t contacts;     // last step: of those, pairs that touched
+};
+
+typedef void (*ChaosIntegrateFn)(ChaosBalls& c, int n, float dt, float h);
+
+struct ChaosKernels {
+    NgSimdLevel level;
+    ChaosIntegrateFn integrate;   // positions over dt, then the wall reflection
+};
+
+// ---- Scalar kernel ----
+// A ball that crossed a wall is mirrored back across it with its vertical
+// speed pointing into the court.
+static inline void ChaosIntegrateScalar(ChaosBalls& c, int n, float dt, float h) {
+    const float lo = c.r, hi = h - c.r;
+    const float lo2 = lo + lo, hi2 = hi + hi;
+    for (int i = 0; i < n; i++) {
+        const float x = c.x[i] + c.vx[i] * dt;
+        float y = c.y[i] + c.vy[i] * dt;
+        float vy = c.vy[i];
+        if (y < lo) { y = lo2 - y; vy = fabsf(vy); }
+        if (y > hi) { y = hi2 - y; vy = -fabsf(vy); }
+        c.x[i] = x;
+        c.y[i] = y;
+        c.vy[i] = vy;
+    }
+}
+
+#if defined(NG_HAVE_SSE2)
+static inline __m128 ChaosSelectSSE2(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static inline void ChaosIntegrateSSE2(ChaosBalls& c, int n, float dt, float h) {
+    const __m128 vdt = _mm_set1_ps(dt), lo = _mm_set1_ps(c.r), hi = _mm_set1_ps(h - c.r);
+    const __m128 lo2 = _mm_add_ps(lo, lo), hi2 = _mm_add_ps(hi, hi);
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    for (int i = 0; i < n; i += 4) {
+        const __m128 x = _mm_add_ps(_mm_load_ps(c.x + i), _mm_mul_ps(_mm_load_ps(c.vx + i), vdt));
+        __m128 vy = _mm_load_ps(c.vy + i);
+        __m128 y = _mm_add_ps(_mm_load_ps(c.y + i), _mm_mul_ps(vy, vdt));
+        __m128 m = _mm_cmplt_ps(y, lo);
+        y = ChaosSelectSSE2(m, _mm_sub_ps(lo2, y), y);
+        vy = ChaosSelectSSE2(m, _mm_andnot_ps(sign, vy), vy);
+        m = _mm_cmpgt_ps(y, hi);
+        y = ChaosSelectSSE2(m, _mm_sub_ps(hi2, y), y);
+        vy = ChaosSelectSSE2(m, _mm_or_ps(sign, vy), vy);
+        _mm_store_ps(c.x + i, x);
+        _mm_store_ps(c.y + i, y);
+        _mm_store_ps(c.vy + i, vy);
+    }
+}
+#endif
+
+#if defined(NG_HAVE_AVX2)
+NG_TARGET_AVX2 static inline void ChaosIntegrateAVX2(ChaosBalls& c, int n, float dt, float h) {
+    const __m256 vdt = _mm256_set1_ps(dt), lo = _mm256_set1_ps(c.r), hi = _mm256_set1_ps(h - c.r);
+    const __m256 lo2 = _mm256_add_ps(lo, lo), hi2 = _mm256_add_ps(hi, hi);
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    for (int i = 0; i < n; i += 8) {
+        const __m256 x = _mm256_add_ps(_mm256_load_ps(c.x + i), _mm256_mul_ps(_mm256_load_ps(c.vx + i), vdt));
+        __m256 vy = _mm256_load_ps(c.vy + i);
+        __m256 y = _mm256_add_ps(_mm256_load_ps(c.y + i), _mm256_mul_ps(vy, vdt));
+        __m256 m = _mm256_cmp_ps(y, lo, _CMP_LT_OQ);
+        y = _mm256_blendv_ps(y, _mm256_sub_ps(lo2, y), m);
+        vy = _mm256_blendv_ps(vy, _mm256_andnot_ps(sign, vy), m);
+        m = _mm256_cmp_ps(y, hi, _CMP_GT_OQ);
+        y = _mm256_blendv_ps(y, _mm256_sub_ps(hi2, y), m);
+        vy = _mm256_blendv_ps(vy, _mm256_or_ps(sign, vy), m);
+        _mm256_store_ps(c.x + i, x);
+        _mm256_store_ps(c.y + i, y);
+        _mm256_store_ps(c.vy + i, vy);
+    }
+}
+#endif
+
+static inline ChaosKernels ChaosPickKernels(NgSimdLevel level) {
+    ChaosKernels k = { NG_SIMD_SCALAR, ChaosIntegrateScalar };
+#if defined(NG_HAVE_SSE2)
+    if (level >= NG_SIMD_SSE2) { k.level = NG_SIMD_SSE2; k.integrate = ChaosIntegrateSSE2; }
+#endif
+#if defined(NG_HAVE_AVX2)
+    if (level >= NG_SIMD_AVX2) { k.level = NG_SIMD_AVX2; k.integrate = ChaosIntegrateAVX2; }
+#endif
+    (void)level;
+    return k;
+}
+
+// Kernels used by ChaosUpdate; tools may overwrite this to compare tiers.
+static ChaosKernels g_chaosKernels = ChaosPickKernels(NgDetectSimd());
+
+// ---- Storage ----
+// Radius for n balls in a w x h court: the usual 8 px while they cover
+// under 15% of it, smaller beyond that so thousands still have room.
+static inline float ChaosRadius(int n, int w, int h) {
+    const float fit = sqrtf((float)w * (float)h * 0.15f / (3.14159265f * (float)(n > 0 ? n : 1)));
+    if (fit < 1.5f) return 1.5f;
+    return fit < 8.0f ? fit : 8.0f;
+}
+
+static inline void ChaosFreeGrid(ChaosBalls& c) {
+    NgAlignedFree(c.cellStart);
+    c.cellStart = nullptr;
+    c.cols = c.rows = 0;
+}
+
+// Sizes the grid for a w x h court; called by ChaosInit and on resize.
+static inline bool ChaosResize(ChaosBalls& c, int w, int h) {
+    ChaosFreeGrid(c);
+    c.r = ChaosRadius(c.count, w, h);
+    c.cell = 2.0f * c.r;
+    c.cols = (int)((float)w / c.cell) + 1;
+    c.rows = (int)((float)h / c.cell) + 1;
+    const size_t cells = (size_t)c.cols * c.rows + 1;
+    c.cellStart = (int32_t*)NgAlignedAlloc((cells + 2 * (size_t)c.capacity) * 4, 32);
+    if (!c.cellStart) return false;
+    c.order = c.cellStart + cells;
+    c.cellOf = c.order + c.capacity;
+    return true;
+}
+
+static inline void ChaosFree(ChaosBalls& c) {
+    ChaosFreeGrid(c);
+    NgAlignedFree(c.x);
+    memset(&c, 0, sizeof(c));
+}
+
+static inline bool ChaosInit(ChaosBalls& c, int balls, int w, int h) {
+    memset(&c, 0, sizeof(c));
+    if (balls < 1) balls = 1;
+    const int capacity = (balls + 7) & ~7;
+    const size_t n = (size_t)capacity;
+    float* block = (float*)NgAlignedAlloc(n * 4 * 4, 32);
+    if (!block) return false;
+    memset(block, 0, n * 4 * 4);
+    c.x = block;
+    c.y = c.x + n;
+    c.vx = c.y + n;
+    c.vy = c.vx + n;
+    c.count = balls;
+    c.capacity = capacity;
+    if (!ChaosResize(c, w, h)) {
+        ChaosFree(c);
+        return false;
+    }
+    return true;
+}
+
+// Uniform in [lo, hi], from the game's own generator.
+static inline float ChaosRand(PongState& s, float lo, float hi) {
+    return lo + (hi - lo) * (float)(PongRand(s) & 0xFFFF) * (1.0f / 65535.0f);
+}
+
+// A ball back in from the centre line toward `toRight`, like a serve.
+static inline void ChaosServeBall(PongState& s, ChaosBalls& c, int i, bool toRight) {
+    c.x[i] = s.w * 0.5f;
+    c.y[i] = ChaosRand(s, c.r, (float)s.h - c.r);
+    c.vx[i] = toRight ? 320.0f : -320.0f;
+    c.vy[i] = ChaosRand(s, -120.0f, 120.0f);
+}
+
+// Scatters every ball over the middle half of the court, heading off at
+// serve speed in all directions but straight up or down.
+static inline void ChaosServe(PongState& s, ChaosBalls& c) {
+    for (int i = 0; i < c.count; i++) {
+        const float a = ChaosRand(s, -0.9f, 0.9f) + ((PongRand(s) & 1) ? 3.14159265f : 0.0f);
+        const float v = ChaosRand(s, 200.0f, 340.0f);
+        c.x[i] = ChaosRand(s, s.w * 0.25f, s.w * 0.75f);
+        c.y[i] = ChaosRand(s, c.r, (float)s.h - c.r);
+        c.vx[i] = cosf(a) * v;
+        c.vy[i] = sinf(a) * v;
+    }
+}
+
+// ---- Broadphase ----
+static inline int ChaosCellCoord(float v, float cell, int n) {
+    const int i = (int)floorf(v / cell);
+    return i < 0 ? 0 : (i >= n ? n - 1 : i);
+}
+
+// Counting sort of the balls by cell. Clamping positions outside the court
+// into the border cells keeps neighbours in neighbouring cells.
+static inline void ChaosBuildGrid(ChaosBalls& c) {
+    const int cells = c.cols * c.rows;
+    memset(c.cellStart, 0, (size_t)(cells + 1) * 4);
+    for (int i = 0; i < c.count; i++) {
+        const int cell = ChaosCellCoord(c.y[i], c.cell, c.rows) * c.cols + ChaosCellCoord(c.x[i], c.cell, c.cols);
+        c.cellOf[i] = cell;
+        c.cellStart[cell + 1]++;
+    }
+    for (int k = 0; k < cells; k++) c.cellStart[k + 1] += c.cellStart[k];
+    // cellStart[k] doubles as cell k's write cursor, then is shifted back.
+    for (int i = 0; i < c.count; i++) c.order[c.cellStart[c.cellOf[i]]++] = i;
+    for (int k = cells; k > 0; k--) c.cellStart[k] = c.cellStart[k - 1];
+    c.cellStart[0] = 0;
+}
+
+// Calls fn(i, j) once for every pair of balls in the same or adjacent
+// cells: each cell against itself and the four neighbours after it (right,
+// and the three below), so no pair is seen twice.
+template <typename Fn>
+static inline void ChaosForEachPair(const ChaosBalls& c, Fn&& fn) {
+    static const int kNext[4][2] = { { 1, 0 }, { -1, 1 }, { 0, 1 }, { 1, 1 } };
+    for (int cy = 0; cy < c.rows; cy++) {
+        for (int cx = 0; cx < c.cols; cx++) {
+            const int cell = cy * c.cols + cx;
+            const int a0 = c.cellStart[cell], a1 = c.cellStart[cell + 1];
+            if (a0 == a1) continue;
+            for (int a = a0; a < a1; a++) {
+                for (int b = a + 1; b < a1; b++) fn(c.order[a], c.order[b]);
+            }
+            for (int k = 0; k < 4; k++) {
+                const int nx = cx + kNext[k][0], ny = cy + kNext[k][1];
+                if (nx < 0 || nx >= c.cols || ny >= c.rows) continue;
+                const int other = ny * c.cols + nx;
+                const int b0 = c.cellStart[other], b1 = c.cellStart[other + 1];
+                for (int a = a0; a < a1; a++) {
+                    for (int b = b0; b < b1; b++) fn(c.order[a], c.order[b]);
+                }
+            }
+        }
+    }
+}
+
+// ---- Collisions ----
+// Equal masses: approaching balls swap their velocity along the line of
+// centres, and overlapping ones are pushed apart half each.
+static inline void ChaosCollideBalls(ChaosBalls& c) {
+    const float touch = 2.0f * c.r, touch2 = touch * touch;
+    uint32_t tests = 0, contacts = 0;
+    ChaosForEachPair(c, [&](int i, int j) {
+        tests++;
+        const float dx = c.x[j] - c.x[i], dy = c.y[j] - c.y[i];
+        const float d2 = dx * dx + dy * dy;
+        if (d2 >= touch2 || d2 == 0.0f) return;
+        contacts++;
+        const float vn = (c.vx[j] - c.vx[i]) * dx + (c.vy[j] - c.vy[i]) * dy;
+        if (vn < 0.0f) {
+            const float k = vn / d2;
+            c.vx[i] += k * dx; c.vy[i] += k * dy;
+            c.vx[j] -= k * dx; c.vy[j] -= k * dy;
+        }
+        const float d = sqrtf(d2);
+        const float push = (touch - d) * 0.5f / d;
+        c.x[i] -= dx * push; c.y[i] -= dy * push;
+        c.x[j] += dx * push; c.y[j] += dy * push;
+    });
+    c.pairTests = tests;
+    c.contacts = contacts;
+}
+
+// Balls in the cells under paddle `p` (grown by a radius) that touch it
+// while heading for the edge it guards go back through BounceBall. The AI
+// reacts only to returning ball `watched` (see ChaosWatchedBall), as in a
+// one-ball game: reacting to every hit would keep restarting its delay and
+// freeze it once hundreds of balls are in play. Balls already behind its
+// centre line are past saving.
+static inline void ChaosCollidePaddle(PongState& s, ChaosBalls& c, const Paddle& p, bool isLeft, int watched) {
+    const float x0 = p.x - p.w * 0.5f, x1 = p.x + p.w * 0.5f;
+    const float y0 = p.y - p.h * 0.5f, y1 = p.y + p.h * 0.5f;
+    const int cx0 = ChaosCellCoord(x0 - c.r, c.cell, c.cols), cx1 = ChaosCellCoord(x1 + c.r, c.cell, c.cols);
+    const int cy0 = ChaosCellCoord(y0 - c.r, c.cell, c.rows), cy1 = ChaosCellCoord(y1 + c.r, c.cell, c.rows);
+    for (int cy = cy0; cy <= cy1; cy++) {
+        for (int cx = cx0; cx <= cx1; cx++) {
+            const int cell = cy * c.cols + cx;
+            for (int a = c.cellStart[cell]; a < c.cellStart[cell + 1]; a++) {
+                const int i = c.order[a];
+                if (isLeft ? (c.vx[i] >= 0.0f || c.x[i] < p.x) : (c.vx[i] <= 0.0f || c.x[i] > p.x)) continue;
+                if (!CircleAABB(c.x[i], c.y[i], c.r, x0, y0, x1, y1)) continue;
+                Ball b = { c.x[i], c.y[i], c.r, c.vx[i], c.vy[i], true };
+                BounceBall(s, b, p, isLeft, i == watched);
+                c.x[i] = b.x; c.y[i] = b.y;
+                c.vx[i] = b.vx; c.vy[i] = b.vy;
+            }
+        }
+    }
+}
+
+// The ball an AI on the left (or right) should watch: the first to reach
+// its paddle, whose index goes to *index. With none coming it gets one
+// moving away, which it ignores, and *index = -1.
+static inline Ball ChaosWatchedBall(const ChaosBalls& c, const Paddle& p, bool isLeft, int* index) {
+    Ball b = { p.x, p.y, c.r, isLeft ? 1.0f : -1.0f, 0.0f, true };
+    *index = -1;
+    float best = 1e30f;
+    for (int i = 0; i < c.count; i++) {
+        const float gap = isLeft ? c.x[i] - p.x : p.x - c.x[i];
+        const float speed = isLeft ? -c.vx[i] : c.vx[i];
+        if (speed <= 0.0f || gap < 0.0f) continue;
+        const float t = gap / speed;
+        if (t < best) {
+            best = t;
+            *index = i;
+            b.x = c.x[i]; b.y = c.y[i];
+            b.vx = c.vx[i]; b.vy = c.vy[i];
+        }
+    }
+    return b;
+}
+
+// ---- Step ----
+// The chaos counterpart of UpdateGame: the menu and R work as usual
+// (starting or restarting serves every ball at once), and balls are always
+// in play.
+static void ChaosUpdate(PongState& s, ChaosBalls& c, const PongInput& in, float dt) {
+    if (PongSplitStep(in, dt, [&](const PongInput& part, float partDt) { ChaosUpdate(s, c, part, partDt); })) return;
+
+    if (s.state == STATE_MENU || (in.pressed & PONG_KEY_R)) {
+        UpdateGame(s, in, 0.0f);
+        if (s.state == STATE_PLAYING) ChaosServe(s, c);
+        return;
+    }
+
+    int watchedL, watchedR;
+    const Ball watchL = ChaosWatchedBall(c, s.left, true, &watchedL);
+    const Ball watchR = ChaosWatchedBall(c, s.right, false, &watchedR);
+    MovePaddles(s, in, watchL, watchR, dt);
+
+    g_chaosKernels.integrate(c, (c.count + 7) & ~7, dt, (float)s.h);
+
+    for (int i = 0; i < c.count; i++) {
+        if (c.x[i] + c.r < 0.0f) {
+            s.scoreR++;
+            ChaosServeBall(s, c, i, false);
+            if (i == watchedL) watchedL = -1;   // a new ball now
+        } else if (c.x[i] - c.r > (float)s.w) {
+            s.scoreL++;
+            ChaosServeBall(s, c, i, true);
+            if (i == watchedR) watchedR = -1;
+        }
+    }
+
+    ChaosBuildGrid(c);
+    ChaosCollideBalls(c);
+    ChaosCollidePaddle(s, c, s.left, true, watchedL);
+    ChaosCollidePaddle(s, c, s.right, false, watchedR);
+
+    // Separation can nudge a ball past a wall; put it back on the court.
+    const float lo = c.r, hi = (float)s.h - c.r;
+    for (int i = 0; i < c.count; i++) c.y[i] = Clamp(c.y[i], lo, hi);
+}
+
+static inline uint64_t ChaosHash(const PongState& s, const ChaosBalls& c) {
+    uint64_t h = HashI32(PongHash(s), c.count);
+    for (int i = 0; i < c.count; i++) {
+        h = HashF32(h, c.x[i]); h = HashF32(h, c.y[i]);
+        h = HashF32(h, c.vx[i]); h = HashF32(h, c.vy[i]);
+    }
+    return h;
+}
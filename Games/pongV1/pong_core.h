@@ -0,0 +1,582 @@
+#pragma once
+#include <stdint.h>
+#include <math.h>
+
+#include "../common/hash.h"
+
+// ======================================================
+// Pong simulation core (platform-free)
+//
+// Everything the game loop mutates lives in PongState and the keyboard is
+// reduced to a PongInput bitmask, so the same UpdateGame runs inside the
+// Win32 loop and in headless tools on any OS.
+// ======================================================
+
+enum PongKey {
+    PONG_KEY_W      = 1 << 0,
+    PONG_KEY_S      = 1 << 1,
+    PONG_KEY_UP     = 1 << 2,
+    PONG_KEY_DOWN   = 1 << 3,
+    PONG_KEY_SPACE  = 1 << 4,
+    PONG_KEY_RETURN = 1 << 5,
+    PONG_KEY_1      = 1 << 6,
+    PONG_KEY_2      = 1 << 7,
+    PONG_KEY_R      = 1 << 8,
+};
+
+struct PongInput {
+    uint16_t down;     // PongKey bits currently held
+    uint16_t pressed;  // PongKey bits that went down since the last step
+    uint8_t at;        // presses happened at at/128 of the step (0 = its start)
+    uint8_t until;     // keys pressed but no longer down were let go at until/128 (0 = none)
+};
+
+struct Paddle {
+    float x, y;      // center
+    float w, h;
+    float speed;
+};
+
+struct Ball {
+    float x, y;
+    float r;
+    float vx, vy;
+    bool inPlay;
+};
+
+// Tunables of the computer opponent. kPongAIDefaults are the values the
+// game ships with; headless tools sweep them (see tools/pong_tournament).
+struct PongAIParams {
+    float checkFrames;   // reaction sampling: frames between looks at the ball
+    int leadDelay;       // move delay while the opponent leads by 2 or more
+    int delayA, delayB;  // otherwise one of these, picked at random
+    float kp;            // px -> px/sec
+    float accel;         // px/sec^2
+    float deadZone;      // px
+    int perfectEvery;    // every Nth return gets no delay; 0 = never
+};
+
+static const PongAIParams kPongAIDefaults = { 24.0f, 2, 6, 12, 8.0f, 3200.0f, 2.0f, 7 };
+
+// One computer-controlled paddle. Delays are tuned in 60 Hz frames; the
+// counters accumulate elapsed time in those units so any tick rate behaves
+// the same.
+struct PongAI {
+    PongAIParams params;   // kept by ResetGame
+    float targetY;
+    int moveDelayFrames;
+    float moveFrameCounter;
+    float checkFrameCounter;
+    int hitCount;
+    int maxMoveDelay;
+    float cmdVelY;
+    float velY;
+};
+
+enum AppState {
+    STATE_MENU = 0,
+    STATE_PLAYING = 1,
+};
+
+struct PongState {
+    int w, h;        // playfield size in pixels
+
+    Paddle left, right;
+    Ball ball;
+    int scoreL, scoreR;
+    int hits;        // paddle contacts since ResetGame
+
+    AppState state;
+    // 0 = 2 Players, 1 = Player vs Computer
+    int menuSelection;
+
+    // AI mode: the right paddle is the computer. aiLeft also hands the
+    // left paddle to a second AI (headless AI-vs-AI matches only).
+    bool aiMode;
+    bool aiLeft;
+    PongAI aiR, aiL;
+
+    uint32_t rng;    // LCG state for AI choices (replaces the global rand())
+};
+
+// Reference rate the AI frame counts were tuned at.
+static const float kAiFrameHz = 60.0f;
+// Absorbs float drift when summing dt * kAiFrameHz over many ticks.
+static const float kAiFrameSlack = 1e-3f;
+
+static float Clamp(float v, float lo, float hi) {
+    if (v < lo) return lo;
+    if (v > hi) return hi;
+    return v;
+}
+
+static uint32_t PongRand(PongState& s) {
+    s.rng = s.rng * 1664525u + 1013904223u;
+    return s.rng >> 16; // low LCG bits have short periods
+}
+
+static void EnterStartMenu(PongState& s) {
+    s.state = STATE_MENU;
+    s.menuSelection = 0;
+    s.ball.inPlay = false;
+}
+
+// Movement delay based on score difference: quick while the opponent is
+// well ahead, otherwise one of two at random.
+static void AIPickDelay(PongState& s, PongAI& ai, int opponentLead) {
+    if (opponentLead >= 2) {
+        ai.maxMoveDelay = ai.params.leadDelay;
+    } else {
+        ai.maxMoveDelay = (PongRand(s) % 2 == 0) ? ai.params.delayA : ai.params.delayB;
+    }
+    ai.moveDelayFrames = ai.maxMoveDelay;
+}
+
+static void AIStop(PongAI& ai) {
+    ai.moveFrameCounter = 0.0f;
+    ai.cmdVelY = 0.0f;
+    ai.velY = 0.0f;
+}
+
+static void AIResetRound(PongState& s, PongAI& ai, const Paddle& p, int opponentLead) {
+    AIStop(ai);
+    ai.checkFrameCounter = 0.0f;
+    AIPickDelay(s, ai, opponentLead);
+    ai.targetY = p.y;
+}
+
+static void ResetRound(PongState& s, bool serveToRight) {
+    s.ball.x = s.w * 0.5f;
+    s.ball.y = s.h * 0.5f;
+    s.ball.vx = serveToRight ? 320.0f : -320.0f;
+    s.ball.vy = (serveToRight ? 1.0f : -1.0f) * 120.0f;
+    s.ball.inPlay = false;
+
+    // Reset AI movement delay when round starts
+    if (s.aiMode) AIResetRound(s, s.aiR, s.right, s.scoreL - s.scoreR);
+    if (s.aiLeft) AIResetRound(s, s.aiL, s.left, s.scoreR - s.scoreL);
+}
+
+static void AIReset(PongAI& ai) {
+    PongAIParams params = ai.params;
+    ai = PongAI{};
+    ai.params = params;
+    ai.moveDelayFrames = 10;
+    ai.maxMoveDelay = 10;
+}
+
+static void ResetGame(PongState& s) {
+    s.scoreL = s.scoreR = 0;
+    s.hits = 0;
+
+    s.left.w = 14;  s.left.h = 110; s.left.speed = 520.0f;
+    s.right.w = 14; s.right.h = 110; s.right.speed = 520.0f;
+
+    s.left.x = 40.0f;
+    s.right.x = (float)s.w - 40.0f;
+    s.left.y = s.right.y = s.h * 0.5f;
+
+    s.ball.r = 8.0f;
+
+    // Reset AI state
+    AIReset(s.aiR);
+    AIReset(s.aiL);
+
+    ResetRound(s, true);
+}
+
+// Sets up a fresh state sized w x h, sitting in the start menu.
+static void InitGame(PongState& s, int w, int h, uint32_t seed) {
+    s = PongState{};
+    s.w = (w > 0) ? w : 1;
+    s.h = (h > 0) ? h : 1;
+    s.rng = seed;
+    s.aiR.params = s.aiL.params = kPongAIDefaults;
+    ResetGame(s);
+    EnterStartMenu(s);
+}
+
+static bool CircleAABB(float cx, float cy, float r, float rx0, float ry0, float rx1, float ry1) {
+    float closestX = Clamp(cx, rx0, rx1);
+    float closestY = Clamp(cy, ry0, ry1);
+    float dx = cx - closestX;
+    float dy = cy - closestY;
+    return (dx*dx + dy*dy) <= (r*r);
+}
+
+// Earliest time in [0, tMax] at which a circle moving by (vx, vy) per second
+// touches the box, or false if it doesn't within tMax. Already touching
+// counts as t = 0. This is a ray cast against the box grown by r with
+// rounded corners: hit the grown box, and if the entry point lies in a
+// corner square, refine against that corner's circle instead.
+static bool SweepCircleAABB(float cx, float cy, float vx, float vy, float r,
+                            float rx0, float ry0, float rx1, float ry1, float tMax, float* tHit) {
+    if (CircleAABB(cx, cy, r, rx0, ry0, rx1, ry1)) {
+        *tHit = 0.0f;
+        return true;
+    }
+
+    // Slab test against the grown box.
+    float tEnter = 0.0f, tExit = tMax;
+    const float lo[2] = { rx0 - r, ry0 - r }, hi[2] = { rx1 + r, ry1 + r };
+    const float p[2] = { cx, cy }, v[2] = { vx, vy };
+    for (int a = 0; a < 2; a++) {
+        if (v[a] == 0.0f) {
+            if (p[a] < lo[a] || p[a] > hi[a]) return false;
+            continue;
+        }
+        float t0 = (lo[a] - p[a]) / v[a];
+        float t1 = (hi[a] - p[a]) / v[a];
+        if (t0 > t1) { float t = t0; t0 = t1; t1 = t; }
+        if (t0 > tEnter) tEnter = t0;
+        if (t1 < tExit) tExit = t1;
+        if (tEnter > tExit) return false;
+    }
+
+    float hx = cx + vx * tEnter, hy = cy + vy * tEnter;
+    bool outX = hx < rx0 || hx > rx1;
+    bool outY = hy < ry0 || hy > ry1;
+    if (!(outX && outY)) {
+        *tHit = tEnter;
+        return true;
+    }
+
+    // Corner square: the rounded box's surface there is the corner circle.
+    // Missing it means missing the box, as any path into the neighbouring
+    // face regions would cross the circle first.
+    float kx = (hx < rx0) ? rx0 : rx1, ky = (hy < ry0) ? ry0 : ry1;
+    float mx = cx - kx, my = cy - ky;
+    float a = vx * vx + vy * vy;
+    float b = mx * vx + my * vy;
+    float c = mx * mx + my * my - r * r;
+    float disc = b * b - a * c;
+    if (a == 0.0f || disc < 0.0f) return false;
+    float t = (-b - sqrtf(disc)) / a;
+    if (t < 0.0f || t > tMax) return false;
+    *tHit = t;
+    return true;
+}
+
+// Sends `b` back off paddle `p`. With aiReacts, the AI that owns the paddle
+// treats it as its return: it stops, counts the hit and waits out a new
+// delay. Chaos mode (pong_chaos.h) bounces its balls through this too, but
+// only lets the AI react to the ball it was watching.
+static void BounceBall(PongState& s, Ball& b, const Paddle& p, bool isLeft, bool aiReacts) {
+    float rel = (b.y - p.y) / (p.h * 0.5f);
+    rel = Clamp(rel, -1.0f, 1.0f);
+
+    float baseSpeed = 240.0f;
+    float extra = 70.0f * fabsf(rel);
+
+    float dir = isLeft ? 1.0f : -1.0f;
+    b.vx = dir * (baseSpeed + extra);
+    b.vy = rel * 320.0f;
+
+    if (isLeft) b.x = p.x + p.w * 0.5f + b.r + 1.0f;
+    else        b.x = p.x - p.w * 0.5f - b.r - 1.0f;
+
+    s.hits++;
+
+    // Track AI hits for perfect response feature
+    if (aiReacts && (isLeft ? s.aiLeft : s.aiMode)) {
+        PongAI& ai = isLeft ? s.aiL : s.aiR;
+        ai.hitCount++;
+        AIStop(ai);
+
+        // Every Nth hit (7th by default) gets perfect response (no movement delay)
+        if (ai.params.perfectEvery > 0 && ai.hitCount % ai.params.perfectEvery == 0) {
+            ai.moveDelayFrames = 0;
+        } else {
+            // Adaptive movement delay based on score
+            AIPickDelay(s, ai, isLeft ? s.scoreR - s.scoreL : s.scoreL - s.scoreR);
+        }
+        ai.targetY = p.y;
+    }
+}
+
+static void BounceFromPaddle(PongState& s, const Paddle& p, bool isLeft) {
+    BounceBall(s, s.ball, p, isLeft, true);
+}
+
+// Contacts resolved per ball step; anything past this is dropped rather
+// than risk tunnelling (only reachable with absurd step sizes).
+static const int kMaxBallEvents = 8;
+
+enum BallEvent { BALL_EVENT_NONE, BALL_EVENT_TOP, BALL_EVENT_BOTTOM, BALL_EVENT_LEFT, BALL_EVENT_RIGHT };
+
+// Moves the ball through dt seconds against the walls and both paddles (as
+// they stand after this step's paddle movement). Each contact is found at
+// its exact time of impact and resolved as usual (wall reflection,
+// BounceFromPaddle), then the rest of the step continues from there, so
+// the result doesn't depend on how dt is sliced.
+static void MoveBall(PongState& s, float dt) {
+    Ball& ball = s.ball;
+    const Paddle* paddles[2] = { &s.left, &s.right };
+
+    float remaining = dt;
+    for (int n = 0; n < kMaxBallEvents && remaining > 0.0f; n++) {
+        BallEvent ev = BALL_EVENT_NONE;
+        float tEv = remaining;
+
+        // Walls only count when the ball is moving into them.
+        if (ball.vy < 0.0f) {
+            float t = (ball.r - ball.y) / ball.vy;
+            if (t < 0.0f) t = 0.0f;
+            if (t <= tEv) { tEv = t; ev = BALL_EVENT_TOP; }
+        } else if (ball.vy > 0.0f) {
+            float t = ((float)s.h - ball.r - ball.y) / ball.vy;
+            if (t < 0.0f) t = 0.0f;
+            if (t <= tEv) { tEv = t; ev = BALL_EVENT_BOTTOM; }
+        }
+
+        // Paddles only count when the ball is heading toward the field edge
+        // they guard, as before.
+        for (int i = 0; i < 2; i++) {
+            if (i == 0 ? ball.vx >= 0.0f : ball.vx <= 0.0f) continue;
+            const Paddle& p = *paddles[i];
+            float t;
+            if (SweepCircleAABB(ball.x, ball.y, ball.vx, ball.vy, ball.r,
+                                p.x - p.w * 0.5f, p.y - p.h * 0.5f, p.x + p.w * 0.5f, p.y + p.h * 0.5f,
+                                tEv, &t) && (t < tEv || ev == BALL_EVENT_NONE)) {
+                tEv = t;
+                ev = (i == 0) ? BALL_EVENT_LEFT : BALL_EVENT_RIGHT;
+            }
+        }
+
+        ball.x += ball.vx * tEv;
+        ball.y += ball.vy * tEv;
+        remaining -= tEv;
+
+        switch (ev) {
+        case BALL_EVENT_NONE:
+            return;
+        case BALL_EVENT_TOP:
+            ball.y = ball.r;
+            ball.vy = -ball.vy;
+            break;
+        case BALL_EVENT_BOTTOM:
+            ball.y = (float)s.h - ball.r;
+            ball.vy = -ball.vy;
+            break;
+        case BALL_EVENT_LEFT:
+            BounceFromPaddle(s, s.left, true);
+            break;
+        case BALL_EVENT_RIGHT:
+            BounceFromPaddle(s, s.right, false);
+            break;
+        }
+    }
+}
+
+// The AI's paddle movement for this step. `incoming` is whether the ball
+// is moving towards its side.
+static float AIMove(PongAI& ai, const Paddle& p, const Ball& ball, bool incoming, float dt) {
+    const PongAIParams& k = ai.params;
+    const float frames = dt * kAiFrameHz;
+
+    // AI updates its perceived ball height only every checkFrames frames (reaction sampling)
+    if (ball.inPlay && incoming) {
+        ai.checkFrameCounter += frames;
+        if (ai.checkFrameCounter >= k.checkFrames - kAiFrameSlack) {
+            ai.targetY = ball.y;
+            ai.checkFrameCounter = 0.0f;
+        }
+    }
+
+    // Smooth movement: update a commanded velocity every N frames, then ease actual velocity toward it.
+    ai.moveFrameCounter += frames;
+    const int delay = (ai.moveDelayFrames < 0) ? 0 : ai.moveDelayFrames;
+    if (delay == 0 || ai.moveFrameCounter >= (float)delay - kAiFrameSlack) {
+        float diff = ai.targetY - p.y;
+        if (fabsf(diff) <= k.deadZone) {
+            ai.cmdVelY = 0.0f;
+        } else {
+            ai.cmdVelY = Clamp(diff * k.kp, -p.speed, p.speed);
+        }
+        ai.moveFrameCounter = 0.0f;
+    }
+
+    // Ease actual velocity toward command (prevents jitter when diff sign flips)
+    float dv = ai.cmdVelY - ai.velY;
+    float maxDv = k.accel * dt;
+    ai.velY += Clamp(dv, -maxDv, +maxDv);
+
+    float dy = ai.velY * dt;
+
+    // Prevent overshoot: if we're about to cross the target, snap to it and zero velocity.
+    float diffNow = ai.targetY - p.y;
+    if (fabsf(diffNow) <= fabsf(dy)) {
+        dy = diffNow;
+        ai.velY = 0.0f;
+        ai.cmdVelY = 0.0f;
+    }
+    return dy;
+}
+
+// Both paddles for one step: keys for human ones, AIMove for computer
+// ones, each AI watching the ball it is given.
+static void MovePaddles(PongState& s, const PongInput& in, const Ball& ballL, const Ball& ballR, float dt) {
+    Paddle& left = s.left;
+    Paddle& right = s.right;
+
+    // Left paddle (human controlled, or AI in headless AI-vs-AI matches)
+    float dyL = 0.0f;
+    if (s.aiLeft) {
+        dyL = AIMove(s.aiL, left, ballL, ballL.vx < 0, dt);
+    } else {
+        if (in.down & PONG_KEY_W) dyL -= left.speed * dt;
+        if (in.down & PONG_KEY_S) dyL += left.speed * dt;
+    }
+    left.y = Clamp(left.y + dyL, left.h * 0.5f, s.h - left.h * 0.5f);
+
+    // Right paddle (human or AI)
+    float dyR = 0.0f;
+    if (s.aiMode) {
+        dyR = AIMove(s.aiR, right, ballR, ballR.vx > 0, dt);
+    } else {
+        // Human control
+        if (in.down & PONG_KEY_UP) dyR -= right.speed * dt;
+        if (in.down & PONG_KEY_DOWN) dyR += right.speed * dt;
+    }
+    right.y = Clamp(right.y + dyR, right.h * 0.5f, s.h - right.h * 0.5f);
+}
+
+// Key changes partway through a step: calls step(input, dt) for up to
+// three pieces, each with the keys held over it, and returns true; false
+// when the step needs no split.
+//   [0, at)      the keys that were already held,
+//   [at, until)  every key pressed, taps included (pressed but no longer
+//                down, so a tap shorter than a step still moves a paddle),
+//   [until, 1)   the keys still down at the end.
+// What stays step-granular: every press counts from the first one (`at`),
+// every tap ends at the last tap release, and a key held into the step
+// and let go partway counts as up for all of it.
+template <typename Step>
+static inline bool PongSplitStep(const PongInput& in, float dt, Step&& step) {
+    const uint16_t taps = (uint16_t)(in.pressed & ~in.down);
+    const int until = (taps && in.until > in.at) ? in.until : 0;
+    if (!(in.at && in.at < 128) && !until) return false;
+    const float split = dt * (float)in.at * (1.0f / 128.0f);
+    const float end = until ? dt * (float)until * (1.0f / 128.0f) : dt;
+    if (in.at) {
+        PongInput early = {};
+        early.down = (uint16_t)(in.down & ~in.pressed);
+        step(early, split);
+    }
+    PongInput mid = in;
+    mid.down = (uint16_t)(in.down | (until ? taps : 0));
+    mid.at = 0;
+    mid.until = 0;
+    step(mid, end - split);
+    if (until) {
+        PongInput late = {};
+        late.down = in.down;
+        step(late, dt - end);
+    }
+    return true;
+}
+
+static void UpdateGame(PongState& s, const PongInput& in, float dt) {
+    if (PongSplitStep(in, dt, [&](const PongInput& part, float partDt) { UpdateGame(s, part, partDt); })) return;
+
+    if (in.pressed & PONG_KEY_R) ResetGame(s);
+
+    // Start menu: choose mode before playing
+    if (s.state == STATE_MENU) {
+        if (in.pressed & (PONG_KEY_UP | PONG_KEY_W)) s.menuSelection--;
+        if (in.pressed & (PONG_KEY_DOWN | PONG_KEY_S)) s.menuSelection++;
+        s.menuSelection = (int)Clamp((float)s.menuSelection, 0.0f, 1.0f);
+
+        if (in.pressed & PONG_KEY_1) s.menuSelection = 0;
+        if (in.pressed & PONG_KEY_2) s.menuSelection = 1;
+
+        if (in.pressed & (PONG_KEY_RETURN | PONG_KEY_SPACE | PONG_KEY_1 | PONG_KEY_2)) {
+            s.aiMode = (s.menuSelection == 1);
+            ResetGame(s);
+            s.state = STATE_PLAYING;
+        }
+        return;
+    }
+
+    MovePaddles(s, in, s.ball, s.ball, dt);
+
+    Ball& ball = s.ball;
+    if (!ball.inPlay && (in.pressed & PONG_KEY_SPACE)) ball.inPlay = true;
+
+    if (ball.inPlay) {
+        MoveBall(s, dt);
+
+        if (ball.x + ball.r < 0) {
+            s.scoreR++;
+            ResetRound(s, false);
+        } else if (ball.x - ball.r > s.w) {
+            s.scoreL++;
+            ResetRound(s, true);
+        }
+    }
+}
+
+// True when nothing can move until a key goes down: the menu, or a ball
+// waiting for its serve with any computer paddle settled on its target.
+// Front ends stop ticking and drawing then, and wait for input.
+static inline bool PongAtRest(const PongState& s) {
+    if (s.state == STATE_MENU) return true;
+    if (s.ball.inPlay) return false;
+    const PongAI* ai[2] = { s.aiLeft ? &s.aiL : nullptr, s.aiMode ? &s.aiR : nullptr };
+    const Paddle* p[2] = { &s.left, &s.right };
+    for (int i = 0; i < 2; i++) {
+        if (!ai[i]) continue;
+        if (ai[i]->velY != 0.0f || ai[i]->cmdVelY != 0.0f) return false;
+        if (fabsf(ai[i]->targetY - p[i]->y) > ai[i]->params.deadZone) return false;
+    }
+    return true;
+}
+
+// ======================================================
+// Replay support: one 32-bit input word per tick, and a state hash
+// ======================================================
+// Held keys in bits 0-8, the press point `at` in bits 9-15, pressed keys in
+// bits 16-24 and the tap release `until` in bits 25-31; words from before
+// `at` or `until` existed read back with them 0.
+static inline uint32_t PongInputBits(const PongInput& in) {
+    return (uint32_t)(in.down & 0x1FF) | ((uint32_t)(in.at & 0x7F) << 9) | ((uint32_t)(in.pressed & 0x1FF) << 16) |
+           ((uint32_t)(in.until & 0x7F) << 25);
+}
+
+static inline PongInput PongInputFromBits(uint32_t bits) {
+    PongInput in;
+    in.down = (uint16_t)(bits & 0x1FF);
+    in.at = (uint8_t)((bits >> 9) & 0x7F);
+    in.pressed = (uint16_t)((bits >> 16) & 0x1FF);
+    in.until = (uint8_t)(bits >> 25);
+    return in;
+}
+
+static inline uint64_t HashPaddle(uint64_t h, const Paddle& p) {
+    h = HashF32(h, p.x); h = HashF32(h, p.y);
+    h = HashF32(h, p.w); h = HashF32(h, p.h);
+    return HashF32(h, p.speed);
+}
+
+static inline uint64_t HashAI(uint64_t h, const PongAI& ai) {
+    h = HashF32(h, ai.targetY);
+    h = HashI32(h, ai.moveDelayFrames); h = HashF32(h, ai.moveFrameCounter);
+    h = HashF32(h, ai.checkFrameCounter); h = HashI32(h, ai.hitCount);
+    h = HashI32(h, ai.maxMoveDelay); h = HashF32(h, ai.cmdVelY);
+    return HashF32(h, ai.velY);
+}
+
+static inline uint64_t PongHash(const PongState& s) {
+    uint64_t h = kHashSeed;
+    h = HashI32(h, s.w); h = HashI32(h, s.h);
+    h = HashPaddle(h, s.left);
+    h = HashPaddle(h, s.right);
+    h = HashF32(h, s.ball.x); h = HashF32(h, s.ball.y); h = HashF32(h, s.ball.r);
+    h = HashF32(h, s.ball.vx); h = HashF32(h, s.ball.vy); h = HashU32(h, s.ball.inPlay);
+    h = HashI32(h, s.scoreL); h = HashI32(h, s.scoreR); h = HashI32(h, s.hits);
+    h = HashI32(h, s.state); h = HashI32(h, s.menuSelection);
+    h = HashU32(h, s.aiMode);
+    h = HashAI(h, s.aiR);
+    if (s.aiLeft) h = HashAI(HashU32(h, 1), s.aiL); // absent from older replays' hashes
+    return HashU32(h, s.rng);
+}
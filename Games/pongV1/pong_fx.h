@@ -0,0 +1,56 @@
+#pragma once
+#include <math.h>
+
+#include "pong_core.h"
+#include "../common/particles.h"
+
+// ======================================================
+// Pong particle effects
+//
+// Like the sounds, bursts come from comparing the state a frame shows with
+// the one the frame before showed, not from inside the core: BounceFromPaddle
+// and the scoring branch of UpdateGame stay deterministic, and a netplay
+// rollback that re-runs ticks doesn't fire their bursts twice.
+// Colours use the backbuffer's RGBX layout (red in the low byte).
+// ======================================================
+
+static const int kFxCapacity = 4096;
+static const float kFxGravity = 260.0f;   // px/s^2: sparks sag a little
+static const float kFxKeep = 0.15f;       // velocity left after a second
+
+static inline void PongEffects(ParticlePool& fx, const PongState& prev, const PongState& cur) {
+    const float pi = 3.14159265f;
+    if (cur.scoreL + cur.scoreR > prev.scoreL + prev.scoreR && prev.ball.inPlay) {
+        // A fountain back into the court from where the ball went out.
+        const bool outRight = cur.scoreL > prev.scoreL;
+        ParticleBurst b;
+        b.x = outRight ? (float)cur.w - 1.0f : 0.0f;
+        b.y = prev.ball.y;
+        b.angle = outRight ? pi : 0.0f;
+        b.spread = 1.3f;
+        b.speedMin = 80.0f;
+        b.speedMax = 700.0f;
+        b.lifeMin = 0.5f;
+        b.lifeMax = 1.3f;
+        b.color = 0x96EBFF;   // RGBX(255, 235, 150)
+        b.count = 400;
+        ParticleEmit(fx, b);
+        return;
+    }
+    if (cur.hits > prev.hits && cur.ball.inPlay) {
+        // Sparks off the paddle face, more as the rally goes on.
+        const int rally = cur.hits > 24 ? 24 : cur.hits;
+        ParticleBurst b;
+        b.x = cur.ball.x - (cur.ball.vx > 0.0f ? cur.ball.r : -cur.ball.r);
+        b.y = cur.ball.y;
+        b.angle = cur.ball.vx > 0.0f ? 0.0f : pi;
+        b.spread = 1.1f;
+        b.speedMin = 120.0f;
+        b.speedMax = 420.0f + 10.0f * (float)rally;
+        b.lifeMin = 0.25f;
+        b.lifeMax = 0.6f;
+        b.color = 0x04BAFC;   // the ball, RGBX(252, 186, 4)
+        b.count = 40 + 4 * rally;
+        ParticleEmit(fx, b);
+    }
+}
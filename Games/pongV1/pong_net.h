@@ -0,0 +1,320 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <chrono>
+
+#include "pong_core.h"
+
+// ======================================================
+// Rollback netcode for two-player Pong (platform-free)
+//
+// Each peer owns one paddle and simulates every frame the moment its own
+// input is known, so local input has no added latency. The other paddle's
+// input is predicted (keys held last time stay held, no new presses) until
+// the real one arrives; if it differs, the session restores the snapshot
+// from before that frame and re-simulates up to the present.
+//
+// The session only builds and parses packets; the caller moves them (UDP
+// in the game, loopback sockets plus NetLagQueue in tools/pong_netplay).
+// Inputs are resent until acknowledged, so lost packets just arrive later.
+// ======================================================
+
+enum {
+    kNetRing = 128,              // frames of snapshots and inputs kept (power of two)
+    kNetMaxPrediction = 40,      // frames we run ahead of the remote's input (333 ms at 120 Hz)
+    kNetMaxInputsPerPacket = 64,
+    kNetPacketMax = 32 + kNetMaxInputsPerPacket,
+};
+
+static const uint32_t kNetMagic = 0x4E47504E; // "NPGN"
+
+enum NetPacketType {
+    NET_HELLO = 1,     // client -> host, until welcomed
+    NET_WELCOME = 2,   // host -> client: seed, tick rate, playfield size
+    NET_INPUT = 3,
+};
+
+// One player's input for a frame.
+enum NetInputBits {
+    NET_UP = 1 << 0,
+    NET_DOWN = 1 << 1,
+    NET_SERVE = 1 << 2,   // pressed this frame
+};
+
+struct NetStats {
+    uint64_t frames;        // simulated once each
+    uint64_t stalls;        // ticks spent waiting for the remote
+    uint64_t rollbacks;
+    uint64_t resimFrames;
+    uint32_t maxRollback;   // deepest re-simulation, frames
+    double resimSecs;
+    uint64_t packetsIn, packetsOut;
+};
+
+struct NetSession {
+    int side;                  // 0 = left paddle, 1 = right
+    float dt;
+    PongState state;           // after frame - 1
+    uint32_t frame;            // next frame to simulate
+    uint32_t clock;            // NetTick calls, stalled or not
+
+    PongState snaps[kNetRing]; // state before each frame
+    uint8_t localIn[kNetRing];
+    uint8_t remoteIn[kNetRing];
+    uint8_t usedRemote[kNetRing];    // what each frame was simulated with
+    uint32_t remoteConfirmed;  // remote inputs known for frames < this
+    uint32_t remoteAcked;      // the remote has our inputs for frames < this
+    uint32_t rollbackFrom;     // earliest mispredicted frame, or UINT32_MAX
+
+    // Time sync (GGPO-style): frames each side thinks it is ahead by.
+    uint32_t remoteFrame;      // newest frame number the remote reported
+    int remoteAhead;
+    uint32_t echoClock, echoAt;   // remote clock of its newest packet, our clock then
+    int rttTicks;
+    float drift;               // smoothed (our lead - remote's lead), halved
+    uint32_t lastStall;
+
+    NetStats stats;
+};
+
+static inline PongInput NetToPong(int side, uint8_t bits) {
+    PongInput in{};
+    if (bits & NET_UP) in.down |= side ? PONG_KEY_UP : PONG_KEY_W;
+    if (bits & NET_DOWN) in.down |= side ? PONG_KEY_DOWN : PONG_KEY_S;
+    if (bits & NET_SERVE) in.pressed |= PONG_KEY_SPACE;
+    return in;
+}
+
+// Both players' inputs as one step for UpdateGame.
+static inline PongInput NetCombine(uint8_t left, uint8_t right) {
+    PongInput a = NetToPong(0, left), b = NetToPong(1, right);
+    PongInput in{};
+    in.down = (uint16_t)(a.down | b.down);
+    in.pressed = (uint16_t)(a.pressed | b.pressed);
+    return in;
+}
+
+// Both peers call this with the same seed (the host's, from NET_WELCOME).
+static inline void NetInit(NetSession& n, int side, uint32_t seed, int w, int h, uint32_t tickHz) {
+    memset(&n, 0, sizeof(n));
+    n.side = side;
+    n.dt = (float)(1.0 / (double)tickHz);
+    InitGame(n.state, w, h, seed);
+    n.state.aiMode = false;
+    ResetGame(n.state);
+    n.state.state = STATE_PLAYING;
+    n.rollbackFrom = UINT32_MAX;
+}
+
+static inline uint8_t NetRemoteFor(const NetSession& n, uint32_t f) {
+    if (f < n.remoteConfirmed) return n.remoteIn[f & (kNetRing - 1)];
+    if (n.remoteConfirmed == 0) return 0;
+    return (uint8_t)(n.remoteIn[(n.remoteConfirmed - 1) & (kNetRing - 1)] & ~NET_SERVE);
+}
+
+static inline void NetStep(NetSession& n, uint32_t f) {
+    uint8_t local = n.localIn[f & (kNetRing - 1)];
+    uint8_t remote = NetRemoteFor(n, f);
+    n.snaps[f & (kNetRing - 1)] = n.state;
+    n.usedRemote[f & (kNetRing - 1)] = remote;
+    UpdateGame(n.state, n.side ? NetCombine(remote, local) : NetCombine(local, remote), n.dt);
+}
+
+// Frames this peer is ahead of the remote, judged from the remote's last
+// report plus half the round trip.
+static inline int NetLocalAhead(const NetSession& n) {
+    return (int)n.frame - (int)(n.remoteFrame + (uint32_t)(n.rttTicks / 2));
+}
+
+// One fixed tick: re-simulate after any misprediction, then simulate the
+// next frame with `local` unless the session has to wait for the remote
+// (too far ahead to predict, or running a frame or more ahead of it on
+// average). Returns whether a new frame was simulated.
+static inline bool NetTick(NetSession& n, uint8_t local) {
+    n.clock++;
+    if (n.rollbackFrom < n.frame) {
+        auto t0 = std::chrono::steady_clock::now();
+        uint32_t depth = n.frame - n.rollbackFrom;
+        n.state = n.snaps[n.rollbackFrom & (kNetRing - 1)];
+        for (uint32_t f = n.rollbackFrom; f < n.frame; f++) NetStep(n, f);
+        n.stats.resimSecs += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        n.stats.rollbacks++;
+        n.stats.resimFrames += depth;
+        if (depth > n.stats.maxRollback) n.stats.maxRollback = depth;
+    }
+    n.rollbackFrom = UINT32_MAX;
+
+    bool tooFar = n.frame >= n.remoteConfirmed + kNetMaxPrediction;
+    // Leads are measured from jittery packets; act on their average, and
+    // give back at most every other tick so play never visibly freezes.
+    n.drift += ((float)(NetLocalAhead(n) - n.remoteAhead) * 0.5f - n.drift) * (1.0f / 32.0f);
+    bool ahead = n.drift >= 1.0f && n.clock - n.lastStall >= 2;
+    if (tooFar || ahead) {
+        n.stats.stalls++;
+        n.lastStall = n.clock;
+        return false;
+    }
+    n.localIn[n.frame & (kNetRing - 1)] = local;
+    NetStep(n, n.frame);
+    n.frame++;
+    n.stats.frames++;
+    return true;
+}
+
+// ---- Packets (little-endian) ----
+static inline void NetPut32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static inline uint32_t NetGet32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline int NetWriteHello(uint8_t* out) {
+    NetPut32(out, kNetMagic);
+    out[4] = NET_HELLO;
+    return 5;
+}
+
+static inline int NetWriteWelcome(uint8_t* out, uint32_t seed, uint32_t tickHz, int w, int h) {
+    NetPut32(out, kNetMagic);
+    out[4] = NET_WELCOME;
+    NetPut32(out + 5, seed);
+    NetPut32(out + 9, tickHz);
+    NetPut32(out + 13, (uint32_t)w);
+    NetPut32(out + 17, (uint32_t)h);
+    return 21;
+}
+
+// What both peers need to start identical sessions.
+struct NetWelcome {
+    uint32_t seed, tickHz;
+    int w, h;
+};
+
+static inline NetWelcome NetReadWelcome(const uint8_t* p) {
+    NetWelcome wel;
+    wel.seed = NetGet32(p + 5);
+    wel.tickHz = NetGet32(p + 9);
+    wel.w = (int)NetGet32(p + 13);
+    wel.h = (int)NetGet32(p + 17);
+    return wel;
+}
+
+// Packet type, or 0 if it isn't one of ours.
+static inline int NetPacketKind(const uint8_t* p, int size) {
+    if (size < 5 || NetGet32(p) != kNetMagic) return 0;
+    if (p[4] == NET_HELLO) return NET_HELLO;
+    if (p[4] == NET_WELCOME && size >= 21) return NET_WELCOME;
+    if (p[4] == NET_INPUT && size >= 28) return NET_INPUT;
+    return 0;
+}
+
+// Our unacknowledged inputs plus sync info:
+//   magic, type, u32 first, u8 count, u32 ack, u32 frame, i8 ahead,
+//   u32 clock, u32 echoClock, u16 echoHold, count input bytes
+static inline int NetWriteInput(NetSession& n, uint8_t* out) {
+    uint32_t first = n.remoteAcked;
+    if (n.frame - first > (uint32_t)kNetRing - 1) first = n.frame - (kNetRing - 1);
+    uint32_t count = n.frame - first;
+    if (count > (uint32_t)kNetMaxInputsPerPacket) count = kNetMaxInputsPerPacket;
+    int ahead = NetLocalAhead(n);
+    NetPut32(out, kNetMagic);
+    out[4] = NET_INPUT;
+    NetPut32(out + 5, first);
+    out[9] = (uint8_t)count;
+    NetPut32(out + 10, n.remoteConfirmed);
+    NetPut32(out + 14, n.frame);
+    out[18] = (uint8_t)(int8_t)(ahead < -127 ? -127 : ahead > 127 ? 127 : ahead);
+    NetPut32(out + 19, n.clock);
+    NetPut32(out + 23, n.echoClock);
+    uint32_t hold = n.clock - n.echoAt;
+    out[27] = (uint8_t)(hold > 255 ? 255 : hold);
+    for (uint32_t i = 0; i < count; i++) out[28 + i] = n.localIn[(first + i) & (kNetRing - 1)];
+    n.stats.packetsOut++;
+    return 28 + (int)count;
+}
+
+static inline void NetReceiveInput(NetSession& n, const uint8_t* p, int size) {
+    if (NetPacketKind(p, size) != NET_INPUT || size < 28 + p[9]) return;
+    n.stats.packetsIn++;
+    uint32_t first = NetGet32(p + 5), count = p[9];
+    uint32_t ack = NetGet32(p + 10), frame = NetGet32(p + 14);
+    uint32_t clock = NetGet32(p + 19), echo = NetGet32(p + 23);
+
+    if (ack > n.remoteAcked && ack <= n.frame) n.remoteAcked = ack;
+    if (frame >= n.remoteFrame) {
+        n.remoteFrame = frame;
+        n.remoteAhead = (int8_t)p[18];
+    }
+    if (clock >= n.echoClock) {
+        n.echoClock = clock;
+        n.echoAt = n.clock;
+        if (echo != 0) n.rttTicks = (int)(n.clock - echo) - p[27];
+    }
+
+    // Take the inputs that extend the confirmed run; older ones we have,
+    // gaps wait for a resend.
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t f = first + i;
+        if (f != n.remoteConfirmed) continue;
+        // Don't overwrite inputs a rollback may still need.
+        if (f >= n.frame + kNetRing - kNetMaxPrediction - 2) break;
+        uint8_t bits = p[28 + i];
+        n.remoteIn[f & (kNetRing - 1)] = bits;
+        if (f < n.frame && n.usedRemote[f & (kNetRing - 1)] != bits && f < n.rollbackFrom) n.rollbackFrom = f;
+        n.remoteConfirmed = f + 1;
+    }
+}
+
+// ======================================================
+// Artificial latency, jitter and loss for outgoing packets
+// ======================================================
+enum { kNetLagSlots = 512 };
+
+struct NetLagQueue {
+    double latency, jitter;   // seconds, one way
+    float loss;               // 0..1
+    uint64_t rng;
+    struct Slot { double due; int size; uint8_t data[kNetPacketMax]; } slots[kNetLagSlots];
+    int count;
+    uint64_t dropped;
+};
+
+static inline void NetLagInit(NetLagQueue& q, double latency, double jitter, float loss, uint64_t seed) {
+    memset(&q, 0, sizeof(q));
+    q.latency = latency;
+    q.jitter = jitter;
+    q.loss = loss;
+    q.rng = seed | 1;
+}
+
+static inline double NetLagRand(NetLagQueue& q) { // [0, 1)
+    q.rng ^= q.rng << 13; q.rng ^= q.rng >> 7; q.rng ^= q.rng << 17;
+    return (double)(q.rng >> 11) / 9007199254740992.0;
+}
+
+// Queues a packet sent at time `now`; it may be dropped.
+static inline void NetLagPush(NetLagQueue& q, const uint8_t* data, int size, double now) {
+    if (NetLagRand(q) < q.loss || q.count == kNetLagSlots || size > kNetPacketMax) {
+        q.dropped++;
+        return;
+    }
+    NetLagQueue::Slot& s = q.slots[q.count++];
+    s.due = now + q.latency + q.jitter * NetLagRand(q);
+    s.size = size;
+    memcpy(s.data, data, (size_t)size);
+}
+
+// Copies out one packet due by `now` (earliest first); returns its size or 0.
+static inline int NetLagPop(NetLagQueue& q, double now, uint8_t* out) {
+    int best = -1;
+    for (int i = 0; i < q.count; i++) {
+        if (q.slots[i].due <= now && (best < 0 || q.slots[i].due < q.slots[best].due)) best = i;
+    }
+    if (best < 0) return 0;
+    int size = q.slots[best].size;
+    memcpy(out, q.slots[best].data, (size_t)size);
+    q.slots[best] = q.slots[--q.count];
+    return size;
+}
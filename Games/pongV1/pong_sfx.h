@@ -0,0 +1,34 @@
+#pragma once
+#include "pong_core.h"
+#include "../common/synth.h"
+
+// ======================================================
+// Pong sound effects
+//
+// Sounds come from comparing two consecutive tick states, so the core
+// stays silent and anything that steps a PongState (the live game, a
+// replay, a headless match) can be heard the same way.
+// ======================================================
+
+//                                      wave           f0     f1     att     hold   rel    vol    duty
+static const SynthSound kSfxPaddle = { SYNTH_SQUARE,   480,   520,   0.002f, 0.03f, 0.05f, 0.35f, 0.5f };
+static const SynthSound kSfxWall   = { SYNTH_SQUARE,   240,   230,   0.002f, 0.02f, 0.04f, 0.30f, 0.5f };
+static const SynthSound kSfxScore  = { SYNTH_TRIANGLE, 660,   110,   0.005f, 0.10f, 0.30f, 0.50f, 0.5f };
+static const SynthSound kSfxServe  = { SYNTH_NOISE,    6000,  3000,  0.001f, 0.00f, 0.05f, 0.20f, 0.5f };
+
+// Triggers the sounds for what happened between prev and cur (one tick).
+static inline void PongSounds(Synth& synth, const PongState& prev, const PongState& cur, double now) {
+    if (cur.scoreL + cur.scoreR > prev.scoreL + prev.scoreR) {
+        SynthPlay(synth, kSfxScore, 1.0f, now);
+        return;
+    }
+    if (!prev.ball.inPlay && cur.ball.inPlay) SynthPlay(synth, kSfxServe, 1.0f, now);
+    if (!prev.ball.inPlay || !cur.ball.inPlay) return;
+    if (cur.hits > prev.hits) {
+        // The blip climbs a little as the rally goes on.
+        int rally = cur.hits > 24 ? 24 : cur.hits;
+        SynthPlay(synth, kSfxPaddle, 1.0f + 0.03f * (float)rally, now);
+    } else if ((cur.ball.vy < 0.0f) != (prev.ball.vy < 0.0f)) {
+        SynthPlay(synth, kSfxWall, 1.0f, now);
+    }
+}
@@ -0,0 +1,331 @@
+// Microbenchmarks for the rendering and physics primitives of both games.
+//
+// Times Pong's Clear and FillRectI (the RasterClear/RasterFillRect kernels
+// they wrap), CircleAABB and UpdateGame, and Bird Up's step_game, lerp_rgb
+// (RasterLerpRGB) and draw_game, primitive and cached, on the sizes the games
+// actually run at. Each benchmark is calibrated to ~10 ms per sample and
+// reports the median and fastest of several samples as ns/op, plus pixels/s
+// for the fill and draw benchmarks (frame area per second for draw_game).
+//
+// --json writes the results in a fixed layout, one result per line, so two
+// runs can be diffed or fed to `bench compare`, which prints the change in
+// median ns/op per benchmark.
+//
+// Build: make -C tools bench   (or g++ -O2 -std=c++11 tools/bench.cpp -o bench)
+// Usage: bench [--quick] [--filter=substr] [--json=out.json]
+//        bench compare <old.json> <new.json>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "../Games/pongV1/pong_core.h"
+#include "../Games/Bird Up/birdup_sprites.h"
+
+static const int kSchema = 1;
+
+struct BenchResult {
+    std::string name, size;
+    double nsPerOp;       // median sample
+    double nsMin;         // fastest sample
+    double pixelsPerSec;  // 0 when the op doesn't touch pixels
+    long long opsPerSample;
+    int samples;
+};
+
+struct BenchConfig {
+    const char* filter;
+    int samples;
+    double sampleSecs;
+};
+
+// Keeps results alive so the optimizer can't drop the work.
+static volatile uint64_t g_sink;
+
+static std::vector<BenchResult> g_results;
+static FILE* g_table; // human-readable lines; stderr when the JSON goes to stdout
+
+// Runs `body(n)` (which must perform n ops) enough times per sample to take
+// about cfg.sampleSecs, then records the median and minimum per-op time.
+template <typename F>
+static void Run(const BenchConfig& cfg, const char* name, const char* size, double pixelsPerOp, F&& body) {
+    std::string full = std::string(name) + " " + size;
+    if (cfg.filter && !strstr(full.c_str(), cfg.filter)) return;
+
+    typedef std::chrono::steady_clock Clock;
+    long long n = 1;
+    body(n); // warm caches and branch predictors
+    for (;;) {
+        auto t0 = Clock::now();
+        body(n);
+        double secs = std::chrono::duration<double>(Clock::now() - t0).count();
+        if (secs >= cfg.sampleSecs * 0.5 || n >= (1LL << 40)) {
+            if (secs > 0.0) n = (long long)(n * (cfg.sampleSecs / secs)) + 1;
+            break;
+        }
+        n *= (secs > 0.0 && secs * 8 < cfg.sampleSecs) ? 8 : 2;
+    }
+
+    std::vector<double> ns;
+    for (int i = 0; i < cfg.samples; i++) {
+        auto t0 = Clock::now();
+        body(n);
+        ns.push_back(std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / (double)n);
+    }
+    std::sort(ns.begin(), ns.end());
+
+    BenchResult r;
+    r.name = name;
+    r.size = size;
+    r.nsPerOp = ns[ns.size() / 2];
+    r.nsMin = ns[0];
+    r.pixelsPerSec = pixelsPerOp > 0.0 ? pixelsPerOp * 1e9 / r.nsPerOp : 0.0;
+    r.opsPerSample = n;
+    r.samples = cfg.samples;
+    fprintf(g_table, "%-24s %-10s %12.2f ns/op  (min %10.2f)", r.name.c_str(), r.size.c_str(), r.nsPerOp, r.nsMin);
+    if (r.pixelsPerSec > 0.0) fprintf(g_table, "  %8.3f Gpx/s", r.pixelsPerSec * 1e-9);
+    fprintf(g_table, "\n");
+    fflush(g_table);
+    g_results.push_back(r);
+}
+
+static std::string SizeStr(int w, int h) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%dx%d", w, h);
+    return buf;
+}
+
+// ======================================================
+// Pong
+// ======================================================
+static void BenchPongRaster(const BenchConfig& cfg, int w, int h) {
+    std::vector<uint32_t> pixels((size_t)w * h);
+    Surface s = { pixels.data(), w, h, w };
+    std::string sz = SizeStr(w, h);
+
+    Run(cfg, "pong.Clear", sz.c_str(), (double)w * h, [&](long long n) {
+        for (long long i = 0; i < n; i++) RasterClear(s, (uint32_t)i);
+        g_sink += s.pixels[(size_t)(w * h) - 1];
+    });
+    // A paddle, and a rect half the screen wide with unaligned edges.
+    Run(cfg, "pong.FillRectI.paddle", sz.c_str(), 12.0 * 90.0, [&](long long n) {
+        for (long long i = 0; i < n; i++) {
+            int y = (int)(i & 255);
+            RasterFillRect(s, 30, y, 42, y + 90, (uint32_t)i);
+        }
+        g_sink += s.pixels[(size_t)100 * w + 35];
+    });
+    int x0 = w / 4 + 3, y0 = h / 4 + 1, x1 = x0 + w / 2, y1 = y0 + h / 2;
+    Run(cfg, "pong.FillRectI.half", sz.c_str(), (double)(x1 - x0) * (y1 - y0), [&](long long n) {
+        for (long long i = 0; i < n; i++) RasterFillRect(s, x0, y0, x1, y1, (uint32_t)i);
+        g_sink += s.pixels[(size_t)y0 * w + x0];
+    });
+}
+
+static void BenchPongPhysics(const BenchConfig& cfg) {
+    // Ball/paddle pairs scattered around a paddle, about half overlapping.
+    struct Case { float cx, cy, r, x0, y0, x1, y1; };
+    std::vector<Case> cases(1024);
+    uint32_t rng = 12345;
+    for (Case& c : cases) {
+        rng = rng * 1664525u + 1013904223u;
+        c.cx = 400.0f + (float)(rng >> 24) * 0.25f - 32.0f;
+        rng = rng * 1664525u + 1013904223u;
+        c.cy = 300.0f + (float)(rng >> 24) * 0.75f - 96.0f;
+        c.r = 8.0f;
+        c.x0 = 394.0f; c.x1 = 406.0f;
+        c.y0 = 255.0f; c.y1 = 345.0f;
+    }
+    Run(cfg, "pong.CircleAABB", "-", 0.0, [&](long long n) {
+        uint64_t hits = 0;
+        for (long long i = 0; i < n; i++) {
+            const Case& c = cases[(size_t)i & 1023];
+            hits += CircleAABB(c.cx, c.cy, c.r, c.x0, c.y0, c.x1, c.y1);
+        }
+        g_sink += hits;
+    });
+
+    // One AI match tick at 120 Hz, over a pool of matches in play.
+    std::vector<PongState> games(256);
+    for (size_t i = 0; i < games.size(); i++) {
+        InitGame(games[i], 800, 600, 0x9E3779B9u * (uint32_t)(i + 1));
+        games[i].aiMode = true;
+        ResetGame(games[i]);
+        games[i].state = STATE_PLAYING;
+    }
+    Run(cfg, "pong.UpdateGame", "800x600", 0.0, [&](long long n) {
+        PongInput in{};
+        in.pressed = PONG_KEY_SPACE;
+        for (long long i = 0; i < n; i++) UpdateGame(games[(size_t)i & 255], in, 1.0f / 120.0f);
+        g_sink += games[0].hits;
+    });
+}
+
+// ======================================================
+// Bird Up
+// ======================================================
+// Seeded autopilot run (as birdup_render plays it) for the draw benchmarks.
+static std::vector<BirdGame> RecordBirdRun(int w, int h, int frames) {
+    BirdGame g;
+    bird_init(&g, w, h, 1);
+    std::vector<BirdGame> states;
+    for (int f = 0; f < frames; ++f) {
+        float gap = g.obs[0].gapY;
+        float best = 1e30f;
+        for (int k = 0; k < OB_COUNT; ++k) {
+            float right = g.obs[k].x + (float)OB_W;
+            if (right >= (float)(BIRD_X - BIRD_R) && g.obs[k].x < best) { best = g.obs[k].x; gap = g.obs[k].gapY; }
+        }
+        if (g.birdV > 0.0f && g.birdY > gap + 10.0f) flap(&g);
+        step_game(&g, 1.0f / 60.0f);
+        if (!g.alive) reset_game(&g);
+        states.push_back(g);
+    }
+    return states;
+}
+
+static void BenchBirdCore(const BenchConfig& cfg) {
+    std::vector<BirdGame> birds(256);
+    for (size_t i = 0; i < birds.size(); i++) bird_init(&birds[i], 640, 480, (uint32_t)i + 1);
+    Run(cfg, "bird.step_game", "640x480", 0.0, [&](long long n) {
+        for (long long i = 0; i < n; i++) {
+            BirdGame* g = &birds[(size_t)i & 255];
+            if (g->birdV > 150.0f) flap(g);
+            step_game(g, 1.0f / 120.0f);
+            if (!g->alive) reset_game(g);
+        }
+        g_sink += (uint64_t)birds[0].score;
+    });
+
+    Run(cfg, "bird.lerp_rgb", "-", 0.0, [&](long long n) {
+        uint32_t acc = 0;
+        for (long long i = 0; i < n; i++) acc += RasterLerpRGB(C_SKY_TOP, C_SKY_BOT, (float)(i & 1023) * (1.0f / 1023.0f));
+        g_sink += acc;
+    });
+}
+
+static void BenchBirdDraw(const BenchConfig& cfg, int w, int h) {
+    std::vector<BirdGame> states = RecordBirdRun(w, h, 240);
+    std::vector<uint32_t> pixels((size_t)w * h);
+    Surface s = { pixels.data(), w, h, w };
+    std::string sz = SizeStr(w, h);
+
+    Run(cfg, "bird.draw_game", sz.c_str(), (double)w * h, [&](long long n) {
+        for (long long i = 0; i < n; i++) draw_game(s, &states[(size_t)(i % 240)]);
+        g_sink += s.pixels[0];
+    });
+
+    BirdSprites sprites = {};
+    if (!bake_sprites(&sprites, w, h)) return;
+    Run(cfg, "bird.draw_game_cached", sz.c_str(), (double)w * h, [&](long long n) {
+        for (long long i = 0; i < n; i++) draw_game_cached(s, &sprites, &states[(size_t)(i % 240)]);
+        g_sink += s.pixels[0];
+    });
+    free_sprites(&sprites);
+}
+
+// ======================================================
+// JSON
+// ======================================================
+static bool WriteJson(const char* path) {
+    FILE* f = strcmp(path, "-") == 0 ? stdout : fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "{\n  \"schema\": %d,\n  \"results\": [\n", kSchema);
+    for (size_t i = 0; i < g_results.size(); i++) {
+        const BenchResult& r = g_results[i];
+        fprintf(f, "    {\"name\": \"%s\", \"size\": \"%s\", \"ns_per_op\": %.3f, \"ns_min\": %.3f, "
+                   "\"pixels_per_sec\": %.0f, \"ops_per_sample\": %lld, \"samples\": %d}%s\n",
+                r.name.c_str(), r.size.c_str(), r.nsPerOp, r.nsMin, r.pixelsPerSec, r.opsPerSample, r.samples,
+                i + 1 < g_results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    return f == stdout ? true : fclose(f) == 0;
+}
+
+// Reads back the result lines WriteJson produces.
+static bool ReadJson(const char* path, std::vector<BenchResult>& out) {
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        char name[128], size[64];
+        BenchResult r = {};
+        if (sscanf(line, " {\"name\": \"%127[^\"]\", \"size\": \"%63[^\"]\", \"ns_per_op\": %lf, \"ns_min\": %lf",
+                   name, size, &r.nsPerOp, &r.nsMin) == 4) {
+            r.name = name;
+            r.size = size;
+            out.push_back(r);
+        }
+    }
+    fclose(f);
+    return true;
+}
+
+static int Compare(const char* oldPath, const char* newPath) {
+    std::vector<BenchResult> a, b;
+    if (!ReadJson(oldPath, a) || !ReadJson(newPath, b)) {
+        fprintf(stderr, "could not read %s or %s\n", oldPath, newPath);
+        return 1;
+    }
+    printf("%-24s %-10s %12s %12s %8s\n", "benchmark", "size", "old ns/op", "new ns/op", "change");
+    for (const BenchResult& nr : b) {
+        const BenchResult* orr = nullptr;
+        for (const BenchResult& r : a) {
+            if (r.name == nr.name && r.size == nr.size) orr = &r;
+        }
+        if (!orr) {
+            printf("%-24s %-10s %12s %12.2f %8s\n", nr.name.c_str(), nr.size.c_str(), "-", nr.nsPerOp, "new");
+            continue;
+        }
+        double change = (nr.nsPerOp / orr->nsPerOp - 1.0) * 100.0;
+        printf("%-24s %-10s %12.2f %12.2f %+7.1f%%\n", nr.name.c_str(), nr.size.c_str(), orr->nsPerOp, nr.nsPerOp,
+               change);
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && strcmp(argv[1], "compare") == 0) {
+        if (argc != 4) {
+            fprintf(stderr, "usage: %s compare <old.json> <new.json>\n", argv[0]);
+            return 1;
+        }
+        return Compare(argv[2], argv[3]);
+    }
+
+    BenchConfig cfg = { nullptr, 9, 0.01 };
+    const char* jsonPath = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            cfg.samples = 3;
+            cfg.sampleSecs = 0.002;
+        } else if (strncmp(argv[i], "--filter=", 9) == 0) {
+            cfg.filter = argv[i] + 9;
+        } else if (strncmp(argv[i], "--json=", 7) == 0) {
+            jsonPath = argv[i] + 7;
+        } else {
+            fprintf(stderr, "usage: %s [--quick] [--filter=substr] [--json=out.json]\n"
+                            "       %s compare <old.json> <new.json>\n", argv[0], argv[0]);
+            return 1;
+        }
+    }
+    g_table = (jsonPath && strcmp(jsonPath, "-") == 0) ? stderr : stdout;
+
+    BenchPongRaster(cfg, 800, 600);
+    BenchPongRaster(cfg, 1920, 1080);
+    BenchPongPhysics(cfg);
+    BenchBirdCore(cfg);
+    BenchBirdDraw(cfg, 640, 480);
+    BenchBirdDraw(cfg, 1920, 1080);
+
+    if (jsonPath) {
+        if (!WriteJson(jsonPath)) {
+            fprintf(stderr, "failed to write %s\n", jsonPath);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,126 @@
+// Headless Bird Up renderer.
+//
+// Plays a seeded autopilot run through the platform-free core, rasterizes
+// every frame into a memory buffer twice, once with the draw_* primitives
+// (birdup_draw.h) and once from the sprite cache (birdup_sprites.h), and
+// reports ms/frame for each plus a checksum of the final image. Exits
+// non-zero if the two paths ever disagree. Optionally writes the image as PPM.
+//
+// Build: g++ -O2 -std=c++11 tools/birdup_render.cpp -o birdup_render
+// Usage: birdup_render [frames=600] [width=640] [height=480] [out.ppm]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <chrono>
+
+#include "../Games/Bird Up/birdup_sprites.h"
+
+// FNV-1a over the pixel buffer.
+static uint32_t hash_pixels(const Surface& s)
+{
+    uint32_t h = 2166136261u;
+    for (int y = 0; y < s.h; ++y) {
+        const uint8_t* p = (const uint8_t*)(s.pixels + (size_t)y * s.stride);
+        for (int i = 0; i < s.w * 4; ++i) h = (h ^ p[i]) * 16777619u;
+    }
+    return h;
+}
+
+static bool write_ppm(const char* path, const Surface& s)
+{
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    fprintf(f, "P6\n%d %d\n255\n", s.w, s.h);
+    for (int y = 0; y < s.h; ++y) {
+        for (int x = 0; x < s.w; ++x) {
+            uint32_t c = s.pixels[(size_t)y * s.stride + x];
+            uint8_t rgb[3] = { (uint8_t)(c >> 16), (uint8_t)(c >> 8), (uint8_t)c };
+            fwrite(rgb, 1, 3, f);
+        }
+    }
+    return fclose(f) == 0;
+}
+
+int main(int argc, char** argv)
+{
+    int frames = (argc > 1) ? atoi(argv[1]) : 600;
+    int w = (argc > 2) ? atoi(argv[2]) : 640;
+    int h = (argc > 3) ? atoi(argv[3]) : 480;
+    const char* out = (argc > 4) ? argv[4] : nullptr;
+    if (frames < 1 || w < 64 || h < 320) {
+        fprintf(stderr, "usage: %s [frames] [width>=64] [height>=320] [out.ppm]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<uint32_t> pixels((size_t)w * h), cached((size_t)w * h);
+    Surface s = { pixels.data(), w, h, w };
+    Surface sc = { cached.data(), w, h, w };
+
+    BirdSprites sprites = {};
+    auto b0 = std::chrono::steady_clock::now();
+    if (!bake_sprites(&sprites, w, h)) {
+        fprintf(stderr, "out of memory baking sprites\n");
+        return 1;
+    }
+    double bakeSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - b0).count();
+
+    BirdGame g = {};
+    g.w = w;
+    g.h = h;
+    g.seed = 1;
+    reset_game(&g);
+
+    // Play the run first so each renderer is timed over the same states in
+    // its own pass, then compare the two outputs frame by frame.
+    std::vector<BirdGame> states;
+    states.reserve(frames);
+    for (int f = 0; f < frames; ++f) {
+        // Simple autopilot so the run shows obstacles rather than a dead bird.
+        float gap = g.obs[0].gapY;
+        float best = 1e30f;
+        for (int k = 0; k < OB_COUNT; ++k) {
+            float right = g.obs[k].x + (float)OB_W;
+            if (right >= (float)(BIRD_X - BIRD_R) && g.obs[k].x < best) { best = g.obs[k].x; gap = g.obs[k].gapY; }
+        }
+        if (g.birdV > 0.0f && g.birdY > gap + 10.0f) flap(&g);
+        step_game(&g, 1.0f / 60.0f);
+        if (!g.alive) reset_game(&g);
+        states.push_back(g);
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; ++f) draw_game(s, &states[f]);
+    auto t1 = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; ++f) draw_game_cached(sc, &sprites, &states[f]);
+    auto t2 = std::chrono::steady_clock::now();
+    double secs = std::chrono::duration<double>(t1 - t0).count();
+    double cachedSecs = std::chrono::duration<double>(t2 - t1).count();
+
+    int mismatches = 0;
+    for (int f = 0; f < frames; ++f) {
+        draw_game(s, &states[f]);
+        draw_game_cached(sc, &sprites, &states[f]);
+        if (memcmp(pixels.data(), cached.data(), pixels.size() * 4) != 0) ++mismatches;
+    }
+    free_sprites(&sprites);
+
+    printf("frames:     %d at %dx%d\n", frames, w, h);
+    printf("bake ms:    %.4f\n", bakeSecs * 1e3);
+    printf("ms/frame:   %.4f primitives, %.4f cached (%.2fx)\n", secs * 1e3 / frames,
+           cachedSecs * 1e3 / frames, cachedSecs > 0.0 ? secs / cachedSecs : 0.0);
+    printf("score:      %d\n", g.score);
+    printf("checksum:   %08x\n", hash_pixels(s));
+    if (out) {
+        if (!write_ppm(out, s)) {
+            fprintf(stderr, "failed to write %s\n", out);
+            return 1;
+        }
+        printf("wrote:      %s\n", out);
+    }
+    if (mismatches) {
+        fprintf(stderr, "cached path differs from primitives on %d frames\n", mismatches);
+        return 1;
+    }
+    return 0;
+}
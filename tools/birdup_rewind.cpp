@@ -0,0 +1,119 @@
+// Headless checks for the Bird Up rewind ring (birdup_rewind.h).
+//
+// Plays a long autopilot run (the demo pilot, restarting after crashes)
+// and records every tick into the ring, then:
+//   - seeks to every tick still held and compares it with the state a
+//     straight re-simulation of the same inputs reaches,
+//   - rewinds to random ticks, branches from there and checks the ring
+//     keeps matching the re-simulation,
+//   - checks rnd_skip and gap_ahead against stepping the LCG.
+// Reports bytes per tick and ns per seek. Exits non-zero on any mismatch.
+//
+// Build: g++ -O2 -std=c++11 tools/birdup_rewind.cpp -o birdup_rewind
+// Usage: birdup_rewind [ticks=100000] [seed=1]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#include "../Games/Bird Up/birdup_rewind.h"
+#include "../Games/Bird Up/birdup_pilot.h"
+#include "../Games/Bird Up/birdup_demo_pilot.h"
+
+static const float kDt = 1.0f / 120.0f;
+
+static bool same(const BirdGame& a, const BirdGame& b)
+{
+    return memcmp(&a, &b, sizeof(BirdGame)) == 0;
+}
+
+int main(int argc, char** argv)
+{
+    int ticks = (argc > 1) ? atoi(argv[1]) : 100000;
+    uint32_t seed = (argc > 2) ? (uint32_t)strtoul(argv[2], nullptr, 10) : 1;
+    if (ticks < 1) {
+        fprintf(stderr, "usage: %s [ticks] [seed]\n", argv[0]);
+        return 1;
+    }
+    int failures = 0;
+
+    // Straight simulation: inputs and the state after each tick (tick 0 is
+    // the initial state).
+    std::vector<uint32_t> inputs((size_t)ticks);
+    std::vector<BirdGame> states((size_t)ticks + 1);
+    BirdGame g;
+    bird_init(&g, 640, 480, seed);
+    states[0] = g;
+    for (int t = 0; t < ticks; ++t) {
+        inputs[(size_t)t] = pilot_input(BIRD_DEMO_PILOT, &g);
+        bird_tick(&g, inputs[(size_t)t], kDt);
+        states[(size_t)t + 1] = g;
+    }
+
+    static BirdRewind ring;
+    rewind_reset(&ring);
+    for (int t = 0; t <= ticks; ++t) rewind_push(&ring, &states[(size_t)t]);
+
+    int held = (int)(ring.next - ring.first), bad = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint64_t t = ring.first; t < ring.next; ++t) {
+        BirdGame s;
+        if (!rewind_seek(&ring, t, &s) || !same(s, states[(size_t)t])) ++bad;
+    }
+    double seekNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / held;
+    printf("held:      ticks %llu..%llu (%d, %.1f s at 120 Hz) in %d KB\n", (unsigned long long)ring.first,
+           (unsigned long long)ring.next - 1, held, held / 120.0, REWIND_BYTES / 1024);
+    printf("size:      %.1f bytes/tick (full snapshot %d), %.1f ns/seek\n",
+           (double)rewind_bytes_used(&ring) / held, (int)sizeof(BirdGame), seekNs);
+    printf("seek:      %d/%d ticks differ from re-simulation\n", bad, held);
+    failures += bad;
+
+    // Branching: rewind to a random held tick, replay the same inputs from
+    // there through the ring, and check the ring follows the reference.
+    uint32_t rng = seed * 2654435761u + 1;
+    int branchBad = 0;
+    const int branches = 200;
+    for (int b = 0; b < branches; ++b) {
+        rng = rng * 1664525u + 1013904223u;
+        uint64_t span = ring.next - ring.first;
+        uint64_t at = ring.first + (rng >> 8) % span;
+        BirdGame s;
+        rewind_seek(&ring, at, &s);
+        rewind_truncate(&ring, at);
+        for (uint64_t t = at; t < (uint64_t)ticks; ++t) {
+            bird_tick(&s, inputs[(size_t)t], kDt);
+            rewind_push(&ring, &s);
+        }
+        BirdGame back;
+        uint64_t probe = ring.first + (rng >> 4) % (ring.next - ring.first);
+        if (!same(s, states[(size_t)ticks]) || !rewind_seek(&ring, probe, &back) || !same(back, states[(size_t)probe]))
+            ++branchBad;
+    }
+    printf("branch:    %d/%d rewinds diverged from re-simulation\n", branchBad, branches);
+    failures += branchBad;
+
+    // Jump-ahead against stepping.
+    int skipBad = 0;
+    BirdGame lcg = {};
+    lcg.seed = seed;
+    for (uint64_t n = 0; n < 5000; ++n) {
+        if (rnd_skip(seed, n) != lcg.seed) ++skipBad;
+        rnd_u32(&lcg);
+    }
+    BirdGame ahead = states[0];
+    std::vector<float> predicted;
+    for (int k = 1; k <= 64; ++k) predicted.push_back(gap_ahead(&ahead, (uint64_t)k));
+    for (int k = 0; k < 64; ++k) {
+        if (random_gap_y(&ahead) != predicted[(size_t)k]) ++skipBad;
+    }
+    auto j0 = std::chrono::steady_clock::now();
+    uint32_t sink = 0;
+    for (uint64_t n = 1; n <= 1000000; ++n) sink += rnd_skip(seed, n * 0x9E3779B97F4Aull);
+    double skipNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - j0).count() / 1e6;
+    printf("skip:      %d mismatches vs stepping; %.1f ns per jump of up to 2^64 draws (%08x)\n", skipBad, skipNs, sink);
+    failures += skipBad;
+
+    printf("%s\n", failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,256 @@
+// Neuroevolution trainer for Bird Up autopilots (birdup_pilot.h).
+//
+// Each generation, the whole population flies the same set of freshly
+// seeded episodes. An episode is one BirdBatch (birdup_batch.h): every
+// controller is a lane in one shared obstacle world, so the world is
+// stepped once per tick for all of them. Episodes are spread over all
+// cores; each worker owns a batch, flap and tick buffers allocated once up
+// front, so evaluation does no heap allocation at all. Fitness is the mean
+// number of columns passed, plus a fraction for time survived.
+//
+// The elites survive unchanged and the rest of the next generation are
+// mutated copies of them. Results don't depend on --threads: every episode
+// writes its own slot, and mutation runs on one seeded stream.
+//
+// --export writes the best controller as a header of PILOT_WEIGHTS floats;
+// the game embeds Games/Bird Up/birdup_demo_pilot.h for its demo mode.
+// `check` scores that built-in pilot on unseen seeds instead.
+//
+// Build: g++ -O2 -std=c++11 -pthread tools/birdup_train.cpp -o birdup_train
+// Usage: birdup_train [--gens=60] [--pop=512] [--episodes=16] [--secs=60] [--threads=N]
+//                     [--seed=1] [--export=birdup_demo_pilot.h]
+//        birdup_train check [episodes=200] [secs=120]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "../Games/Bird Up/birdup_batch.h"
+#include "../Games/Bird Up/birdup_pilot.h"
+#include "../Games/Bird Up/birdup_demo_pilot.h"
+
+static const int kW = 640, kH = 480;
+static const int kTickHz = 120;
+
+static uint64_t mix64(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// Normal deviates for initial weights and mutation.
+struct Rng
+{
+    uint64_t s;
+    float uniform() { s = mix64(s); return (float)((s >> 40) + 0.5) / 16777216.0f; }
+    float normal() { return sqrtf(-2.0f * logf(uniform())) * cosf(6.2831853f * uniform()); }
+};
+
+struct Config
+{
+    int gens, pop, episodes, threads, elites;
+    float secs, sigma;
+    uint64_t seed;
+    const char* exportPath;
+};
+
+// One worker's episode state, allocated once.
+struct Arena
+{
+    BirdBatch batch;
+    int32_t* flaps;
+    int32_t* ticks;     // ticks each lane stayed alive
+};
+
+static bool arena_init(Arena* a, int pop)
+{
+    if (!bird_batch_init(&a->batch, pop, kW, kH, -1)) return false;
+    a->flaps = (int32_t*)NgAlignedAlloc((size_t)a->batch.cap * 4, 32);
+    a->ticks = (int32_t*)NgAlignedAlloc((size_t)a->batch.cap * 4, 32);
+    return a->flaps && a->ticks;
+}
+
+static void arena_free(Arena* a)
+{
+    bird_batch_free(&a->batch);
+    NgAlignedFree(a->flaps);
+    NgAlignedFree(a->ticks);
+}
+
+// Flies every controller through one seeded episode; fitness[i] gets
+// columns passed plus the fraction of maxTicks survived.
+static void run_episode(Arena* a, const float* weights, int count, uint32_t seed, int maxTicks, float* fitness)
+{
+    BirdBatch* b = &a->batch;
+    bird_batch_reset(b, seed);
+    for (int i = 0; i < b->cap; ++i) { a->flaps[i] = 0; a->ticks[i] = 0; }
+    const float dt = 1.0f / kTickHz;
+    PilotView pv;
+    for (int t = 0; t < maxTicks && b->live > 0; ++t) {
+        pilot_view(&b->world, &pv);
+        for (int i = 0; i < count; ++i) {
+            if (!b->alive[i]) continue;
+            a->flaps[i] = pilot_decide(weights + (size_t)i * PILOT_WEIGHTS, &pv, b->y[i], b->v[i], kH) ? ~0 : 0;
+            a->ticks[i]++;
+        }
+        bird_batch_step(b, a->flaps, dt);
+    }
+    for (int i = 0; i < count; ++i) fitness[i] = (float)b->score[i] + (float)a->ticks[i] / (float)maxTicks;
+}
+
+// Runs `episodes` seeded episodes for all `count` controllers over the
+// workers; scores[e * count + i] is controller i's fitness in episode e.
+static void evaluate(std::vector<Arena>& arenas, const float* weights, int count, int episodes,
+                     uint64_t seedBase, int maxTicks, float* scores)
+{
+    std::atomic<int> next(0);
+    auto worker = [&](int self) {
+        for (int e; (e = next.fetch_add(1)) < episodes;) {
+            uint32_t seed = (uint32_t)mix64(seedBase + (uint64_t)e);
+            run_episode(&arenas[(size_t)self], weights, count, seed, maxTicks, scores + (size_t)e * count);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < arenas.size(); ++t) pool.emplace_back(worker, (int)t);
+    worker(0);
+    for (std::thread& th : pool) th.join();
+}
+
+static bool write_header(const char* path, const float* w, float fitness, const Config& cfg)
+{
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "#pragma once\n\n");
+    fprintf(f, "// Bird Up demo autopilot, generated by tools/birdup_train; do not edit.\n");
+    fprintf(f, "// %d generations of %d, %d episodes each, seed %llu; mean fitness %.2f.\n",
+            cfg.gens, cfg.pop, cfg.episodes, (unsigned long long)cfg.seed, fitness);
+    fprintf(f, "// Weight layout: see pilot_decide() in birdup_pilot.h.\n\n");
+    fprintf(f, "static const float BIRD_DEMO_PILOT[%d] = {", PILOT_WEIGHTS);
+    for (int i = 0; i < PILOT_WEIGHTS; ++i) fprintf(f, "%s%.9gf,", (i % 6) ? " " : "\n    ", w[i]);
+    fprintf(f, "\n};\n");
+    return fclose(f) == 0;
+}
+
+static int check(int episodes, float secs, int threads)
+{
+    std::vector<Arena> arenas((size_t)threads);
+    for (Arena& a : arenas) {
+        if (!arena_init(&a, 1)) { fprintf(stderr, "out of memory\n"); return 1; }
+    }
+    std::vector<float> scores((size_t)episodes);
+    int maxTicks = (int)(secs * kTickHz);
+    evaluate(arenas, BIRD_DEMO_PILOT, 1, episodes, 0xC0FFEEull << 20, maxTicks, scores.data());
+    float sum = 0.0f, worst = 1e30f;
+    int full = 0;
+    for (float s : scores) {
+        sum += s;
+        worst = std::min(worst, s);
+        if (s - floorf(s) == 0.0f && s > 0.0f) ++full;   // fraction is 0 only when it flew all maxTicks
+    }
+    printf("demo pilot: %d unseen episodes of %.0f s, mean %.2f columns, worst %.2f, %d flew the whole time\n",
+           episodes, secs, sum / episodes, worst, full);
+    for (Arena& a : arenas) arena_free(&a);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    int hw = (int)std::thread::hardware_concurrency();
+    if (hw < 1) hw = 1;
+    if (argc > 1 && strcmp(argv[1], "check") == 0) {
+        int episodes = (argc > 2) ? atoi(argv[2]) : 200;
+        float secs = (argc > 3) ? (float)atof(argv[3]) : 120.0f;
+        return check(episodes < 1 ? 1 : episodes, secs, hw);
+    }
+
+    Config cfg = { 60, 512, 16, hw, 32, 60.0f, 0.1f, 1, nullptr };
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        if (strncmp(a, "--gens=", 7) == 0) cfg.gens = atoi(a + 7);
+        else if (strncmp(a, "--pop=", 6) == 0) cfg.pop = atoi(a + 6);
+        else if (strncmp(a, "--episodes=", 11) == 0) cfg.episodes = atoi(a + 11);
+        else if (strncmp(a, "--secs=", 7) == 0) cfg.secs = (float)atof(a + 7);
+        else if (strncmp(a, "--threads=", 10) == 0) cfg.threads = atoi(a + 10);
+        else if (strncmp(a, "--seed=", 7) == 0) cfg.seed = strtoull(a + 7, nullptr, 10);
+        else if (strncmp(a, "--export=", 9) == 0) cfg.exportPath = a + 9;
+        else {
+            fprintf(stderr, "bad argument: %s (see the header of birdup_train.cpp)\n", a);
+            return 1;
+        }
+    }
+    if (cfg.threads < 1) cfg.threads = 1;
+    if (cfg.gens < 1 || cfg.pop < 2 || cfg.episodes < 1 || cfg.secs <= 0.0f) {
+        fprintf(stderr, "--gens, --pop, --episodes and --secs must be positive\n");
+        return 1;
+    }
+    cfg.elites = std::max(1, std::min(cfg.elites, cfg.pop / 4));
+
+    std::vector<Arena> arenas((size_t)cfg.threads);
+    for (Arena& a : arenas) {
+        if (!arena_init(&a, cfg.pop)) { fprintf(stderr, "out of memory\n"); return 1; }
+    }
+
+    const int n = cfg.pop;
+    const int maxTicks = (int)(cfg.secs * kTickHz);
+    std::vector<float> pop((size_t)n * PILOT_WEIGHTS), next(pop.size());
+    std::vector<float> scores((size_t)cfg.episodes * n), fitness((size_t)n);
+    std::vector<int> order((size_t)n);
+    std::vector<float> best(PILOT_WEIGHTS);
+    float bestFitness = 0.0f;
+
+    Rng rng = { mix64(cfg.seed) };
+    for (float& w : pop) w = rng.normal() * 0.5f;
+
+    printf("%5s %10s %10s %10s %10s %12s\n", "gen", "best", "elite avg", "median", "secs", "episodes/s");
+    for (int gen = 0; gen < cfg.gens; ++gen) {
+        auto t0 = std::chrono::steady_clock::now();
+        evaluate(arenas, pop.data(), n, cfg.episodes, mix64(cfg.seed ^ ((uint64_t)gen << 32)), maxTicks,
+                 scores.data());
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+        for (int i = 0; i < n; ++i) {
+            float sum = 0.0f;
+            for (int e = 0; e < cfg.episodes; ++e) sum += scores[(size_t)e * n + i];
+            fitness[(size_t)i] = sum / cfg.episodes;
+            order[(size_t)i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return fitness[(size_t)a] > fitness[(size_t)b]; });
+
+        float eliteSum = 0.0f;
+        for (int k = 0; k < cfg.elites; ++k) eliteSum += fitness[(size_t)order[(size_t)k]];
+        printf("%5d %10.2f %10.2f %10.2f %10.3f %12.0f\n", gen, fitness[(size_t)order[0]], eliteSum / cfg.elites,
+               fitness[(size_t)order[(size_t)n / 2]], secs, (double)n * cfg.episodes / secs);
+        fflush(stdout);
+
+        // Best of the final generation, scored on that generation's seeds.
+        bestFitness = fitness[(size_t)order[0]];
+        std::copy(pop.begin() + (size_t)order[0] * PILOT_WEIGHTS,
+                  pop.begin() + (size_t)(order[0] + 1) * PILOT_WEIGHTS, best.begin());
+
+        // Elites carry over; everyone else is a mutated elite.
+        for (int i = 0; i < n; ++i) {
+            int parent = order[(size_t)(i < cfg.elites ? i : (int)(rng.uniform() * cfg.elites) % cfg.elites)];
+            const float* src = &pop[(size_t)parent * PILOT_WEIGHTS];
+            float* dst = &next[(size_t)i * PILOT_WEIGHTS];
+            for (int k = 0; k < PILOT_WEIGHTS; ++k) dst[k] = src[k] + (i < cfg.elites ? 0.0f : rng.normal() * cfg.sigma);
+        }
+        pop.swap(next);
+    }
+
+    for (Arena& a : arenas) arena_free(&a);
+    if (cfg.exportPath) {
+        if (!write_header(cfg.exportPath, best.data(), bestFitness, cfg)) {
+            fprintf(stderr, "failed to write %s\n", cfg.exportPath);
+            return 1;
+        }
+        printf("wrote %s\n", cfg.exportPath);
+    }
+    return 0;
+}
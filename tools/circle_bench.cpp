@@ -0,0 +1,235 @@
+// Anti-aliased circle/ellipse fill: correctness checks and benchmark.
+//
+// Renders a fixed scene of circles and ellipses (sub-pixel centres, radii
+// from a third of a pixel to bigger than the screen, axis ratios up to 8,
+// shapes hanging off every edge) with each kernel tier and checks that
+//   - every tier matches a brute-force reference that blends every pixel of
+//     the bounding box, so the analytic spans never skip a partial pixel or
+//     fill one solid,
+//   - every tier produces the golden image (its FNV-1a hash is below),
+//   - coverage adds up to the shape's area, to within 1% or one pixel.
+// Then times a frame of circles at 4K per tier, against the reference and
+// the square FillRect the ball used to be.
+//
+// Build: g++ -O2 -std=c++11 tools/circle_bench.cpp -o circle_bench
+// Usage: circle_bench [circles=500] [golden.ppm]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#include "../Games/common/hash.h"
+#include "../Games/common/shapes_aa.h"
+
+// FNV-1a of the golden scene's pixels. Any change to coverage, blending or
+// span rounding shows up here; update it only on purpose.
+static const uint64_t kGoldenHash = 0x063e2af4ec49b753ull;
+
+struct Shape {
+    float cx, cy, rx, ry;
+    uint32_t color;
+};
+
+static uint32_t g_seed = 12345;
+static uint32_t Rand() {
+    g_seed = g_seed * 1664525u + 1013904223u;
+    return g_seed >> 8;
+}
+static float RandF(float lo, float hi) {
+    return lo + (hi - lo) * (float)(Rand() & 0xFFFF) / 65535.0f;
+}
+
+// Every pixel the ellipse can touch, blended with the scalar coverage.
+static void ReferenceEllipse(const Surface& s, float cx, float cy, float rx, float ry, uint32_t color) {
+    if (!(rx > 0.0f) || !(ry > 0.0f)) return;
+    int x0, y0, x1, y1;
+    RasterEllipseAABounds(cx, cy, rx, ry, &x0, &y0, &x1, &y1);
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > s.w) x1 = s.w;
+    if (y1 > s.h) y1 = s.h;
+    AARow r;
+    r.cx = cx;
+    r.irx2 = 1.0f / (rx * rx);
+    r.irx4 = r.irx2 * r.irx2;
+    const float iry2 = 1.0f / (ry * ry), iry4 = iry2 * iry2;
+    for (int y = y0; y < y1; y++) {
+        const float dy = ((float)y + 0.5f) - cy;
+        r.qy = dy * dy * iry2;
+        r.qy4 = dy * dy * iry4;
+        uint32_t* row = s.pixels + (size_t)y * s.stride;
+        for (int x = x0; x < x1; x++) row[x] = AABlend(row[x], color, AAAlpha(r, (float)x));
+    }
+}
+
+static void Backdrop(const Surface& s) {
+    for (int y = 0; y < s.h; y++) {
+        for (int x = 0; x < s.w; x++) {
+            s.pixels[(size_t)y * s.stride + x] = (uint32_t)((x * 255 / s.w) << 16 | (y * 255 / s.h) << 8 | 0x30);
+        }
+    }
+}
+
+static std::vector<Shape> GoldenShapes(int w, int h) {
+    std::vector<Shape> v;
+    g_seed = 12345;
+    for (int i = 0; i < 400; i++) {
+        Shape sh;
+        sh.cx = RandF(-40.0f, w + 40.0f);
+        sh.cy = RandF(-40.0f, h + 40.0f);
+        sh.rx = (i % 4 == 0) ? RandF(0.3f, 3.0f) : RandF(2.0f, 60.0f);
+        sh.ry = (i % 3 == 0) ? sh.rx * RandF(0.125f, 8.0f) : sh.rx;
+        sh.color = Rand() & 0xFFFFFF;
+        v.push_back(sh);
+    }
+    // Bigger than the screen, pixel-aligned, and as thin as it gets.
+    Shape extra[] = {
+        { w * 0.5f, h * 0.5f, w * 0.75f, h * 0.6f, 0x203040 },
+        { 100.0f, 100.0f, 10.0f, 10.0f, 0xFFFFFF },
+        { 200.5f, 100.5f, 0.5f, 0.5f, 0xFFFFFF },
+        { 300.25f, 120.75f, 80.0f, 1.5f, 0xFF8000 },
+        { 150.0f, 300.0f, 0.75f, 90.0f, 0x00FF80 },
+    };
+    v.insert(v.begin(), extra[0]);
+    for (size_t i = 1; i < sizeof(extra) / sizeof(extra[0]); i++) v.push_back(extra[i]);
+    return v;
+}
+
+static uint64_t HashSurface(const Surface& s) {
+    uint64_t h = kHashSeed;
+    for (int y = 0; y < s.h; y++) h = HashBytes(h, s.pixels + (size_t)y * s.stride, (size_t)s.w * 4);
+    return h;
+}
+
+static bool WritePpm(const char* path, const Surface& s) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    fprintf(f, "P6\n%d %d\n255\n", s.w, s.h);
+    for (int y = 0; y < s.h; y++) {
+        for (int x = 0; x < s.w; x++) {
+            uint32_t c = s.pixels[(size_t)y * s.stride + x];
+            uint8_t rgb[3] = { (uint8_t)(c >> 16), (uint8_t)(c >> 8), (uint8_t)c };
+            fwrite(rgb, 1, 3, f);
+        }
+    }
+    return fclose(f) == 0;
+}
+
+// Sum of coverage of one white shape on black minus pi * rx * ry, in pixels.
+static double AreaError(float cx, float cy, float rx, float ry) {
+    const int w = (int)(2 * rx + 8), h = (int)(2 * ry + 8);
+    std::vector<uint32_t> px((size_t)w * h, 0);
+    Surface s = { px.data(), w, h, w };
+    RasterFillEllipseAA(s, cx + w * 0.5f, cy + h * 0.5f, rx, ry, 0xFFFFFF);
+    double sum = 0.0;
+    for (uint32_t p : px) sum += (p & 255) / 255.0;
+    return sum - 3.14159265358979 * rx * ry;
+}
+
+template <typename F>
+static double TimeIt(F&& fn, int reps) {
+    fn(); // warm up
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; i++) fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() / reps;
+}
+
+int main(int argc, char** argv) {
+    const int circles = (argc > 1) ? atoi(argv[1]) : 500;
+    const char* out = (argc > 2) ? argv[2] : nullptr;
+    if (circles <= 0) {
+        fprintf(stderr, "usage: %s [circles] [golden.ppm]\n", argv[0]);
+        return 1;
+    }
+    static const char* tierName[] = { "scalar", "sse2", "avx2" };
+    const NgSimdLevel best = NgDetectSimd();
+    const AAKernels saved = g_aa;
+    bool ok = true;
+
+    // ---- Golden scene: reference, then every tier ----
+    const int gw = 640, gh = 480;
+    const std::vector<Shape> shapes = GoldenShapes(gw, gh);
+    std::vector<uint32_t> ref((size_t)gw * gh), buf((size_t)gw * gh);
+    Surface refS = { ref.data(), gw, gh, gw }, bufS = { buf.data(), gw, gh, gw };
+    Backdrop(refS);
+    for (const Shape& sh : shapes) ReferenceEllipse(refS, sh.cx, sh.cy, sh.rx, sh.ry, sh.color);
+    const uint64_t refHash = HashSurface(refS);
+    printf("golden  %dx%d, %d shapes: reference %016llx, want %016llx %s\n", gw, gh, (int)shapes.size(),
+           (unsigned long long)refHash, (unsigned long long)kGoldenHash, refHash == kGoldenHash ? "ok" : "MISMATCH");
+    ok &= refHash == kGoldenHash;
+    for (int level = NG_SIMD_SCALAR; level <= best; level++) {
+        g_aa = AAPickKernels((NgSimdLevel)level);
+        Backdrop(bufS);
+        for (const Shape& sh : shapes) RasterFillEllipseAA(bufS, sh.cx, sh.cy, sh.rx, sh.ry, sh.color);
+        int diff = 0;
+        for (size_t i = 0; i < buf.size(); i++) diff += buf[i] != ref[i];
+        const uint64_t h = HashSurface(bufS);
+        printf("golden  %-6s %016llx, %d pixels differ from the reference\n", tierName[level], (unsigned long long)h, diff);
+        ok &= diff == 0 && h == kGoldenHash;
+    }
+    g_aa = saved;
+    if (out && !WritePpm(out, refS)) {
+        fprintf(stderr, "cannot write %s\n", out);
+        return 1;
+    }
+
+    // ---- Coverage adds up to the area ----
+    static const float radii[][2] = { { 2.0f, 2.0f }, { 5.3f, 5.3f }, { 17.7f, 17.7f }, { 60.0f, 60.0f },
+                                      { 40.0f, 10.0f }, { 6.0f, 30.0f } };
+    bool areaOk = true;
+    for (const auto& r : radii) {
+        double worst = 0.0;
+        for (int k = 0; k < 8; k++) {
+            double e = AreaError(k * 0.125f, k * 0.3f - 1.0f, r[0], r[1]);
+            if (e < 0) e = -e;
+            if (e > worst) worst = e;
+        }
+        const double area = 3.14159265358979 * r[0] * r[1];
+        printf("area    %5.1f x %-5.1f worst error %.2f px (%.3f%%)\n", r[0], r[1], worst, worst * 100.0 / area);
+        areaOk &= worst <= 1.0 || worst <= area * 0.01;
+    }
+    ok &= areaOk;
+
+    // ---- 4K frame of circles ----
+    const int w = 3840, h = 2160;
+    uint32_t* px = (uint32_t*)NgAlignedAlloc((size_t)w * h * 4, 64);
+    Surface s = { px, w, h, w };
+    std::vector<Shape> balls;
+    g_seed = 777;
+    for (int i = 0; i < circles; i++) {
+        Shape b;
+        b.cx = RandF(0.0f, (float)w);
+        b.cy = RandF(0.0f, (float)h);
+        b.rx = b.ry = RandF(4.0f, 40.0f);
+        b.color = Rand() & 0xFFFFFF;
+        balls.push_back(b);
+    }
+    RasterClear(s, 0x28281E);
+    const int reps = 20;
+    printf("\n4K, %d circles r=4..40 per frame\n", circles);
+    printf("%-16s %10s %12s\n", "fill", "ms/frame", "circles/ms");
+    auto report = [&](const char* what, double secs) {
+        printf("%-16s %10.3f %12.0f\n", what, secs * 1e3, circles / (secs * 1e3));
+    };
+    report("rect (old ball)", TimeIt([&] {
+        for (const Shape& b : balls)
+            RasterFillRect(s, (int)(b.cx - b.rx), (int)(b.cy - b.ry), (int)(b.cx + b.rx), (int)(b.cy + b.ry), b.color);
+    }, reps));
+    report("aa reference", TimeIt([&] {
+        for (const Shape& b : balls) ReferenceEllipse(s, b.cx, b.cy, b.rx, b.ry, b.color);
+    }, reps));
+    for (int level = NG_SIMD_SCALAR; level <= best; level++) {
+        g_aa = AAPickKernels((NgSimdLevel)level);
+        char name[32];
+        snprintf(name, sizeof(name), "aa %s", tierName[level]);
+        report(name, TimeIt([&] {
+            for (const Shape& b : balls) RasterFillEllipseAA(s, b.cx, b.cy, b.rx, b.ry, b.color);
+        }, reps));
+    }
+    g_aa = saved;
+    NgAlignedFree(px);
+
+    printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,234 @@
+// Headless checks for the idle scheduler (PongAtRest, bird_at_rest).
+//
+// First checks that "at rest" means what the front ends rely on: from every
+// resting state reached in long seeded sessions, ticks without input change
+// nothing on screen (Pong: paddles, ball, score, menu; Bird Up: the whole
+// game). Then plays a kiosk-like session of each game in real time, twice:
+//   - always: the old loops, drawing every frame (Pong at 60 fps, Bird Up
+//     flat out with a 1 ms sleep),
+//   - adaptive: the new loops, drawing only when a tick ran (Bird Up) and
+//     blocking while at rest until the next scripted key press,
+// and reports process CPU time per minute of play for each.
+// Exits non-zero if a resting state moves.
+//
+// Build: g++ -O2 -std=c++11 -pthread tools/idle_sched.cpp -o idle_sched
+// Usage: idle_sched [seconds=5]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "../Games/common/raster.h"
+#include "../Games/common/replay.h"
+#include "../Games/pongV1/pong_core.h"
+#include "../Games/Bird Up/birdup_sprites.h"
+#include "../Games/Bird Up/birdup_pilot.h"
+#include "../Games/Bird Up/birdup_demo_pilot.h"
+
+static const int kTickHz = 120;
+static const double kIdleWait = 0.25;   // the games' longest sleep at rest
+
+// What the player sees of a Pong state.
+static bool PongSameOnScreen(const PongState& a, const PongState& b) {
+    return a.left.y == b.left.y && a.right.y == b.right.y && a.ball.x == b.ball.x && a.ball.y == b.ball.y &&
+           a.ball.inPlay == b.ball.inPlay && a.scoreL == b.scoreL && a.scoreR == b.scoreR &&
+           a.state == b.state && a.menuSelection == b.menuSelection;
+}
+
+// ---- At rest means still ----
+static int CheckPongRest(int ticks) {
+    PongState s;
+    InitGame(s, 800, 600, 3);
+    s.aiMode = s.aiLeft = true;
+    ResetGame(s);
+    int rests = 0, moved = 0, waited = 0;
+    const float dt = ReplayTickDt(kTickHz);
+    for (int t = 0; t < ticks; t++) {
+        PongInput in = {};
+        if (PongAtRest(s)) {
+            rests++;
+            PongState still = s;
+            for (int i = 0; i < 2 * kTickHz; i++) UpdateGame(still, in, dt);
+            if (!PongSameOnScreen(still, s) || !PongAtRest(still)) moved++;
+        }
+        // Leave the menu, and serve after half a second of waiting.
+        if (s.state == STATE_MENU) in.pressed = PONG_KEY_RETURN;
+        if (!s.ball.inPlay && ++waited >= kTickHz / 2) in.pressed = PONG_KEY_SPACE, waited = 0;
+        UpdateGame(s, in, dt);
+        if (s.state == STATE_PLAYING && !s.aiLeft) s.aiMode = s.aiLeft = true;
+    }
+    printf("pong    %d ticks, %d at rest, %d of them moved without input\n", ticks, rests, moved);
+    return (moved == 0 && rests > 0) ? 0 : 1;
+}
+
+static int CheckBirdRest(int ticks) {
+    BirdGame g;
+    bird_init(&g, 640, 480, 3);
+    int rests = 0, moved = 0;
+    const float dt = ReplayTickDt(kTickHz);
+    for (int t = 0; t < ticks; t++) {
+        if (bird_at_rest(&g)) {
+            rests++;
+            BirdGame still = g;
+            for (int i = 0; i < 2 * kTickHz; i++) bird_tick(&still, 0, dt);
+            if (memcmp(&still, &g, sizeof(g)) != 0) moved++;
+        }
+        // The pilot, but fumbling every 600th tick so runs end.
+        uint32_t input = (t % 600 < 40) ? 0 : pilot_input(BIRD_DEMO_PILOT, &g);
+        bird_tick(&g, input, dt);
+    }
+    printf("birdup  %d ticks, %d at rest, %d of them moved without input\n", ticks, rests, moved);
+    return (moved == 0 && rests > 0) ? 0 : 1;
+}
+
+// ---- CPU cost of a session, old loop against new ----
+typedef std::chrono::steady_clock Clock;
+
+struct Session {
+    double atRest;      // seconds spent at rest
+    long frames, ticks;
+    double cpuPerMin;   // process CPU seconds per minute of play
+};
+
+// Pong: AI against AI, a serve 1.5 s after every point (as if a player
+// pressed Space), drawn as a full-screen redraw at 60 fps.
+static Session PongSession(double seconds, bool adaptive) {
+    PongState s;
+    InitGame(s, 800, 600, 5);
+    s.aiMode = s.aiLeft = true;
+    ResetGame(s);
+    s.state = STATE_PLAYING;
+    std::vector<uint32_t> pixels(800 * 600);
+    Surface surf = { pixels.data(), 800, 600, 800 };
+
+    Session r = Session();
+    const double tickSecs = 1.0 / kTickHz, frameSecs = 1.0 / 60.0;
+    const Clock::time_point t0 = Clock::now();
+    auto now = [&] { return std::chrono::duration<double>(Clock::now() - t0).count(); };
+    const clock_t c0 = clock();
+    double last = 0.0, acc = 0.0, nextFrame = frameSecs, serveAt = 1.5;
+    bool drawnAtRest = false;
+    while (last < seconds) {
+        double t = now();
+        acc += t - last;
+        last = t;
+        while (acc >= tickSecs) {
+            acc -= tickSecs;
+            PongInput in = {};
+            if (!s.ball.inPlay && t >= serveAt) in.pressed = PONG_KEY_SPACE;
+            bool wasInPlay = s.ball.inPlay;
+            UpdateGame(s, in, ReplayTickDt(kTickHz));
+            if (wasInPlay && !s.ball.inPlay) serveAt = t + 1.5;
+            r.ticks++;
+        }
+        bool rest = PongAtRest(s) && !s.ball.inPlay && t < serveAt;
+        if (adaptive && rest && drawnAtRest) {
+            // Block until the "key" (or the stats refresh), then restart
+            // the clock: the wait is a pause.
+            double wake = serveAt < t + kIdleWait ? serveAt : t + kIdleWait;
+            std::this_thread::sleep_until(t0 + std::chrono::duration<double>(wake));
+            double woke = now();
+            r.atRest += woke - t;
+            last = woke;
+            acc = 0.0;
+            nextFrame = woke + frameSecs;
+            continue;
+        }
+        RasterFillRect(surf, 0, 0, 800, 600, 0x101010);
+        for (int y = 0; y < 600; y += 18) RasterFillRect(surf, 398, y, 402, y + 10, 0xC8C8C8);
+        RasterFillRect(surf, (int)s.left.x - 7, (int)s.left.y - 55, (int)s.left.x + 7, (int)s.left.y + 55, 0xF0F0F0);
+        RasterFillRect(surf, (int)s.right.x - 7, (int)s.right.y - 55, (int)s.right.x + 7, (int)s.right.y + 55, 0xF0F0F0);
+        RasterFillRect(surf, (int)s.ball.x - 8, (int)s.ball.y - 8, (int)s.ball.x + 8, (int)s.ball.y + 8, 0x49E80F);
+        r.frames++;
+        drawnAtRest = rest;
+        std::this_thread::sleep_until(t0 + std::chrono::duration<double>(nextFrame));
+        nextFrame += frameSecs;
+        if (nextFrame < now()) nextFrame = now() + frameSecs;
+    }
+    r.cpuPerMin = (double)(clock() - c0) / CLOCKS_PER_SEC * 60.0 / last;
+    return r;
+}
+
+// Bird Up: the demo pilot flies, gives up every 4 s and crashes, and the
+// player presses Space 3 s into each game-over screen.
+static Session BirdSession(double seconds, bool adaptive) {
+    BirdGame g;
+    bird_init(&g, 640, 480, 5);
+    BirdSprites sprites = {};
+    bake_sprites(&sprites, 640, 480);
+    std::vector<uint32_t> pixels(640 * 480);
+    Surface surf = { pixels.data(), 640, 480, 640 };
+
+    Session r = Session();
+    const double tickSecs = 1.0 / kTickHz;
+    const Clock::time_point t0 = Clock::now();
+    auto now = [&] { return std::chrono::duration<double>(Clock::now() - t0).count(); };
+    const clock_t c0 = clock();
+    double last = 0.0, acc = 0.0, flownSince = 0.0, restartAt = 1e30;
+    while (last < seconds) {
+        double t = now();
+        acc += t - last;
+        last = t;
+        bool ticked = false;
+        while (acc >= tickSecs) {
+            acc -= tickSecs;
+            uint32_t input = 0;
+            if (g.alive && t - flownSince < 4.0) input = pilot_input(BIRD_DEMO_PILOT, &g);
+            if (!g.alive && t >= restartAt) {
+                input = BIRD_KEY_SPACE << 16;
+                flownSince = t;
+                restartAt = 1e30;
+            }
+            bird_tick(&g, input, ReplayTickDt(kTickHz));
+            if (!g.alive && restartAt > 1e29) restartAt = t + 3.0;
+            r.ticks++;
+            ticked = true;
+        }
+        if (!adaptive || ticked) {
+            draw_game_cached(surf, &sprites, &g);
+            r.frames++;
+        }
+        if (!adaptive) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        } else if (bird_at_rest(&g) && t < restartAt) {
+            double wake = restartAt < t + kIdleWait ? restartAt : t + kIdleWait;
+            std::this_thread::sleep_until(t0 + std::chrono::duration<double>(wake));
+            double woke = now();
+            r.atRest += woke - t;
+            last = woke;
+            acc = 0.0;
+        } else {
+            // Sleep until the next tick is due, in whole milliseconds.
+            std::this_thread::sleep_for(std::chrono::milliseconds((int)((tickSecs - acc) * 1000.0)));
+        }
+    }
+    free_sprites(&sprites);
+    r.cpuPerMin = (double)(clock() - c0) / CLOCKS_PER_SEC * 60.0 / last;
+    return r;
+}
+
+static void Report(const char* name, const Session& always, const Session& adaptive, double seconds) {
+    printf("%-7s always   %6ld frames %6ld ticks                 cpu %5.2f s/min\n", name, always.frames,
+           always.ticks, always.cpuPerMin);
+    printf("%-7s adaptive %6ld frames %6ld ticks, %4.1f%% at rest  cpu %5.2f s/min (%.0f%% less)\n", name,
+           adaptive.frames, adaptive.ticks, adaptive.atRest * 100.0 / seconds, adaptive.cpuPerMin,
+           always.cpuPerMin > 0.0 ? (1.0 - adaptive.cpuPerMin / always.cpuPerMin) * 100.0 : 0.0);
+}
+
+int main(int argc, char** argv) {
+    double seconds = (argc > 1) ? atof(argv[1]) : 5.0;
+    if (seconds <= 0.0) {
+        fprintf(stderr, "usage: %s [seconds]\n", argv[0]);
+        return 1;
+    }
+    int failures = 0;
+    failures += CheckPongRest(60 * kTickHz * 10);
+    failures += CheckBirdRest(60 * kTickHz * 10);
+    Report("pong", PongSession(seconds, false), PongSession(seconds, true), seconds);
+    Report("birdup", BirdSession(seconds, false), BirdSession(seconds, true), seconds);
+    printf("%s\n", failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,351 @@
+// Headless checks for timestamped input (common/input_queue.h).
+//
+// Scripts key presses at exact real times (Bird Up flaps, Pong serves and
+// paddle moves, with taps as short as 1 ms), then runs each game's
+// accumulator loop at several frame rates with a jittery frame clock,
+// feeding the keys two ways:
+//   - queued: events stamped when they happen and taken by the tick whose
+//     span holds them, split at the press point (and, for Pong, at the
+//     release of a tap shorter than a tick), as the games now do,
+//   - latched: key state sampled at each frame and presses held until a
+//     tick consumes them, as the games used to.
+// For each run it reports how far a press's effective time in the
+// simulation is from when it really happened, how many presses were lost
+// and the event-to-tick latency. Queued runs must agree on the final state
+// at every frame rate, land every press within 1/128 tick of its real time,
+// lose none, and replay from their recorded input words to the same state.
+//
+// Build: g++ -O2 -std=c++11 tools/input_timing.cpp -o input_timing
+// Usage: input_timing [seconds=20] [seed=1]
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+
+#include "../Games/common/input_queue.h"
+#include "../Games/common/replay.h"
+#include "../Games/pongV1/pong_core.h"
+#include "../Games/Bird Up/birdup_core.h"
+
+// A QPC-like clock whose tick (and 1/128 of it) is a whole number of
+// counts, so the span every tick stands for is exact.
+static const int kTickHz = 120;
+static const int64_t kFreq = 3840000;
+static const int64_t kPeriod = kFreq / kTickHz;             // 32000 counts
+static const int64_t kAtCounts = kPeriod / kInputAtSteps;   // 250 counts
+static const int64_t kStart = 1000000;
+
+static uint64_t g_rng;
+static uint32_t Rand() {
+    g_rng ^= g_rng << 13; g_rng ^= g_rng >> 7; g_rng ^= g_rng << 17;
+    return (uint32_t)(g_rng >> 32);
+}
+static int64_t RandIn(int64_t lo, int64_t hi) { return lo + (int64_t)(Rand() % (uint64_t)(hi - lo)); }
+
+// Press and release times of one key. Presses sit a few counts clear of the
+// 1/128-tick grid: the games place tick spans with a floating-point
+// accumulator, exact only to within a count.
+struct Tap { int64_t down, up; uint16_t key; };
+
+static int64_t OffGrid(int64_t t) {
+    int64_t r = (t - kStart) % kAtCounts;
+    if (r < 5) t += 5 - r;
+    if (r > kAtCounts - 5) t += kAtCounts - r + 5;
+    return t;
+}
+
+// Presses of `key` at least two ticks apart (so each one gets its own
+// tick), held for 1 ms up to most of the gap.
+static void ScriptTaps(std::vector<Tap>& taps, uint16_t key, int64_t from, int64_t to, int64_t minGap, int64_t maxGap) {
+    static const int64_t kHolds[] = { kFreq / 1000, kFreq / 300, kFreq / 50, kFreq / 12 };
+    for (int64_t t = OffGrid(from + RandIn(minGap, maxGap)); t < to; t = OffGrid(t + RandIn(minGap, maxGap))) {
+        Tap tap = { t, 0, key };
+        int64_t hold = kHolds[Rand() % 4];
+        tap.up = t + (hold < minGap - kPeriod ? hold : minGap - kPeriod);
+        taps.push_back(tap);
+    }
+}
+
+// ---- The two games, behind one interface: an input word per tick ----
+struct BirdSim {
+    static const char* Name() { return "birdup"; }
+    static uint16_t Timed() { return BIRD_KEY_SPACE; }
+    BirdGame g;
+    static std::vector<Tap> Script(int64_t end) {
+        std::vector<Tap> taps;
+        ScriptTaps(taps, BIRD_KEY_SPACE, kStart, end, 3 * kPeriod, 50 * kPeriod);
+        return taps;
+    }
+    void Init() { bird_init(&g, 640, 480, 7); }
+    uint32_t Tick(const InputTick& t) {
+        uint32_t word = bird_input(t.down, t.pressed, t.at);
+        bird_tick(&g, word, ReplayTickDt(kTickHz));
+        return word;
+    }
+    void Replay(uint32_t word) { bird_tick(&g, word, ReplayTickDt(kTickHz)); }
+    static uint16_t Pressed(uint32_t word) { return (uint16_t)(word >> 16); }
+    static int At(uint32_t word) { return (int)((word >> 8) & 0x7F); }
+    uint64_t Hash() const { return bird_hash(&g); }
+};
+
+struct PongSim {
+    static const char* Name() { return "pong"; }
+    static uint16_t Timed() { return PONG_KEY_SPACE; }
+    PongState s;
+    static std::vector<Tap> Script(int64_t end) {
+        std::vector<Tap> taps;
+        ScriptTaps(taps, PONG_KEY_SPACE, kStart, end, 30 * kPeriod, 200 * kPeriod);
+        const size_t serves = taps.size();
+        std::vector<Tap> moves;
+        ScriptTaps(moves, PONG_KEY_W, kStart, end, 5 * kPeriod, 60 * kPeriod);
+        ScriptTaps(moves, PONG_KEY_S, kStart, end, 5 * kPeriod, 60 * kPeriod);
+        // A tick has one press point: keep paddle presses out of serve ticks.
+        for (const Tap& m : moves) {
+            bool clear = true;
+            for (size_t i = 0; i < serves; i++) {
+                if (m.down > taps[i].down - 2 * kPeriod && m.down < taps[i].down + 2 * kPeriod) clear = false;
+            }
+            if (clear) taps.push_back(m);
+        }
+        return taps;
+    }
+    void Init() {
+        InitGame(s, 800, 600, 7);
+        s.aiMode = true;
+        ResetGame(s);
+        s.state = STATE_PLAYING;
+    }
+    uint32_t Tick(const InputTick& t) {
+        PongInput in;
+        in.down = t.down;
+        in.pressed = t.pressed;
+        in.at = t.at;
+        in.until = t.until;
+        UpdateGame(s, in, ReplayTickDt(kTickHz));
+        return PongInputBits(in);
+    }
+    void Replay(uint32_t word) { UpdateGame(s, PongInputFromBits(word), ReplayTickDt(kTickHz)); }
+    static uint16_t Pressed(uint32_t word) { return (uint16_t)(word >> 16); }
+    static int At(uint32_t word) { return (int)((word >> 9) & 0x7F); }
+    uint64_t Hash() const { return PongHash(s); }
+};
+
+struct RunResult {
+    uint64_t hash;
+    std::vector<uint32_t> words;
+    int presses;                // of the timed key, as ticks saw them
+    double errAvgMs, errMaxMs;  // |effective - real| press time
+    double latAvgMs, latMaxMs;  // press -> the tick that applied it ran
+};
+
+// Key events in time order, as the window procedure would see them.
+static std::vector<InputEvent> Events(const std::vector<Tap>& taps) {
+    std::vector<InputEvent> ev;
+    for (const Tap& t : taps) {
+        InputEvent d = { t.down, t.key, 1 }, u = { t.up, t.key, 0 };
+        ev.push_back(d);
+        ev.push_back(u);
+    }
+    std::stable_sort(ev.begin(), ev.end(), [](const InputEvent& a, const InputEvent& b) { return a.time < b.time; });
+    return ev;
+}
+
+template <typename Game>
+static RunResult Run(const std::vector<Tap>& taps, int ticks, int fps, bool queued) {
+    static InputQueue q;
+    InputInit(q, kFreq);
+    std::vector<InputEvent> ev = Events(taps);
+    size_t nextEvent = 0;
+    uint16_t down = 0, pressed = 0;     // latched path
+
+    Game game;
+    game.Init();
+    RunResult r = RunResult();
+    std::vector<int64_t> ranAt;         // frame time each tick ran at
+    const double tickSecs = 1.0 / kTickHz;
+    int64_t last = kStart;
+    double acc = 0.0;
+    for (int64_t frame = 1; (int)r.words.size() < ticks; frame++) {
+        // Frames come every 1/fps, each up to a quarter period late.
+        int64_t framePeriod = kFreq / fps;
+        int64_t now = kStart + frame * framePeriod + RandIn(0, framePeriod / 4 + 1);
+
+        // Message pump: everything that happened by now.
+        for (; nextEvent < ev.size() && ev[nextEvent].time <= now; nextEvent++) {
+            const InputEvent& e = ev[nextEvent];
+            if (queued) {
+                InputPush(q, e.time, e.key, e.down != 0);
+            } else if (e.down) {
+                if (!(down & e.key)) pressed |= e.key;
+                down |= e.key;
+            } else {
+                down &= (uint16_t)~e.key;
+            }
+        }
+
+        acc += (double)(now - last) / (double)kFreq;
+        last = now;
+        while (acc >= tickSecs && (int)r.words.size() < ticks) {
+            acc -= tickSecs;
+            InputTick t;
+            if (queued) {
+                int64_t end = now - (int64_t)(acc * (double)kFreq);
+                t = InputTake(q, end - kPeriod, end, now);
+            } else {
+                t.down = down;
+                t.pressed = pressed;
+                t.at = 0;
+                t.until = 0;
+                pressed = 0;
+            }
+            r.words.push_back(game.Tick(t));
+            ranAt.push_back(now);
+        }
+    }
+    r.hash = game.Hash();
+
+    // Match the ticks that saw a timed press with the scripted presses.
+    std::vector<int64_t> real;
+    for (const Tap& t : taps) {
+        if (t.key == Game::Timed()) real.push_back(t.down);
+    }
+    double errSum = 0.0, latSum = 0.0;
+    for (size_t i = 0; i < r.words.size(); i++) {
+        uint32_t w = r.words[i];
+        if (!(Game::Pressed(w) & Game::Timed())) continue;
+        int64_t effective = kStart + (int64_t)i * kPeriod + Game::At(w) * kAtCounts;
+        if (r.presses < (int)real.size()) {
+            int64_t d = real[r.presses] - effective;
+            double ms = (double)(d < 0 ? -d : d) * 1e3 / (double)kFreq;
+            errSum += ms;
+            if (ms > r.errMaxMs) r.errMaxMs = ms;
+            double lat = (double)(ranAt[i] - real[r.presses]) * 1e3 / (double)kFreq;
+            latSum += lat;
+            if (lat > r.latMaxMs) r.latMaxMs = lat;
+        }
+        r.presses++;
+    }
+    int matched = r.presses < (int)real.size() ? r.presses : (int)real.size();
+    r.errAvgMs = matched ? errSum / matched : 0.0;
+    r.latAvgMs = matched ? latSum / matched : 0.0;
+    return r;
+}
+
+template <typename Game>
+static int Check(double seconds) {
+    static const int kFps[] = { 30, 60, 75, 144, 240, 1000 };
+    const int ticks = (int)(seconds * kTickHz);
+    const std::vector<Tap> taps = Game::Script(kStart + (int64_t)(ticks - 2) * kPeriod);
+    int scripted = 0;
+    for (const Tap& t : taps) scripted += t.key == Game::Timed();
+
+    int failures = 0;
+    uint64_t queuedHash = 0;
+    const char* name = Game::Name();
+    for (int queued = 1; queued >= 0; queued--) {
+        int distinct = 0;
+        uint64_t prevHash = 0;
+        for (int fps : kFps) {
+            RunResult r = Run<Game>(taps, ticks, fps, queued != 0);
+            if (fps == kFps[0] || r.hash != prevHash) distinct++;
+            prevHash = r.hash;
+            bool ok = true;
+            if (queued) {
+                if (fps == kFps[0]) queuedHash = r.hash;
+                // Every press within one step of `at` of its real time.
+                ok = r.hash == queuedHash && r.presses == scripted &&
+                     r.errMaxMs < 1e3 / kTickHz / kInputAtSteps;
+                Game replay;
+                replay.Init();
+                for (uint32_t w : r.words) replay.Replay(w);
+                if (replay.Hash() != r.hash) {
+                    printf("%-7s %4d fps  replay of the recorded words DIFFERS\n", name, fps);
+                    ok = false;
+                }
+            }
+            printf("%-7s %-8s %4d fps  %016llx  presses %3d/%d  press time error %6.3f ms avg %6.3f max  "
+                   "latency %5.2f ms avg %5.2f max%s\n", name, queued ? "queued" : "latched", fps,
+                   (unsigned long long)r.hash, r.presses, scripted, r.errAvgMs, r.errMaxMs,
+                   r.latAvgMs, r.latMaxMs, ok ? "" : "  FAILED");
+            failures += ok ? 0 : 1;
+        }
+        printf("%-7s %-8s %d distinct final state%s over %d frame rates\n", name, queued ? "queued" : "latched",
+               distinct, distinct == 1 ? "" : "s", (int)(sizeof(kFps) / sizeof(kFps[0])));
+    }
+    return failures;
+}
+
+// Input words written before the press point or tap release existed read
+// back unchanged.
+static int CheckWords() {
+    int bad = 0;
+    for (uint32_t i = 0; i < 100000; i++) {
+        PongInput in;
+        in.down = (uint16_t)(Rand() & 0x1FF);
+        in.pressed = (uint16_t)(Rand() & 0x1FF);
+        in.at = (uint8_t)(Rand() & 0x7F);
+        in.until = (uint8_t)(Rand() & 0x7F);
+        PongInput back = PongInputFromBits(PongInputBits(in));
+        if (back.down != in.down || back.pressed != in.pressed || back.at != in.at || back.until != in.until) bad++;
+        uint32_t old = (uint32_t)in.down | (uint32_t)in.pressed << 16;
+        PongInput read = PongInputFromBits(old);
+        if (read.at != 0 || read.until != 0 || PongInputBits(read) != old) bad++;
+    }
+    printf("words   100000 Pong input words round-trip, %d bad\n", bad);
+    return bad ? 1 : 0;
+}
+
+// A W tap shorter than a tick, anywhere in it, moves the paddle as far as
+// holding W for the tap's length would.
+static int CheckShortTaps() {
+    static const int64_t kHolds[] = { kFreq / 1000, kFreq / 500, kPeriod / 2, kPeriod - 2 * kAtCounts };
+    int bad = 0;
+    double worst = 0.0;
+    for (int i = 0; i < 200; i++) {
+        PongState s;
+        InitGame(s, 800, 600, 7);
+        s.aiMode = true;
+        ResetGame(s);
+        s.state = STATE_PLAYING;
+        const int64_t hold = kHolds[i % 4];
+        const int64_t down = OffGrid(kStart + RandIn(0, kPeriod - hold - kAtCounts));
+        static InputQueue q;
+        InputInit(q, kFreq);
+        InputPush(q, down, PONG_KEY_W, true);
+        InputPush(q, down + hold, PONG_KEY_W, false);
+        const float y0 = s.left.y;
+        for (int t = 0; t < 2; t++) {
+            InputTick k = InputTake(q, kStart + t * kPeriod, kStart + (t + 1) * kPeriod, kStart + (t + 1) * kPeriod);
+            PongInput in = {};
+            in.down = k.down;
+            in.pressed = k.pressed;
+            in.at = k.at;
+            in.until = k.until;
+            UpdateGame(s, PongInputFromBits(PongInputBits(in)), ReplayTickDt(kTickHz));
+        }
+        const double want = s.left.speed * (double)hold / (double)kFreq;
+        const double err = fabs((y0 - s.left.y) - want);
+        if (err > worst) worst = err;
+        // Both ends rounded down to the 1/128 grid.
+        if (err > s.left.speed * 1.0 / kTickHz / kInputAtSteps) bad++;
+    }
+    printf("taps    200 W taps of 1 ms to under a tick: travel off by %.3f px at most, %d bad\n", worst, bad);
+    return bad ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    double seconds = (argc > 1) ? atof(argv[1]) : 20.0;
+    g_rng = 0x9E3779B97F4A7C15ull ^ ((argc > 2) ? strtoull(argv[2], nullptr, 10) : 1);
+    if (seconds < 1.0) {
+        fprintf(stderr, "usage: %s [seconds] [seed]\n", argv[0]);
+        return 1;
+    }
+    int failures = 0;
+    failures += Check<BirdSim>(seconds);
+    failures += Check<PongSim>(seconds);
+    failures += CheckWords();
+    failures += CheckShortTaps();
+    printf("%s\n", failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,208 @@
+// Pong chaos mode (pongV1/pong_chaos.h): checks and physics scaling benchmark.
+//
+// Checks that
+//   - every kernel tier plays the same AI-vs-AI chaos game to the same
+//     state hash,
+//   - the grid hands out every touching pair of balls, each exactly once
+//     (compared with testing all pairs),
+//   - balls are never lost and never leave the court vertically,
+//   - the AIs keep moving as the court fills up (they react only to the
+//     return of the ball they watch, not to every hit).
+// Then times a chaos tick against the ball count at a fixed density (the
+// radius shrinks past ~1200 balls so they cover 15% of a 1080p court),
+// next to what testing every pair would cost for the contacts alone.
+//
+// Build: g++ -O2 -std=c++11 tools/pong_chaos.cpp -o pong_chaos
+// Usage: pong_chaos [max balls=8000] [ticks=600]
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <utility>
+#include <vector>
+
+#include "../Games/pongV1/pong_chaos.h"
+
+static const int kTickHz = 120;
+static const float kDt = 1.0f / kTickHz;
+
+// An AI-vs-AI chaos game of `balls` balls, served and running.
+static void StartMatch(PongState& s, ChaosBalls& c, int balls, int w, int h, uint32_t seed) {
+    InitGame(s, w, h, seed);
+    ChaosInit(c, balls, w, h);
+    PongInput start = {};
+    start.pressed = PONG_KEY_2;
+    ChaosUpdate(s, c, start, kDt);
+    s.aiLeft = true;
+}
+
+static void RunTicks(PongState& s, ChaosBalls& c, int ticks) {
+    const PongInput idle = {};
+    for (int t = 0; t < ticks; t++) ChaosUpdate(s, c, idle, kDt);
+}
+
+// ---- Checks ----
+static bool CheckTiers(NgSimdLevel best) {
+    static const char* tierName[] = { "scalar", "sse2", "avx2" };
+    uint64_t want = 0;
+    bool ok = true;
+    for (int level = NG_SIMD_SCALAR; level <= best; level++) {
+        g_chaosKernels = ChaosPickKernels((NgSimdLevel)level);
+        PongState s;
+        ChaosBalls c;
+        StartMatch(s, c, 1001, 1280, 720, 7);   // not a multiple of 8: padding lanes run too
+        RunTicks(s, c, 1200);
+        const uint64_t got = ChaosHash(s, c);
+        if (level == NG_SIMD_SCALAR) want = got;
+        printf("tiers   %-6s %016llx  score %d - %d %s\n", tierName[level], (unsigned long long)got, s.scoreL,
+               s.scoreR, got == want ? "ok" : "MISMATCH");
+        ok &= got == want;
+        ChaosFree(c);
+    }
+    g_chaosKernels = ChaosPickKernels(best);
+    return ok;
+}
+
+typedef std::vector<std::pair<int, int> > PairList;
+
+static bool CheckBroadphase() {
+    PongState s;
+    ChaosBalls c;
+    StartMatch(s, c, 3000, 1280, 720, 11);
+    bool ok = true;
+    int touching = 0, grid = 0;
+    for (int round = 0; round < 5; round++) {
+        RunTicks(s, c, 97);
+        ChaosBuildGrid(c);
+        const float touch2 = 4.0f * c.r * c.r;
+        PairList fromGrid, all, seen;
+        ChaosForEachPair(c, [&](int i, int j) {
+            seen.push_back(std::make_pair(std::min(i, j), std::max(i, j)));
+            const float dx = c.x[j] - c.x[i], dy = c.y[j] - c.y[i];
+            if (dx * dx + dy * dy < touch2) fromGrid.push_back(seen.back());
+        });
+        for (int i = 0; i < c.count; i++) {
+            for (int j = i + 1; j < c.count; j++) {
+                const float dx = c.x[j] - c.x[i], dy = c.y[j] - c.y[i];
+                if (dx * dx + dy * dy < touch2) all.push_back(std::make_pair(i, j));
+            }
+        }
+        std::sort(fromGrid.begin(), fromGrid.end());
+        std::sort(seen.begin(), seen.end());
+        ok &= fromGrid == all;
+        ok &= std::adjacent_find(seen.begin(), seen.end()) == seen.end();
+        touching += (int)all.size();
+        grid += (int)seen.size();
+    }
+    printf("grid    5 steps: %d touching pairs, all found once among %d handed out (of %d in all) %s\n", touching,
+           grid, c.count * (c.count - 1) / 2 * 5, ok ? "ok" : "FAILED");
+    ChaosFree(c);
+    return ok;
+}
+
+static bool CheckBounds() {
+    PongState s;
+    ChaosBalls c;
+    StartMatch(s, c, 2000, 800, 600, 3);
+    bool ok = true;
+    for (int t = 0; t < 2400 && ok; t++) {
+        RunTicks(s, c, 1);
+        ok &= c.count == 2000;
+        for (int i = 0; i < c.count; i++) {
+            ok &= c.y[i] >= c.r && c.y[i] <= (float)s.h - c.r;
+            ok &= c.x[i] == c.x[i] && c.vx[i] == c.vx[i] && c.vy[i] == c.vy[i];
+        }
+    }
+    printf("bounds  2000 balls for 2400 ticks: none lost, none off the court %s (score %d - %d)\n", ok ? "ok" : "FAILED",
+           s.scoreL, s.scoreR);
+    ChaosFree(c);
+    return ok;
+}
+
+// How far the AIs' paddles move in 20 s of a 1920x1080 chaos game.
+static double AITravel(int balls) {
+    PongState s;
+    ChaosBalls c;
+    StartMatch(s, c, balls, 1920, 1080, 9);
+    double travel = 0.0;
+    float yL = s.left.y, yR = s.right.y;
+    const PongInput idle = {};
+    for (int t = 0; t < 20 * kTickHz; t++) {
+        ChaosUpdate(s, c, idle, kDt);
+        travel += fabsf(s.left.y - yL) + fabsf(s.right.y - yR);
+        yL = s.left.y;
+        yR = s.right.y;
+    }
+    ChaosFree(c);
+    return travel;
+}
+
+static bool CheckAI() {
+    const double few = AITravel(100), many = AITravel(1000);
+    const bool ok = many >= few * 0.5;
+    printf("ai      paddle travel in 20 s: %.0f px with 100 balls, %.0f px with 1000 %s\n", few, many,
+           ok ? "ok" : "FAILED");
+    return ok;
+}
+
+// ---- Benchmark ----
+// What the contact search alone costs without a broadphase.
+static uint32_t AllPairsContacts(const ChaosBalls& c) {
+    const float touch2 = 4.0f * c.r * c.r;
+    uint32_t contacts = 0;
+    for (int i = 0; i < c.count; i++) {
+        const float xi = c.x[i], yi = c.y[i];
+        for (int j = i + 1; j < c.count; j++) {
+            const float dx = c.x[j] - xi, dy = c.y[j] - yi;
+            contacts += dx * dx + dy * dy < touch2;
+        }
+    }
+    return contacts;
+}
+
+static volatile uint32_t g_sink;   // keeps the all-pairs loop from being optimized out
+
+template <typename F>
+static double TimeIt(F&& fn, int reps) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; i++) fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() / reps;
+}
+
+int main(int argc, char** argv) {
+    const int maxBalls = (argc > 1) ? atoi(argv[1]) : 8000;
+    const int ticks = (argc > 2) ? atoi(argv[2]) : 600;
+    if (maxBalls < 1 || ticks < 1) {
+        fprintf(stderr, "usage: %s [max balls] [ticks]\n", argv[0]);
+        return 1;
+    }
+    static const char* tierName[] = { "scalar", "sse2", "avx2" };
+    const NgSimdLevel best = NgDetectSimd();
+    bool ok = CheckTiers(best);
+    ok &= CheckBroadphase();
+    ok &= CheckBounds();
+    ok &= CheckAI();
+
+    printf("\n1920x1080 court, %d Hz, %d ticks per count, %s kernels\n", kTickHz, ticks, tierName[best]);
+    printf("%6s %6s %11s %11s %10s %10s %14s\n", "balls", "radius", "tick ms", "ns/ball", "pairs", "contacts",
+           "all-pairs ms");
+    static const int counts[] = { 100, 250, 500, 1000, 2000, 4000, 8000, 16000, 32000 };
+    for (int n : counts) {
+        if (n > maxBalls) break;
+        PongState s;
+        ChaosBalls c;
+        StartMatch(s, c, n, 1920, 1080, 5);
+        RunTicks(s, c, kTickHz);   // let the opening scatter settle
+        const double tick = TimeIt([&] { RunTicks(s, c, 1); }, ticks);
+        // Quadratic: sample fewer reps as it grows.
+        const int reps = std::max(1, std::min(ticks, 2000000000 / (n * n)));
+        const double allPairs = TimeIt([&] { g_sink = AllPairsContacts(c); }, reps);
+        printf("%6d %6.2f %11.4f %11.1f %10u %10u %14.4f\n", n, c.r, tick * 1e3, tick * 1e9 / n, c.pairTests,
+               c.contacts, allPairs * 1e3);
+        ChaosFree(c);
+    }
+    printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
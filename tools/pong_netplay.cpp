@@ -0,0 +1,212 @@
+// Loopback test for Pong rollback netplay (pong_net.h).
+//
+// Runs a host and a client in one process, talking over real UDP sockets on
+// 127.0.0.1, on a virtual 120 Hz clock so a run takes a fraction of its
+// game time. Outgoing packets go through NetLagQueue for latency, jitter
+// and loss. Both players are scripted and twitchy (they follow the ball
+// with noise and change direction often), so the remote paddle is
+// mispredicted regularly.
+//
+// For each round-trip time it reports how often each peer rolled back, how
+// deep, and what re-simulation cost per frame, plus how often a peer had to
+// stall (the only case where local input is delayed). Every frame both
+// peers consider final is checked against a straight offline simulation of
+// the true inputs; any mismatch fails the run.
+//
+// Build: g++ -O2 -std=c++11 tools/pong_netplay.cpp -o pong_netplay
+// Usage: pong_netplay [seconds=60] [jitter_ms=10] [loss_pct=2] [seed=1]
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "../Games/pongV1/pong_net.h"
+#include "../Games/common/udp.h"
+
+static const uint32_t kTickHz = 120;
+
+// Scripted player: chases the ball with a wobbling aim point, reacts a few
+// frames late and serves after a random pause.
+struct Player {
+    uint64_t rng;
+    float aim;
+    int hold, serveIn;
+    uint8_t bits;
+};
+
+static uint32_t Rand(Player& p) {
+    p.rng ^= p.rng << 13; p.rng ^= p.rng >> 7; p.rng ^= p.rng << 17;
+    return (uint32_t)(p.rng >> 32);
+}
+
+static uint8_t PlayerInput(Player& p, const PongState& s, int side) {
+    const Paddle& me = side ? s.right : s.left;
+    if (!s.ball.inPlay) {
+        if (p.serveIn <= 0) p.serveIn = 30 + (int)(Rand(p) % 90);
+        if (--p.serveIn == 0) return NET_SERVE;
+    }
+    if (p.hold > 0) {
+        p.hold--;
+        return p.bits;
+    }
+    p.aim = (float)((int)(Rand(p) % 61) - 30);
+    bool incoming = side ? s.ball.vx > 0 : s.ball.vx < 0;
+    float target = (incoming ? s.ball.y : s.h * 0.5f) + p.aim;
+    float dy = target - me.y;
+    p.bits = 0;
+    if (dy < -12) p.bits = NET_UP;
+    if (dy > 12) p.bits = NET_DOWN;
+    if (Rand(p) % 8 == 0) p.bits = (uint8_t)(Rand(p) % 3);   // fidget
+    p.hold = 2 + (int)(Rand(p) % 10);
+    return p.bits;
+}
+
+struct Peer {
+    NetSession net;
+    UdpSocket sock;
+    UdpAddr to;
+    NetLagQueue lag;
+    Player player;
+    std::vector<uint8_t> truth;    // local input of every simulated frame
+    uint32_t checked;              // frames compared with the reference
+};
+
+struct RunResult {
+    uint64_t frames[2], stalls[2], rollbacks[2], resim[2];
+    uint32_t maxDepth;
+    double resimSecs[2];
+    uint32_t checked, mismatches;
+    uint64_t dropped;
+};
+
+// Hash of the state after frame f, if the peer still holds it.
+static uint64_t HashAfter(const NetSession& n, uint32_t f) {
+    if (f + 1 == n.frame) return PongHash(n.state);
+    return PongHash(n.snaps[(f + 1) & (kNetRing - 1)]);
+}
+
+static bool RunOne(double rttMs, double jitterMs, double lossPct, int seconds, uint32_t seed, RunResult& r) {
+    static Peer peers[2];
+    memset(&r, 0, sizeof(r));
+    for (int i = 0; i < 2; i++) {
+        Peer& p = peers[i];
+        p.sock = UdpOpen(0);
+        if (p.sock == kUdpInvalid) return false;
+        p.truth.clear();
+        p.checked = 0;
+        p.player = Player{};
+        p.player.rng = (seed + 1) * 0x9E3779B97F4A7C15ull + (uint64_t)i * 0xD1B54A32D192ED03ull;
+        NetLagInit(p.lag, rttMs * 0.5e-3, jitterMs * 1e-3, (float)(lossPct * 0.01), p.player.rng ^ 0xABCDEF);
+    }
+    UdpResolve("127.0.0.1", UdpLocalPort(peers[1].sock), peers[0].to);
+    UdpResolve("127.0.0.1", UdpLocalPort(peers[0].sock), peers[1].to);
+
+    // Handshake straight over the sockets: HELLO, then WELCOME.
+    uint8_t buf[kNetPacketMax];
+    UdpSend(peers[1].sock, peers[1].to, buf, NetWriteHello(buf));
+    UdpAddr from;
+    int size = 0;
+    for (int tries = 0; tries < 1000 && size == 0; tries++) size = UdpRecv(peers[0].sock, buf, sizeof(buf), &from);
+    if (NetPacketKind(buf, size) != NET_HELLO || !UdpSameAddr(from, peers[0].to)) return false;
+    UdpSend(peers[0].sock, peers[0].to, buf, NetWriteWelcome(buf, seed, kTickHz, 800, 600));
+    size = 0;
+    for (int tries = 0; tries < 1000 && size == 0; tries++) size = UdpRecv(peers[1].sock, buf, sizeof(buf), nullptr);
+    if (NetPacketKind(buf, size) != NET_WELCOME) return false;
+    NetWelcome wel = NetReadWelcome(buf);
+    NetInit(peers[0].net, 0, seed, 800, 600, kTickHz);
+    NetInit(peers[1].net, 1, wel.seed, wel.w, wel.h, wel.tickHz);
+
+    PongState ref = peers[0].net.state;
+    uint32_t refFrame = 0;
+    std::vector<uint64_t> refHash;
+
+    const int ticks = seconds * (int)kTickHz;
+    for (int t = 0; t < ticks; t++) {
+        double now = (double)t / kTickHz;
+        for (Peer& p : peers) {
+            uint8_t out[kNetPacketMax];
+            while (int n = NetLagPop(p.lag, now, out)) UdpSend(p.sock, p.to, out, n);
+        }
+        for (Peer& p : peers) {
+            uint8_t in[kNetPacketMax];
+            while (int n = UdpRecv(p.sock, in, sizeof(in), nullptr)) NetReceiveInput(p.net, in, n);
+        }
+        for (int i = 0; i < 2; i++) {
+            Peer& p = peers[i];
+            uint8_t bits = PlayerInput(p.player, p.net.state, i);
+            if (NetTick(p.net, bits)) p.truth.push_back(bits);
+            uint8_t out[kNetPacketMax];
+            NetLagPush(p.lag, out, NetWriteInput(p.net, out), now);
+        }
+
+        // Extend the reference while both true inputs are known, then check
+        // every frame a peer has newly made final.
+        while (refFrame < peers[0].truth.size() && refFrame < peers[1].truth.size()) {
+            UpdateGame(ref, NetCombine(peers[0].truth[refFrame], peers[1].truth[refFrame]), peers[0].net.dt);
+            refHash.push_back(PongHash(ref));
+            refFrame++;
+        }
+        for (Peer& p : peers) {
+            uint32_t final = p.net.remoteConfirmed < p.net.frame ? p.net.remoteConfirmed : p.net.frame;
+            for (; p.checked < final && p.checked < refFrame; p.checked++) {
+                r.checked++;
+                if (HashAfter(p.net, p.checked) != refHash[p.checked]) r.mismatches++;
+            }
+        }
+    }
+
+    for (int i = 0; i < 2; i++) {
+        const NetStats& st = peers[i].net.stats;
+        r.frames[i] = st.frames;
+        r.stalls[i] = st.stalls;
+        r.rollbacks[i] = st.rollbacks;
+        r.resim[i] = st.resimFrames;
+        r.resimSecs[i] = st.resimSecs;
+        if (st.maxRollback > r.maxDepth) r.maxDepth = st.maxRollback;
+        r.dropped += peers[i].lag.dropped;
+        UdpClose(peers[i].sock);
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    int seconds = (argc > 1) ? atoi(argv[1]) : 60;
+    double jitterMs = (argc > 2) ? atof(argv[2]) : 10.0;
+    double lossPct = (argc > 3) ? atof(argv[3]) : 2.0;
+    uint32_t seed = (argc > 4) ? (uint32_t)strtoul(argv[4], nullptr, 10) : 1;
+    if (seconds < 1 || jitterMs < 0 || lossPct < 0 || lossPct >= 100) {
+        fprintf(stderr, "usage: %s [seconds] [jitter_ms] [loss_pct] [seed]\n", argv[0]);
+        return 1;
+    }
+    if (!UdpStartup()) {
+        fprintf(stderr, "no sockets\n");
+        return 1;
+    }
+
+    printf("%d s per run at %u Hz, jitter %.0f ms, loss %.1f%%, seed %u\n", seconds, kTickHz, jitterMs, lossPct, seed);
+    printf("%7s %8s %9s %9s %7s %10s %11s %10s %s\n", "rtt_ms", "stall%", "rb/frame", "avg_depth", "max",
+           "resim/frm", "resim_us/f", "dropped", "check");
+    const double rtts[] = { 0, 50, 100, 150, 250 };
+    int failures = 0;
+    for (double rtt : rtts) {
+        RunResult r;
+        if (!RunOne(rtt, jitterMs, lossPct, seconds, seed, r)) {
+            printf("%7.0f  loopback sockets failed\n", rtt);
+            failures++;
+            continue;
+        }
+        uint64_t frames = r.frames[0] + r.frames[1], ticks = 2ull * seconds * kTickHz;
+        uint64_t rollbacks = r.rollbacks[0] + r.rollbacks[1], resim = r.resim[0] + r.resim[1];
+        printf("%7.0f %7.2f%% %9.3f %9.2f %7u %10.2f %11.2f %10llu %u/%u frames match\n", rtt,
+               100.0 * (double)(r.stalls[0] + r.stalls[1]) / (double)ticks,
+               (double)rollbacks / (double)frames,
+               rollbacks ? (double)resim / (double)rollbacks : 0.0, r.maxDepth,
+               (double)resim / (double)frames,
+               (r.resimSecs[0] + r.resimSecs[1]) * 1e6 / (double)frames,
+               (unsigned long long)r.dropped, r.checked - r.mismatches, r.checked);
+        if (r.mismatches || r.checked < frames / 2) failures++;
+    }
+
+    UdpCleanup();
+    printf("%s\n", failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,161 @@
+// Headless Pong batch simulator.
+//
+// Steps thousands of independent AI matches through the platform-free core in
+// pong_core.h as fast as the CPU allows and reports throughput. The left
+// paddle is a scripted tracker, the right paddle is the game's own AI.
+//
+// `pong_sim check` instead runs property checks on the swept ball physics:
+// a rally stepped coarsely must end where the same rally stepped finely
+// does, and no step size or ball speed may carry the ball through a paddle.
+//
+// Build: g++ -O2 -std=c++11 tools/pong_sim.cpp -o pong_sim
+// Usage: pong_sim [matches=4096] [steps=3600] [hz=60]
+//        pong_sim check
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <chrono>
+
+#include "../Games/pongV1/pong_core.h"
+
+static const int kFieldW = 800;
+static const int kFieldH = 600;
+
+// Scripted left player: chase the ball with a small dead zone, serve at once.
+static PongInput ScriptedInput(const PongState& s) {
+    PongInput in{};
+    float diff = s.ball.y - s.left.y;
+    if (diff < -6.0f) in.down |= PONG_KEY_W;
+    if (diff > 6.0f) in.down |= PONG_KEY_S;
+    if (!s.ball.inPlay) in.pressed |= PONG_KEY_SPACE;
+    return in;
+}
+
+// Two-player game with nobody touching the keys: paddles stay put, so the
+// ball's path depends only on physics.
+static PongState IdleRally(uint32_t seed, float speedScale) {
+    PongState s{};
+    InitGame(s, kFieldW, kFieldH, seed);
+    ResetGame(s);
+    s.state = STATE_PLAYING;
+    s.ball.inPlay = true;
+    uint32_t r = seed;
+    r = r * 1664525u + 1013904223u;
+    s.ball.vy = ((float)(r >> 8) / 16777216.0f * 2.0f - 1.0f) * 300.0f;
+    s.ball.vx = ((r & 1) ? 320.0f : -320.0f);
+    s.ball.vx *= speedScale;
+    s.ball.vy *= speedScale;
+    return s;
+}
+
+static void RunFor(PongState& s, float seconds, float dt) {
+    int n = (int)(seconds / dt + 0.5f);
+    PongInput idle{};
+    for (int i = 0; i < n; i++) UpdateGame(s, idle, dt);
+}
+
+static int RunChecks() {
+    int failures = 0;
+
+    // Coarse vs fine: the same rallies at 1 kHz and at much larger steps, up
+    // to the whole rally in one update. The tolerance covers float rounding
+    // summed over the fine run's thousands of steps, not physics.
+    const float seconds = 3.0f;
+    const float coarse[] = { 1.0f / 60.0f, 0.05f, 0.25f, seconds };
+    const int rallies = 200;
+    for (float dt : coarse) {
+        float worst = 0.0f;
+        int mismatched = 0;
+        for (int i = 0; i < rallies; i++) {
+            PongState fine = IdleRally(0x1234567u + (uint32_t)i * 7919u, 1.0f);
+            PongState big = fine;
+            RunFor(fine, seconds, 1.0f / 1000.0f);
+            RunFor(big, seconds, dt);
+            bool same = fine.hits == big.hits && fine.scoreL == big.scoreL && fine.scoreR == big.scoreR &&
+                        fine.ball.inPlay == big.ball.inPlay;
+            float err = fabsf(fine.ball.x - big.ball.x) + fabsf(fine.ball.y - big.ball.y);
+            if (fine.ball.inPlay && err > worst) worst = err;
+            if (!same || (fine.ball.inPlay && err > 0.5f)) mismatched++;
+        }
+        printf("coarse vs fine  dt=%.4f  %d/%d rallies differ, worst position error %.4f px\n",
+               dt, mismatched, rallies, worst);
+        failures += mismatched;
+    }
+
+    // Tunnelling: serve straight at the right paddle at up to 64x speed and
+    // step with up to a whole second per update; it must always come back.
+    const float scales[] = { 1.0f, 4.0f, 16.0f, 64.0f };
+    const float steps[] = { 1.0f / 240.0f, 1.0f / 60.0f, 0.05f, 0.25f, 1.0f };
+    int tunnelled = 0, cases = 0;
+    for (float k : scales) {
+        for (float dt : steps) {
+            for (int i = 0; i < 50; i++) {
+                PongState s = IdleRally(0xBADC0DEu + (uint32_t)i, 1.0f);
+                float aim = ((float)i / 49.0f * 2.0f - 1.0f) * (s.right.h * 0.5f + s.ball.r - 0.5f);
+                s.ball.x = (float)kFieldW * 0.5f;
+                s.ball.y = s.right.y + aim;
+                s.ball.vx = 320.0f * k;
+                s.ball.vy = 0.0f;
+                PongInput idle{};
+                for (float t = 0.0f; t < 3.0f && s.ball.inPlay && s.hits == 0; t += dt) UpdateGame(s, idle, dt);
+                cases++;
+                if (s.hits == 0 || s.scoreL != 0) tunnelled++;
+            }
+        }
+    }
+    printf("tunnelling      %d/%d paddle-bound serves passed through\n", tunnelled, cases);
+    failures += tunnelled;
+
+    printf("%s\n", failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "check") == 0) return RunChecks();
+
+    int matches = (argc > 1) ? atoi(argv[1]) : 4096;
+    long steps = (argc > 2) ? atol(argv[2]) : 3600;
+    int hz = (argc > 3) ? atoi(argv[3]) : 60;
+    if (matches < 1 || steps < 1 || hz < 1) {
+        fprintf(stderr, "usage: %s [matches] [steps] [hz]\n", argv[0]);
+        return 1;
+    }
+    const float dt = 1.0f / (float)hz;
+
+    std::vector<PongState> games((size_t)matches);
+    for (int i = 0; i < matches; i++) {
+        PongState& s = games[(size_t)i];
+        InitGame(s, kFieldW, kFieldH, 0x9E3779B9u * (uint32_t)(i + 1));
+        s.aiMode = true;
+        ResetGame(s);
+        s.state = STATE_PLAYING;
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (long step = 0; step < steps; step++) {
+        for (PongState& s : games) {
+            UpdateGame(s, ScriptedInput(s), dt);
+        }
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    double secs = std::chrono::duration<double>(t1 - t0).count();
+
+    long long points = 0, hits = 0, leftWins = 0, rightWins = 0;
+    for (const PongState& s : games) {
+        points += s.scoreL + s.scoreR;
+        hits += s.hits;
+        if (s.scoreL > s.scoreR) leftWins++;
+        else if (s.scoreR > s.scoreL) rightWins++;
+    }
+
+    double total = (double)matches * (double)steps;
+    printf("matches:        %d\n", matches);
+    printf("steps/match:    %ld (%.1f s game time at %d Hz)\n", steps, steps * (double)dt, hz);
+    printf("wall time:      %.3f s\n", secs);
+    printf("steps/sec:      %.3e\n", total / secs);
+    printf("realtime x:     %.0f\n", total * dt / secs);
+    printf("points:         %lld (left leads %lld, right leads %lld)\n", points, leftWins, rightWins);
+    printf("paddle hits:    %lld (%.2f per point)\n", hits, points ? (double)hits / (double)points : 0.0);
+    return 0;
+}
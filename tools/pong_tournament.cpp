@@ -0,0 +1,410 @@
+// Pong AI tournament: sweeps the computer opponent's tunables over a grid.
+//
+// Every grid cell (one PongAIParams) plays a batch of headless matches
+// against a scripted player, or with `--vs-ai` against an AI on the shipped
+// defaults, on all cores through a small work-stealing pool. Each match is
+// seeded from (seed, cell, match) alone, and every random choice in it
+// (the AI's delays and the scripted player's aim) comes from that match's
+// own streams, so the tables are identical for any --threads.
+//
+// Prints the best cells by AI win rate with their rally lengths, then the
+// win rate and mean rally length for each value of each swept parameter.
+// --csv writes the whole grid.
+//
+// Build: g++ -O2 -std=c++11 -pthread tools/pong_tournament.cpp -o pong_tournament
+// Usage: pong_tournament [--vs-ai] [--matches=64] [--points=11] [--threads=N] [--seed=1]
+//                        [--check=12,24,36] [--delay=2/6/12,1/3/6,4/12/24] [--kp=4,8,16]
+//                        [--accel=1600,3200,6400] [--dead=1,2,4] [--perfect=0,7,3]
+//                        [--top=20] [--csv=out.csv]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../Games/pongV1/pong_core.h"
+
+static const int kFieldW = 800;
+static const int kFieldH = 600;
+static const int kTickHz = 120;
+static const float kMaxMatchSecs = 900.0f;   // give up on endless rallies
+static const int kMatchesPerTask = 4;
+
+// splitmix64: independent streams from (seed, cell, match).
+static uint64_t Mix(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// ======================================================
+// Scripted opponent: tracks the ball with a human-ish reaction time and an
+// aiming error re-rolled on every return, so it can be beaten.
+// ======================================================
+struct Scripted {
+    uint64_t rng;
+    float aimY;
+    float err;
+    float sinceLook;
+    int lastHits;
+};
+
+static float ScriptedRand(Scripted& p) {  // [-1, 1)
+    p.rng = p.rng * 6364136223846793005ull + 1442695040888963407ull;
+    return (float)(p.rng >> 40) / 8388608.0f - 1.0f;
+}
+
+static PongInput ScriptedInput(Scripted& p, const PongState& s, float dt) {
+    PongInput in{};
+    const Ball& b = s.ball;
+    if (s.hits != p.lastHits) {
+        p.lastHits = s.hits;
+        p.err = ScriptedRand(p) * (s.left.h * 0.5f + b.r) * 1.0f;
+    }
+    p.sinceLook += dt;
+    if (p.sinceLook >= 0.15f) {   // looks at the ball ~7 times a second
+        p.sinceLook = 0.0f;
+        p.aimY = (b.inPlay && b.vx < 0.0f) ? b.y + p.err : s.h * 0.5f;
+    }
+    float diff = p.aimY - s.left.y;
+    if (diff < -6.0f) in.down |= PONG_KEY_W;
+    if (diff > 6.0f) in.down |= PONG_KEY_S;
+    if (!b.inPlay) in.pressed |= PONG_KEY_SPACE;
+    return in;
+}
+
+// ======================================================
+// Grid
+// ======================================================
+struct Axes {
+    std::vector<float> check, kp, accel, dead;
+    std::vector<int> perfect;
+    std::vector<int> delay;   // triples: lead, a, b
+};
+
+struct MatchStats {
+    int aiWins, matches;
+    long long aiPoints, oppPoints;
+    long long rallies, rallyHits, maxRallyHits;
+    double rallySecs;
+};
+
+static void AddStats(MatchStats& a, const MatchStats& b) {
+    a.aiWins += b.aiWins;
+    a.matches += b.matches;
+    a.aiPoints += b.aiPoints;
+    a.oppPoints += b.oppPoints;
+    a.rallies += b.rallies;
+    a.rallyHits += b.rallyHits;
+    a.rallySecs += b.rallySecs;
+    if (b.maxRallyHits > a.maxRallyHits) a.maxRallyHits = b.maxRallyHits;
+}
+
+struct Config {
+    bool vsAi;
+    int matches, points, threads, top;
+    uint64_t seed;
+    const char* csv;
+};
+
+static MatchStats PlayMatch(const Config& cfg, const PongAIParams& params, uint64_t matchSeed) {
+    PongState s;
+    InitGame(s, kFieldW, kFieldH, (uint32_t)Mix(matchSeed));
+    s.aiMode = true;
+    s.aiLeft = cfg.vsAi;
+    s.aiR.params = params;
+    ResetGame(s);
+    s.state = STATE_PLAYING;
+
+    Scripted player = { Mix(matchSeed ^ 0x5C0DEull), s.h * 0.5f, 0.0f, 0.0f, 0 };
+    const float dt = 1.0f / kTickHz;
+    MatchStats st = {};
+    st.matches = 1;
+    int pointStartHits = 0;
+    float rallyTime = 0.0f;
+    const long long maxTicks = (long long)(kMaxMatchSecs * kTickHz);
+    for (long long t = 0; t < maxTicks && s.scoreL < cfg.points && s.scoreR < cfg.points; t++) {
+        PongInput in{};
+        if (cfg.vsAi) {
+            if (!s.ball.inPlay) in.pressed = PONG_KEY_SPACE;
+        } else {
+            in = ScriptedInput(player, s, dt);
+        }
+        int before = s.scoreL + s.scoreR;
+        if (s.ball.inPlay) rallyTime += dt;
+        UpdateGame(s, in, dt);
+        if (s.scoreL + s.scoreR != before) {
+            long long hits = s.hits - pointStartHits;
+            pointStartHits = s.hits;
+            st.rallies++;
+            st.rallyHits += hits;
+            st.rallySecs += rallyTime;
+            if (hits > st.maxRallyHits) st.maxRallyHits = hits;
+            rallyTime = 0.0f;
+        }
+    }
+    st.aiPoints = s.scoreR;
+    st.oppPoints = s.scoreL;
+    st.aiWins = s.scoreR > s.scoreL ? 1 : 0;
+    return st;
+}
+
+// ======================================================
+// Work-stealing pool: each worker owns a deque of tasks, takes from its
+// back and, when empty, steals from the front of the others'.
+// ======================================================
+struct WorkQueue {
+    std::mutex lock;
+    std::deque<int> tasks;
+};
+
+template <typename F>
+static void RunPool(int taskCount, int threads, F&& work) {
+    std::vector<WorkQueue> queues((size_t)threads);
+    for (int t = 0; t < taskCount; t++) queues[(size_t)(t % threads)].tasks.push_back(t);
+
+    auto worker = [&](int self) {
+        for (;;) {
+            int task = -1;
+            {
+                WorkQueue& q = queues[(size_t)self];
+                std::lock_guard<std::mutex> g(q.lock);
+                if (!q.tasks.empty()) { task = q.tasks.back(); q.tasks.pop_back(); }
+            }
+            for (int i = 1; task < 0 && i < threads; i++) {
+                WorkQueue& q = queues[(size_t)((self + i) % threads)];
+                std::lock_guard<std::mutex> g(q.lock);
+                if (!q.tasks.empty()) { task = q.tasks.front(); q.tasks.pop_front(); }
+            }
+            if (task < 0) return;   // nothing is ever added, so empty everywhere means done
+            work(task);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; t++) pool.emplace_back(worker, t);
+    worker(0);
+    for (std::thread& th : pool) th.join();
+}
+
+// ======================================================
+// Command line
+// ======================================================
+template <typename T>
+static bool ParseList(const char* s, std::vector<T>& out) {
+    out.clear();
+    while (*s) {
+        char* end;
+        double v = strtod(s, &end);
+        if (end == s) return false;
+        out.push_back((T)v);
+        s = (*end == ',') ? end + 1 : end;
+        if (*end && *end != ',') return false;
+    }
+    return !out.empty();
+}
+
+static bool ParseDelays(const char* s, std::vector<int>& out) {
+    out.clear();
+    while (*s) {
+        int a, b, c, n = 0;
+        if (sscanf(s, "%d/%d/%d%n", &a, &b, &c, &n) != 3 || a < 0 || b < 0 || c < 0) return false;
+        out.push_back(a); out.push_back(b); out.push_back(c);
+        s += n;
+        if (*s == ',') s++;
+        else if (*s) return false;
+    }
+    return !out.empty();
+}
+
+static std::string NumStr(float v) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%g", v);
+    return buf;
+}
+
+static std::string DelayStr(const PongAIParams& p) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%d/%d/%d", p.leadDelay, p.delayA, p.delayB);
+    return buf;
+}
+
+static void PrintCellHeader() {
+    printf("%6s %5s %7s %9s %5s %7s | %6s %9s %10s %10s %8s\n", "check", "kp", "accel", "delay", "dead",
+           "perfect", "win%", "points", "rally hits", "rally s", "max hits");
+}
+
+static void PrintCell(const PongAIParams& p, const MatchStats& st) {
+    char pts[32];
+    snprintf(pts, sizeof(pts), "%.1f:%.1f", (double)st.aiPoints / st.matches, (double)st.oppPoints / st.matches);
+    printf("%6.0f %5.1f %7.0f %9s %5.1f %7d | %6.1f %9s %10.2f %10.2f %8lld\n", p.checkFrames, p.kp, p.accel,
+           DelayStr(p).c_str(), p.deadZone, p.perfectEvery, 100.0 * st.aiWins / st.matches, pts,
+           st.rallies ? (double)st.rallyHits / st.rallies : 0.0, st.rallies ? st.rallySecs / st.rallies : 0.0,
+           st.maxRallyHits);
+}
+
+int main(int argc, char** argv) {
+    Config cfg = { false, 64, 11, (int)std::thread::hardware_concurrency(), 20, 1, nullptr };
+    Axes ax;
+    ax.check = { 12.0f, 24.0f, 36.0f };
+    ax.delay = { 2, 6, 12,  1, 3, 6,  4, 12, 24 };
+    ax.kp = { 4.0f, 8.0f, 16.0f };
+    ax.accel = { 1600.0f, 3200.0f, 6400.0f };
+    ax.dead = { 1.0f, 2.0f, 4.0f };
+    ax.perfect = { 0, 7, 3 };
+
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        bool ok = true;
+        if (strcmp(a, "--vs-ai") == 0) cfg.vsAi = true;
+        else if (strncmp(a, "--matches=", 10) == 0) cfg.matches = atoi(a + 10);
+        else if (strncmp(a, "--points=", 9) == 0) cfg.points = atoi(a + 9);
+        else if (strncmp(a, "--threads=", 10) == 0) cfg.threads = atoi(a + 10);
+        else if (strncmp(a, "--seed=", 7) == 0) cfg.seed = strtoull(a + 7, nullptr, 10);
+        else if (strncmp(a, "--top=", 6) == 0) cfg.top = atoi(a + 6);
+        else if (strncmp(a, "--csv=", 6) == 0) cfg.csv = a + 6;
+        else if (strncmp(a, "--check=", 8) == 0) ok = ParseList(a + 8, ax.check);
+        else if (strncmp(a, "--delay=", 8) == 0) ok = ParseDelays(a + 8, ax.delay);
+        else if (strncmp(a, "--kp=", 5) == 0) ok = ParseList(a + 5, ax.kp);
+        else if (strncmp(a, "--accel=", 8) == 0) ok = ParseList(a + 8, ax.accel);
+        else if (strncmp(a, "--dead=", 7) == 0) ok = ParseList(a + 7, ax.dead);
+        else if (strncmp(a, "--perfect=", 10) == 0) ok = ParseList(a + 10, ax.perfect);
+        else ok = false;
+        if (!ok) {
+            fprintf(stderr, "bad argument: %s (see the header of pong_tournament.cpp)\n", a);
+            return 1;
+        }
+    }
+    if (cfg.threads < 1) cfg.threads = 1;
+    if (cfg.matches < 1 || cfg.points < 1) {
+        fprintf(stderr, "--matches and --points must be positive\n");
+        return 1;
+    }
+
+    // Cells in a fixed order: check, delay, kp, accel, dead, perfect.
+    std::vector<PongAIParams> cells;
+    for (float check : ax.check)
+        for (size_t d = 0; d < ax.delay.size(); d += 3)
+            for (float kp : ax.kp)
+                for (float accel : ax.accel)
+                    for (float dead : ax.dead)
+                        for (int perfect : ax.perfect) {
+                            PongAIParams p = kPongAIDefaults;
+                            p.checkFrames = check;
+                            p.leadDelay = ax.delay[d];
+                            p.delayA = ax.delay[d + 1];
+                            p.delayB = ax.delay[d + 2];
+                            p.kp = kp;
+                            p.accel = accel;
+                            p.deadZone = dead;
+                            p.perfectEvery = perfect;
+                            cells.push_back(p);
+                        }
+
+    // Tasks are runs of kMatchesPerTask matches in one cell, each writing
+    // its own slot; slots are summed in order afterwards.
+    const int tasksPerCell = (cfg.matches + kMatchesPerTask - 1) / kMatchesPerTask;
+    const int taskCount = (int)cells.size() * tasksPerCell;
+    std::vector<MatchStats> slots((size_t)taskCount);
+
+    auto t0 = std::chrono::steady_clock::now();
+    RunPool(taskCount, cfg.threads, [&](int task) {
+        int cell = task / tasksPerCell;
+        int first = (task % tasksPerCell) * kMatchesPerTask;
+        int last = std::min(first + kMatchesPerTask, cfg.matches);
+        MatchStats st = {};
+        for (int m = first; m < last; m++) {
+            uint64_t matchSeed = Mix(Mix(cfg.seed) ^ ((uint64_t)cell << 32) ^ (uint64_t)m);
+            AddStats(st, PlayMatch(cfg, cells[(size_t)cell], matchSeed));
+        }
+        slots[(size_t)task] = st;
+    });
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::vector<MatchStats> results(cells.size());
+    MatchStats total = {};
+    for (int t = 0; t < taskCount; t++) AddStats(results[(size_t)(t / tasksPerCell)], slots[(size_t)t]);
+    for (const MatchStats& r : results) AddStats(total, r);
+
+    printf("%zu cells x %d matches to %d vs %s, %d threads: %.2f s (%.0f matches/s)\n\n", cells.size(),
+           cfg.matches, cfg.points, cfg.vsAi ? "default AI" : "scripted player", cfg.threads, secs,
+           total.matches / secs);
+
+    // Best cells by win rate; ties keep grid order.
+    std::vector<size_t> order(cells.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return results[a].aiWins * (long long)results[b].matches > results[b].aiWins * (long long)results[a].matches;
+    });
+    printf("top %d cells by AI win rate\n", std::min(cfg.top, (int)cells.size()));
+    PrintCellHeader();
+    for (int i = 0; i < cfg.top && i < (int)order.size(); i++) PrintCell(cells[order[i]], results[order[i]]);
+
+    int defaultCell = -1;
+    for (size_t i = 0; i < cells.size(); i++) {
+        const PongAIParams& p = cells[i];
+        const PongAIParams& d = kPongAIDefaults;
+        if (p.checkFrames == d.checkFrames && p.leadDelay == d.leadDelay && p.delayA == d.delayA &&
+            p.delayB == d.delayB && p.kp == d.kp && p.accel == d.accel && p.deadZone == d.deadZone &&
+            p.perfectEvery == d.perfectEvery) defaultCell = (int)i;
+    }
+    if (defaultCell >= 0) {
+        printf("\nshipped defaults\n");
+        PrintCellHeader();
+        PrintCell(cells[(size_t)defaultCell], results[(size_t)defaultCell]);
+    }
+
+    // Marginals: every cell sharing one value of one parameter, pooled.
+    struct Axis { const char* name; std::string (*key)(const PongAIParams&); };
+    const Axis axes[] = {
+        { "check", [](const PongAIParams& p) { return NumStr(p.checkFrames); } },
+        { "delay", [](const PongAIParams& p) { return DelayStr(p); } },
+        { "kp", [](const PongAIParams& p) { return NumStr(p.kp); } },
+        { "accel", [](const PongAIParams& p) { return NumStr(p.accel); } },
+        { "dead", [](const PongAIParams& p) { return NumStr(p.deadZone); } },
+        { "perfect", [](const PongAIParams& p) { return NumStr((float)p.perfectEvery); } },
+    };
+    printf("\nper-parameter win rate / mean rally hits\n");
+    for (const Axis& axis : axes) {
+        std::vector<std::string> keys;
+        std::vector<MatchStats> pooled;
+        for (size_t i = 0; i < cells.size(); i++) {
+            std::string k = axis.key(cells[i]);
+            size_t j = std::find(keys.begin(), keys.end(), k) - keys.begin();
+            if (j == keys.size()) { keys.push_back(k); pooled.push_back(MatchStats{}); }
+            AddStats(pooled[j], results[i]);
+        }
+        printf("  %-8s", axis.name);
+        for (size_t j = 0; j < keys.size(); j++) {
+            const MatchStats& st = pooled[j];
+            printf("  %s: %5.1f%% / %.2f", keys[j].c_str(), 100.0 * st.aiWins / st.matches,
+                   st.rallies ? (double)st.rallyHits / st.rallies : 0.0);
+        }
+        printf("\n");
+    }
+
+    if (cfg.csv) {
+        FILE* f = fopen(cfg.csv, "w");
+        if (!f) {
+            fprintf(stderr, "failed to write %s\n", cfg.csv);
+            return 1;
+        }
+        fprintf(f, "check,lead_delay,delay_a,delay_b,kp,accel,dead,perfect,matches,ai_wins,ai_points,opp_points,"
+                   "rallies,mean_rally_hits,mean_rally_secs,max_rally_hits\n");
+        for (size_t i = 0; i < cells.size(); i++) {
+            const PongAIParams& p = cells[i];
+            const MatchStats& st = results[i];
+            fprintf(f, "%g,%d,%d,%d,%g,%g,%g,%d,%d,%d,%lld,%lld,%lld,%.4f,%.4f,%lld\n", p.checkFrames, p.leadDelay,
+                    p.delayA, p.delayB, p.kp, p.accel, p.deadZone, p.perfectEvery, st.matches, st.aiWins,
+                    st.aiPoints, st.oppPoints, st.rallies, st.rallies ? (double)st.rallyHits / st.rallies : 0.0,
+                    st.rallies ? st.rallySecs / st.rallies : 0.0, st.maxRallyHits);
+        }
+        fclose(f);
+    }
+    return 0;
+}
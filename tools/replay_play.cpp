@@ -0,0 +1,160 @@
+// Headless replay player for Pong and Bird Up.
+//
+// Re-simulates a recording made with -record=path through the game's core
+// as fast as the CPU allows, checks the final state hash against the one
+// stored in the file and reports speed against real time. Also writes
+// synthetic recordings from scripted players, for a regression corpus
+// that doesn't need a Windows box.
+//
+// Build: g++ -O2 -std=c++11 tools/replay_play.cpp -o replay_play
+// Usage: replay_play <file.ngr> [repeat=1]
+//        replay_play record-pong <out.ngr> [ticks=432000] [seed=1]
+//        replay_play record-bird <out.ngr> [ticks=432000] [seed=1]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#include "../Games/common/replay.h"
+#include "../Games/pongV1/pong_core.h"
+#include "../Games/Bird Up/birdup_core.h"
+
+static const int kTickHz = 120;
+
+// Runs every tick of the replay; returns the final state hash.
+static uint64_t Simulate(const Replay& r, uint64_t* ticksRun, bool* bad) {
+    ReplayReader rd = ReplayRead(r);
+    const float dt = ReplayTickDt(r.hdr.tickHz);
+    uint32_t bits;
+    uint64_t n = 0;
+    uint64_t hash = 0;
+    if (r.hdr.game == REPLAY_GAME_PONG) {
+        PongState s;
+        InitGame(s, r.hdr.w, r.hdr.h, r.hdr.seed);
+        while (ReplayNext(rd, &bits)) {
+            UpdateGame(s, PongInputFromBits(bits), dt);
+            n++;
+        }
+        hash = PongHash(s);
+    } else {
+        BirdGame g;
+        bird_init(&g, r.hdr.w, r.hdr.h, r.hdr.seed);
+        while (ReplayNext(rd, &bits)) {
+            bird_tick(&g, bits, dt);
+            n++;
+        }
+        hash = bird_hash(&g);
+    }
+    *ticksRun = n;
+    *bad = rd.bad;
+    return hash;
+}
+
+static int Play(const char* path, int repeat) {
+    Replay r{};
+    if (!ReplayLoad(r, path)) {
+        fprintf(stderr, "%s: not a readable replay\n", path);
+        return 1;
+    }
+    if (r.hdr.game != REPLAY_GAME_PONG && r.hdr.game != REPLAY_GAME_BIRDUP) {
+        fprintf(stderr, "%s: unknown game %u\n", path, r.hdr.game);
+        ReplayFree(r);
+        return 1;
+    }
+
+    uint64_t ticks = 0, hash = 0;
+    bool bad = false;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; i++) hash = Simulate(r, &ticks, &bad);
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() / repeat;
+
+    double gameSecs = (double)ticks / r.hdr.tickHz;
+    bool ok = !bad && ticks == r.hdr.ticks && hash == r.hdr.finalHash;
+    printf("game:        %s, seed %u, %dx%d at %u Hz\n", r.hdr.game == REPLAY_GAME_PONG ? "pong" : "birdup",
+           r.hdr.seed, r.hdr.w, r.hdr.h, r.hdr.tickHz);
+    printf("ticks:       %llu (%.1f s of play), body %zu bytes (%.1f bytes/min)\n", (unsigned long long)ticks,
+           gameSecs, r.size, gameSecs > 0.0 ? r.size * 60.0 / gameSecs : 0.0);
+    printf("replay time: %.3f ms (%.3e ticks/s, %.0fx realtime)\n", secs * 1e3, ticks / secs, gameSecs / secs);
+    printf("final hash:  %016llx (recorded %016llx) %s\n", (unsigned long long)hash,
+           (unsigned long long)r.hdr.finalHash, ok ? "ok" : "MISMATCH");
+    ReplayFree(r);
+    return ok ? 0 : 1;
+}
+
+// Scripted Pong session: pick "vs Computer", then track the ball with the
+// left paddle and serve straight away, as pong_sim does.
+static uint32_t PongScript(const PongState& s, uint32_t prevDown) {
+    PongInput in{};
+    if (s.state == STATE_MENU) {
+        in.pressed = PONG_KEY_2;
+    } else {
+        float diff = s.ball.y - s.left.y;
+        if (diff < -6.0f) in.down |= PONG_KEY_W;
+        if (diff > 6.0f) in.down |= PONG_KEY_S;
+        if (!s.ball.inPlay) in.down |= PONG_KEY_SPACE;
+    }
+    in.pressed |= in.down & ~prevDown;
+    return PongInputBits(in);
+}
+
+// Scripted Bird Up session: flap when falling below the next gap; after a
+// crash, release and press again to restart.
+static uint32_t BirdScript(const BirdGame& g, uint32_t prevDown) {
+    float gap = g.obs[0].gapY;
+    float best = 1e30f;
+    for (int k = 0; k < OB_COUNT; ++k) {
+        float right = g.obs[k].x + (float)OB_W;
+        if (right >= (float)(BIRD_X - BIRD_R) && g.obs[k].x < best) { best = g.obs[k].x; gap = g.obs[k].gapY; }
+    }
+    uint32_t down = (g.birdV > 0.0f && g.birdY > gap + 10.0f) ? BIRD_KEY_SPACE : 0;
+    if (!g.alive) down = (prevDown & BIRD_KEY_SPACE) ? 0 : BIRD_KEY_SPACE;
+    return down | ((down & ~prevDown) << 16);
+}
+
+static int Record(bool pong, const char* path, uint32_t ticks, uint32_t seed) {
+    Replay r{};
+    const float dt = ReplayTickDt(kTickHz);
+    uint32_t bits = 0;
+    if (pong) {
+        PongState s;
+        InitGame(s, 800, 600, seed);
+        ReplayBegin(r, REPLAY_GAME_PONG, seed, kTickHz, s.w, s.h);
+        for (uint32_t i = 0; i < ticks; i++) {
+            bits = PongScript(s, bits & 0xFFFF);
+            UpdateGame(s, PongInputFromBits(bits), dt);
+            ReplayRecord(r, bits);
+        }
+        ReplayFinish(r, PongHash(s));
+    } else {
+        BirdGame g;
+        bird_init(&g, 640, 480, seed);
+        ReplayBegin(r, REPLAY_GAME_BIRDUP, seed, kTickHz, g.w, g.h);
+        for (uint32_t i = 0; i < ticks; i++) {
+            bits = BirdScript(g, bits & 0xFFFF);
+            bird_tick(&g, bits, dt);
+            ReplayRecord(r, bits);
+        }
+        ReplayFinish(r, bird_hash(&g));
+    }
+    bool ok = ReplaySave(r, path);
+    if (ok) printf("wrote %s: %u ticks, %zu body bytes\n", path, r.hdr.ticks, r.size);
+    else fprintf(stderr, "failed to write %s\n", path);
+    ReplayFree(r);
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 3 && (strcmp(argv[1], "record-pong") == 0 || strcmp(argv[1], "record-bird") == 0)) {
+        uint32_t ticks = (argc > 3) ? (uint32_t)strtoul(argv[3], nullptr, 10) : 432000;
+        uint32_t seed = (argc > 4) ? (uint32_t)strtoul(argv[4], nullptr, 10) : 1;
+        return Record(strcmp(argv[1], "record-pong") == 0, argv[2], ticks, seed);
+    }
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <file.ngr> [repeat]\n"
+                        "       %s record-pong|record-bird <out.ngr> [ticks] [seed]\n", argv[0], argv[0]);
+        return 1;
+    }
+    int repeat = (argc > 2) ? atoi(argv[2]) : 1;
+    if (repeat < 1) repeat = 1;
+    return Play(argv[1], repeat);
+}
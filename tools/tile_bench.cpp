@@ -0,0 +1,273 @@
+// Tile-parallel renderer (common/tiles.h): checks and scaling benchmark.
+//
+// Draws a heavy Pong frame (the whole background restored, paddles, a
+// chaos court of AA balls, HUD text and a particle burst) at 1080p, 4K and
+// 8K, first straight onto the surface with the primitives the game used
+// to call one by one, then recorded and rendered through the tiles on
+// 1..N threads. Checks that
+//   - every thread count produces exactly the direct frame, for that
+//     frame and for a scene of shapes, blits, text and particles hanging
+//     off every edge of a surface that isn't a whole number of tiles,
+//   - once the first frame has sized the command and bin storage, no
+//     further frame allocates.
+// Reports ms per frame and the speedup over one thread for each size.
+//
+// Build: g++ -O2 -std=c++11 -pthread tools/tile_bench.cpp -o tile_bench
+// Usage: tile_bench [max threads=all cores] [frames=20]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "../Games/common/hash.h"
+#include "../Games/common/sprite.h"
+#include "../Games/common/tiles.h"
+
+struct Ball {
+    float x, y;
+};
+
+// Everything a frame draws, sized for w x h.
+struct Scene {
+    int w, h;
+    Surface background;
+    std::vector<Ball> balls;
+    float r;
+    int paddleW, paddleH;
+    Font font;
+    TextRun hud, score;
+    ParticlePool fx;
+};
+
+static uint32_t g_seed = 99;
+static float RandF(float lo, float hi) {
+    g_seed = g_seed * 1664525u + 1013904223u;
+    return lo + (hi - lo) * (float)(g_seed >> 8) * (1.0f / 16777216.0f);
+}
+
+static void SceneInit(Scene& sc, int w, int h, int balls) {
+    sc.w = w;
+    sc.h = h;
+    sc.background.pixels = (uint32_t*)NgAlignedAlloc((size_t)w * h * 4, 64);
+    sc.background.w = sc.background.stride = w;
+    sc.background.h = h;
+    RasterClear(sc.background, 0x28281E);
+    for (int y = 0; y < h; y += h / 30) RasterFillRect(sc.background, w / 2 - 2, y, w / 2 + 2, y + h / 60, 0x5F5050);
+
+    // The court at 1080p scaled up: same ball count, balls and text grow.
+    const float k = h / 1080.0f;
+    g_seed = 99;
+    sc.r = 5.0f * k;
+    sc.balls.resize(balls);
+    for (Ball& b : sc.balls) {
+        b.x = RandF(0.0f, (float)w);
+        b.y = RandF(sc.r, h - sc.r);
+    }
+    sc.paddleW = (int)(14 * k);
+    sc.paddleH = (int)(110 * k);
+
+    FontInit(sc.font, 2 * (int)(k + 0.5f));
+    memset(&sc.hud, 0, sizeof(sc.hud));
+    memset(&sc.score, 0, sizeof(sc.score));
+    TextRunSet(sc.hud, sc.font, "W/S (Left)   Up/Down (Right)   Space=Serve   R=Reset   Mode: vs Computer");
+    TextRunSet(sc.score, sc.font, "Score: 1234 - 1187");
+
+    ParticleInit(sc.fx, 4096, 0.0f, 1.0f);
+    ParticleBurst burst = { w * 0.7f, h * 0.4f, 0.0f, 3.14159265f, 10.0f, 300.0f * k, 0.5f, 1.5f, 0x96EBFF, 4096 };
+    ParticleEmit(sc.fx, burst);
+    ParticleUpdate(sc.fx, 0.5f);   // spread the burst out
+}
+
+static void SceneFree(Scene& sc) {
+    NgAlignedFree(sc.background.pixels);
+    ParticleFree(sc.fx);
+}
+
+// The frame as the game drew it before: one primitive after another.
+static void DrawDirect(Scene& sc, const Surface& s) {
+    for (int y = 0; y < sc.h; y++) {
+        memcpy(s.pixels + (size_t)y * s.stride, sc.background.pixels + (size_t)y * sc.background.stride, (size_t)sc.w * 4);
+    }
+    const int py = sc.h / 2 - sc.paddleH / 2;
+    RasterFillRect(s, 40, py, 40 + sc.paddleW, py + sc.paddleH, 0x49E80F);
+    RasterFillRect(s, sc.w - 40 - sc.paddleW, py + 30, sc.w - 40, py + 30 + sc.paddleH, 0x49E80F);
+    for (const Ball& b : sc.balls) RasterFillCircleAA(s, b.x, b.y, sc.r, 0x04BAFC);
+    ParticleDraw(sc.fx, s, 1 + sc.h / 400);
+    TextRunDraw(s, sc.hud, 12, 10, 0xF0F0F0);
+    TextRunDraw(s, sc.score, 12, 14 + sc.font.lineH, 0xF0F0F0);
+}
+
+// The same frame recorded for the tiles.
+static void Record(Scene& sc, TileFrame& f, const Surface& s) {
+    TileFrameBegin(f, s);
+    TileCopy(f, sc.background, 0, 0, 0, 0, sc.w, sc.h);
+    const int py = sc.h / 2 - sc.paddleH / 2;
+    TileFill(f, 40, py, 40 + sc.paddleW, py + sc.paddleH, 0x49E80F);
+    TileFill(f, sc.w - 40 - sc.paddleW, py + 30, sc.w - 40, py + 30 + sc.paddleH, 0x49E80F);
+    for (const Ball& b : sc.balls) TileEllipseAA(f, b.x, b.y, sc.r, sc.r, 0x04BAFC);
+    TileParticles(f, sc.fx, 1 + sc.h / 400);
+    TileText(f, sc.hud, 12, 10, 0xF0F0F0);
+    TileText(f, sc.score, 12, 14 + sc.font.lineH, 0xF0F0F0);
+}
+
+static uint64_t HashSurface(const Surface& s) {
+    uint64_t h = kHashSeed;
+    for (int y = 0; y < s.h; y++) h = HashBytes(h, s.pixels + (size_t)y * s.stride, (size_t)s.w * 4);
+    return h;
+}
+
+// Random commands of every kind, many straddling tiles and the edges,
+// direct and tiled on 1-3 threads.
+static bool CheckEdges() {
+    const int w = 1001, h = 563;
+    std::vector<uint32_t> direct((size_t)w * h), tiled((size_t)w * h);
+    Surface ds = { direct.data(), w, h, w }, ts = { tiled.data(), w, h, w };
+    Surface sprite;
+    SpriteAlloc(sprite, 300, 200);
+    for (int y = 0; y < sprite.h; y++) {
+        for (int x = 0; x < sprite.w; x++) sprite.pixels[(size_t)y * sprite.stride + x] = (uint32_t)(x * 0x10203 + y * 0x30201);
+    }
+    Font font;
+    FontInit(font, 3);
+    TextRun run;
+    memset(&run, 0, sizeof(run));
+    TextRunSet(run, font, "Tiles: 0123456789 ABCDEFGHIJKLMNOPQRSTUVWXYZ");
+    ParticlePool fx;
+    ParticleInit(fx, 3000, 0.0f, 1.0f);
+    ParticleBurst burst = { w - 30.0f, 20.0f, 2.5f, 3.14159265f, 10.0f, 600.0f, 0.5f, 1.5f, 0x403020, 3000 };
+    ParticleEmit(fx, burst);
+    ParticleUpdate(fx, 0.4f);
+
+    TileFrame f;
+    memset(&f, 0, sizeof(f));
+    bool ok = true;
+    for (int threads = 1; threads <= 3; threads++) {
+        TilePool pool;
+        TilePoolStart(pool, threads - 1);
+        RasterClear(ds, 0x101010);
+        RasterClear(ts, 0x101010);
+        TileFrameBegin(f, ts);
+        g_seed = 5;
+        for (int i = 0; i < 600; i++) {
+            const float x = RandF(-150.0f, w + 150.0f), y = RandF(-150.0f, h + 150.0f);
+            const uint32_t color = (uint32_t)(g_seed >> 8) & 0xFFFFFF;
+            switch (i % 5) {
+            case 0: {
+                const float rx = RandF(0.4f, 120.0f), ry = (i % 10 == 0) ? rx * RandF(0.2f, 5.0f) : rx;
+                RasterFillEllipseAA(ds, x, y, rx, ry, color);
+                TileEllipseAA(f, x, y, rx, ry, color);
+                break;
+            }
+            case 1: {
+                const int x1 = (int)(x + RandF(0.0f, 400.0f)), y1 = (int)(y + RandF(0.0f, 300.0f));
+                RasterFillRect(ds, (int)x, (int)y, x1, y1, color);
+                TileFill(f, (int)x, (int)y, x1, y1, color);
+                break;
+            }
+            case 2:
+                Blit(ds, sprite, (int)x - 150, (int)y - 100);
+                TileCopy(f, sprite, (int)x - 150, (int)y - 100, (int)x - 150, (int)y - 100, (int)x + 150, (int)y + 100);
+                break;
+            case 3:
+                TextRunDraw(ds, run, (int)x - 300, (int)y, color);
+                TileText(f, run, (int)x - 300, (int)y, color);
+                break;
+            default:
+                if (i % 100 == 4) {
+                    ParticleDraw(fx, ds, 1 + i % 3);
+                    TileParticles(f, fx, 1 + i % 3);
+                }
+                break;
+            }
+        }
+        TileRender(f, &pool);
+        TilePoolStop(pool);
+        int diff = 0;
+        for (size_t i = 0; i < direct.size(); i++) diff += direct[i] != tiled[i];
+        printf("edges   %dx%d, %d thread%s: %d pixels differ %s\n", w, h, threads, threads > 1 ? "s" : "", diff,
+               diff ? "FAILED" : "ok");
+        ok &= diff == 0;
+    }
+    TileFrameFree(f);
+    ParticleFree(fx);
+    SpriteFree(sprite);
+    return ok;
+}
+
+template <typename F>
+static double TimeFrames(F&& fn, int frames) {
+    fn(); // warm up
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++) fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() / frames;
+}
+
+int main(int argc, char** argv) {
+    const int maxThreads = (argc > 1) ? atoi(argv[1]) : TileDefaultThreads();
+    const int frames = (argc > 2) ? atoi(argv[2]) : 20;
+    if (maxThreads < 1 || frames < 1) {
+        fprintf(stderr, "usage: %s [max threads] [frames]\n", argv[0]);
+        return 1;
+    }
+    std::vector<int> counts;
+    for (int n = 1; n < maxThreads; n *= 2) counts.push_back(n);
+    counts.push_back(maxThreads);
+
+    static const struct { int w, h; const char* name; } sizes[] = {
+        { 1920, 1080, "1080p" }, { 3840, 2160, "4K" }, { 7680, 4320, "8K" },
+    };
+    const int balls = 4000;
+    bool ok = CheckEdges();
+    printf("\n");
+    printf("%d cores reported; %d balls, %dx%d tiles, %d frames per run\n", (int)std::thread::hardware_concurrency(),
+           balls, kTileW, kTileH, frames);
+    printf("%-6s %-10s %10s %9s %s\n", "size", "renderer", "ms/frame", "speedup", "frame");
+
+    for (const auto& sz : sizes) {
+        Scene sc;
+        SceneInit(sc, sz.w, sz.h, balls);
+        uint32_t* px = (uint32_t*)NgAlignedAlloc((size_t)sz.w * sz.h * 4, 64);
+        if (!px || !sc.background.pixels) {
+            fprintf(stderr, "out of memory at %s\n", sz.name);
+            return 1;
+        }
+        const Surface s = { px, sz.w, sz.h, sz.w };
+
+        const double direct = TimeFrames([&] { DrawDirect(sc, s); }, frames);
+        const uint64_t want = HashSurface(s);
+        printf("%-6s %-10s %10.3f %9s %016llx\n", sz.name, "direct", direct * 1e3, "", (unsigned long long)want);
+
+        TileFrame f;
+        memset(&f, 0, sizeof(f));
+        double one = 0.0;
+        for (int threads : counts) {
+            TilePool pool;
+            TilePoolStart(pool, threads - 1);
+            RasterClear(s, 0);
+            Record(sc, f, s);
+            TileRender(f, &pool);
+            const uint64_t got = HashSurface(s);
+            const int grows = f.grows;
+            const double t = TimeFrames([&] {
+                Record(sc, f, s);
+                TileRender(f, &pool);
+            }, frames);
+            TilePoolStop(pool);
+            if (threads == 1) one = t;
+            const bool same = got == want, steady = f.grows == grows && f.dropped == 0;
+            char name[32];
+            snprintf(name, sizeof(name), "tiles x%d", threads);
+            printf("%-6s %-10s %10.3f %8.2fx %016llx %s%s\n", sz.name, name, t * 1e3, one / t, (unsigned long long)got,
+                   same ? "ok" : "MISMATCH", steady ? "" : "  (allocated mid-run)");
+            ok &= same && steady;
+        }
+        printf("%-6s %d commands, %d tile references\n", sz.name, f.count, f.binStart[f.cols * f.rows]);
+        TileFrameFree(f);
+        NgAlignedFree(px);
+        SceneFree(sc);
+    }
+    printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
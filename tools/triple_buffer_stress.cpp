@@ -0,0 +1,165 @@
+// Stress test for the lock-free triple buffer (common/triple_buffer.h)
+// behind the games' threaded mode.
+//
+// A writer thread publishes snapshots as fast as it can (or paced), and a
+// reader thread acquires them (flat out, or with a render-like pause). Each
+// snapshot carries a sequence number and data derived from it, checked by
+// the reader:
+//   - pattern: 16 KB of words derived from the sequence, plus a checksum,
+//   - pong:    a live PongState from a scripted match and its PongHash.
+// A torn snapshot (parts of two publishes) fails the check, and so does a
+// sequence number that doesn't increase. Exits non-zero on any failure.
+//
+// Build: g++ -O2 -std=c++11 -pthread tools/triple_buffer_stress.cpp -o triple_buffer_stress
+// Usage: triple_buffer_stress [seconds_per_case=1]
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "../Games/common/triple_buffer.h"
+#include "../Games/pongV1/pong_core.h"
+
+enum { kPatternWords = 4096 };
+
+static inline uint32_t Mix(uint64_t seq, uint32_t i) {
+    uint64_t z = seq * 0x9E3779B97F4A7C15ull + i;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    return (uint32_t)(z ^ (z >> 31));
+}
+
+struct PatternSnap {
+    uint64_t seq;
+    uint32_t words[kPatternWords];
+    uint32_t check;
+};
+
+static void Fill(PatternSnap& s, uint64_t seq) {
+    s.seq = seq;
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < kPatternWords; i++) {
+        s.words[i] = Mix(seq, i);
+        sum = sum * 31 + s.words[i];
+    }
+    s.check = sum ^ (uint32_t)seq;
+}
+
+static bool Valid(const PatternSnap& s) {
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < kPatternWords; i++) {
+        if (s.words[i] != Mix(s.seq, i)) return false;
+        sum = sum * 31 + s.words[i];
+    }
+    return s.check == (sum ^ (uint32_t)s.seq);
+}
+
+struct PongSnap {
+    uint64_t seq;
+    PongState state;
+    uint64_t hash;
+};
+
+struct Counts {
+    uint64_t published, acquired, torn, reordered;
+};
+
+// Runs one writer and one reader for `seconds`. Writer pauses `writerUs`
+// between publishes, the reader holds each snapshot `readerUs` (0 = none).
+template <typename Snap, typename Produce, typename Check>
+static Counts Run(double seconds, int writerUs, int readerUs, Produce produce, Check check) {
+    static TripleBuffer<Snap> tb;
+    Snap init;
+    produce(init, 0);
+    TripleBufferInit(tb, init);
+
+    std::atomic<bool> stop(false);
+    Counts c = {};
+    std::thread writer([&] {
+        uint64_t seq = 1;
+        while (!stop.load(std::memory_order_relaxed)) {
+            produce(TripleBufferBack(tb), seq++);
+            TripleBufferPublish(tb);
+            if (writerUs) std::this_thread::sleep_for(std::chrono::microseconds(writerUs));
+        }
+        c.published = seq - 1;
+    });
+    std::thread reader([&] {
+        uint64_t last = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            if (!TripleBufferAcquire(tb)) {
+                std::this_thread::yield();
+                continue;
+            }
+            const Snap& s = TripleBufferFront(tb);
+            c.acquired++;
+            if (!check(s)) c.torn++;
+            if (s.seq <= last) c.reordered++;
+            last = s.seq;
+            // Hold it for a frame like a renderer would; it must not
+            // change underneath.
+            if (readerUs) {
+                std::this_thread::sleep_for(std::chrono::microseconds(readerUs));
+                if (!check(s) || s.seq != last) c.torn++;
+            }
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop = true;
+    writer.join();
+    reader.join();
+    return c;
+}
+
+int main(int argc, char** argv) {
+    double seconds = (argc > 1) ? atof(argv[1]) : 1.0;
+    if (seconds <= 0.0) {
+        fprintf(stderr, "usage: %s [seconds_per_case]\n", argv[0]);
+        return 1;
+    }
+
+    auto pattern = [](PatternSnap& s, uint64_t seq) { Fill(s, seq); };
+    auto patternOk = [](const PatternSnap& s) { return Valid(s); };
+
+    // The writer owns the match; each publish is the state after one more
+    // tick, with the hash taken before it leaves the writer.
+    PongState game;
+    InitGame(game, 800, 600, 7);
+    game.aiMode = game.aiLeft = true;
+    ResetGame(game);
+    game.state = STATE_PLAYING;
+    auto pong = [&game](PongSnap& s, uint64_t seq) {
+        if (seq > 0) {
+            PongInput in = {};
+            if (!game.ball.inPlay) in.pressed = PONG_KEY_SPACE;
+            UpdateGame(game, in, 1.0f / 120.0f);
+        }
+        s.seq = seq;
+        s.state = game;
+        s.hash = PongHash(game);
+    };
+    auto pongOk = [](const PongSnap& s) { return PongHash(s.state) == s.hash; };
+
+    struct Case { const char* name; int kind, writerUs, readerUs; };
+    const Case cases[] = {
+        { "pattern, both flat out", 0, 0, 0 },
+        { "pattern, slow reader",   0, 0, 1000 },
+        { "pattern, slow writer",   0, 500, 0 },
+        { "pong, both flat out",    1, 0, 0 },
+        { "pong, 120 Hz / 60 Hz",   1, 8333, 16667 },
+    };
+    printf("%-24s %12s %12s %10s %8s %10s\n", "case", "published", "acquired", "skipped", "torn", "reordered");
+    int failures = 0;
+    for (const Case& k : cases) {
+        Counts c = (k.kind == 0) ? Run<PatternSnap>(seconds, k.writerUs, k.readerUs, pattern, patternOk)
+                                 : Run<PongSnap>(seconds, k.writerUs, k.readerUs, pong, pongOk);
+        uint64_t skipped = c.published > c.acquired ? c.published - c.acquired : 0;
+        printf("%-24s %12llu %12llu %10llu %8llu %10llu\n", k.name, (unsigned long long)c.published,
+               (unsigned long long)c.acquired, (unsigned long long)skipped, (unsigned long long)c.torn,
+               (unsigned long long)c.reordered);
+        if (c.torn || c.reordered || c.acquired == 0) failures++;
+    }
+    printf("%s\n", failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+}